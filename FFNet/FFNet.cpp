@@ -38,6 +38,7 @@
 #include "PatternList.h"
 #include "Collection.h"
 #include "Categories.h"
+#include "MelderThread.h"
 
 static void bookkeeping (FFNet me);
 
@@ -89,33 +90,40 @@ static double sigmoid (FFNet /*me*/, double x, double *deriv) {
 		if target < activity ==> error < 0
 */
 
-static double minimumSquaredError (FFNet me, const double target []) {
-	integer k = my nNodes - my nOutputs + 1;
+static double squaredError (integer numberOfOutputs, const double target [], const double activity [], double error []) {
 	double cost = 0.0;
-	for (integer i = 1; i <= my nOutputs; i ++, k ++) {
-		double e = my error [k] = target [i] - my activity [k];
+	for (integer i = 1; i <= numberOfOutputs; i ++) {
+		double e = error [i] = target [i] - activity [i];
 		cost += e * e;
 	}
 	return 0.5 * cost;
 }
 
+static double minimumSquaredError (FFNet me, const double target []) {
+	integer k = my nNodes - my nOutputs;
+	return squaredError (my nOutputs, target, my activity + k, my error + k);
+}
+
 /* E = - sum (i=1; i=nPatterns; sum (k=1;k=nOutputs; t [k]*ln (o [k]) + (1-t [k])ln (1-o [k]))) */
 /* dE/do [k] = -(1-t [k])/ (1-o [k]) + t [k]/o [k] */
 /* werkt niet bij (grote?) netten */
-static double minimumCrossEntropy (FFNet me, const double target []) {
-	integer k = my nNodes - my nOutputs + 1;
+static double crossEntropy (integer numberOfOutputs, const double target [], const double activity [], double error []) {
 	double cost = 0.0;
-
-	for (integer i = 1; i <= my nOutputs; i ++, k ++) {
+	for (integer i = 1; i <= numberOfOutputs; i ++) {
 		double t1 = 1.0 - target [i];
-		double o1 = 1.0 - my activity [k];
+		double o1 = 1.0 - activity [i];
 
-		cost -= target [i] * log (my activity [k]) + t1 * log (o1);
-		my error [k] = -t1 / o1 + target [i] / my activity [k];
+		cost -= target [i] * log (activity [i]) + t1 * log (o1);
+		error [i] = -t1 / o1 + target [i] / activity [i];
 	}
 	return cost;
 }
 
+static double minimumCrossEntropy (FFNet me, const double target []) {
+	integer k = my nNodes - my nOutputs;
+	return crossEntropy (my nOutputs, target, my activity + k, my error + k);
+}
+
 
 /* *********************************************************************** */
 
@@ -244,7 +252,7 @@ void FFNet_setNonLinearity (FFNet me, int nonLinearityType) {
 
 void FFNet_setCostFunction (FFNet me, int costType) {
 	my costFunctionType = costType;
-	if (costType == 2) {
+	if (costType == FFNet_COST_MCE) {
 		my costFunction = minimumCrossEntropy;
 	} else {
 		my costFunction = minimumSquaredError;
@@ -403,6 +411,234 @@ void FFNet_computeDerivative (FFNet me) {
 
 /******* end operation ******************************************************/
 
+/***** BATCH OPERATION: *****************************************************/
+/*
+	The weights to the units of layer l are a row-major matrix in w: nUnitsInLayer [l] rows,
+	one per unit, of nUnitsInLayer [l - 1] + 1 columns, the last column for the bias.
+	We propagate a block of patterns through a layer as one matrix product: for each unit,
+	its weight row is applied to all the patterns of the block while it is in the cache.
+	The activities, derivatives and errors of a block are kept in matrices [pattern] [node],
+	with the node numbering of my activity, so a layer is a contiguous part of each row.
+	The patterns are divided over threads, and each thread sums its own costs and derivative.
+*/
+
+#define FFNet_BATCH_BLOCKSIZE  64
+
+Thing_define (FFNet_Batch_Args, Thing) { public:
+	FFNet net;
+	double **inputs, **targets;
+	integer firstPattern, lastPattern;
+	integer *firstNodeInLayer, *firstWeightInLayer;   // [0..nLayers]
+	autoNUMmatrix <double> activity, deriv, error;   // [1..FFNet_BATCH_BLOCKSIZE] [1..nNodes]
+	autoNUMvector <double> dw;   // [1..nWeights], or null if no derivative is wanted
+	double cost;
+	bool isMainThread;
+	volatile int *cancelled;
+};
+
+Thing_implement (FFNet_Batch_Args, Thing, 0);
+
+static void FFNet_Batch_forward (FFNet me, FFNet_Batch_Args thee, integer numberOfPatterns) {
+	double **activity = thy activity.peek(), **deriv = thy deriv.peek();
+	for (integer layer = 1; layer <= my nLayers; layer ++) {
+		integer numberOfUnits = my nUnitsInLayer [layer], numberOfInputs = my nUnitsInLayer [layer - 1] + 1;
+		integer from = thy firstNodeInLayer [layer - 1], to = thy firstNodeInLayer [layer];
+		bool isLinear = my outputsAreLinear && layer == my nLayers;
+		for (integer unit = 1; unit <= numberOfUnits; unit ++) {
+			const double *w = & my w [thy firstWeightInLayer [layer] + (unit - 1) * numberOfInputs] - 1;
+			integer node = to + unit - 1;
+			for (integer ipattern = 1; ipattern <= numberOfPatterns; ipattern ++) {
+				const double *a = & activity [ipattern] [from] - 1;
+				double act = 0.0;
+				for (integer j = 1; j <= numberOfInputs; j ++) {
+					act += w [j] * a [j];
+				}
+				if (isLinear) {
+					activity [ipattern] [node] = act;
+					deriv [ipattern] [node] = 1.0;
+				} else {
+					activity [ipattern] [node] = my nonLinearity (me, act, & deriv [ipattern] [node]);
+				}
+			}
+		}
+	}
+}
+
+static void FFNet_Batch_backward (FFNet me, FFNet_Batch_Args thee, integer numberOfPatterns) {
+	double **activity = thy activity.peek(), **deriv = thy deriv.peek(), **error = thy error.peek();
+	for (integer layer = my nLayers; layer >= 1; layer --) {
+		integer numberOfUnits = my nUnitsInLayer [layer], numberOfInputs = my nUnitsInLayer [layer - 1] + 1;
+		integer from = thy firstNodeInLayer [layer - 1], to = thy firstNodeInLayer [layer];
+		const double *wLayer = & my w [thy firstWeightInLayer [layer]];
+		double *dwLayer = & thy dw [thy firstWeightInLayer [layer]];
+		for (integer ipattern = 1; ipattern <= numberOfPatterns; ipattern ++) {
+			double *e = & error [ipattern] [to] - 1;
+			const double *d = & deriv [ipattern] [to] - 1;
+			for (integer unit = 1; unit <= numberOfUnits; unit ++) {
+				e [unit] *= d [unit];
+			}
+			/*
+				The errors of the hidden units in the layer below, as in FFNet_computeError.
+			*/
+			if (layer > 1) {
+				double *ebelow = & error [ipattern] [from] - 1;
+				for (integer j = 1; j < numberOfInputs; j ++) {
+					ebelow [j] = 0.0;
+				}
+				for (integer unit = 1; unit <= numberOfUnits; unit ++) {
+					const double *w = wLayer + (unit - 1) * numberOfInputs - 1;
+					double eunit = e [unit];
+					for (integer j = 1; j < numberOfInputs; j ++) {
+						ebelow [j] += eunit * w [j];
+					}
+				}
+			}
+			/*
+				The derivative, as in FFNet_computeDerivative.
+			*/
+			const double *a = & activity [ipattern] [from] - 1;
+			for (integer unit = 1; unit <= numberOfUnits; unit ++) {
+				double *dw = dwLayer + (unit - 1) * numberOfInputs - 1;
+				double eunit = e [unit];
+				for (integer j = 1; j <= numberOfInputs; j ++) {
+					dw [j] -= eunit * a [j];
+				}
+			}
+		}
+	}
+}
+
+static MelderThread_RETURN_TYPE FFNet_Batch_run (FFNet_Batch_Args me) {
+	try {
+		FFNet net = my net;
+		integer firstOutputNode = my firstNodeInLayer [net -> nLayers];
+		for (integer first = my firstPattern; first <= my lastPattern; first += FFNet_BATCH_BLOCKSIZE) {
+			if (*my cancelled) MelderThread_RETURN;
+			integer numberOfPatterns = my lastPattern - first + 1;
+			if (numberOfPatterns > FFNet_BATCH_BLOCKSIZE) {
+				numberOfPatterns = FFNet_BATCH_BLOCKSIZE;
+			}
+			for (integer ipattern = 1; ipattern <= numberOfPatterns; ipattern ++) {
+				const double *input = my inputs [first + ipattern - 1];
+				double *a = my activity [ipattern];
+				for (integer i = 1; i <= net -> nInputs; i ++) {
+					a [i] = input [i];
+				}
+				for (integer layer = 0; layer < net -> nLayers; layer ++) {
+					a [my firstNodeInLayer [layer] + net -> nUnitsInLayer [layer]] = 1.0;   // bias
+				}
+			}
+			FFNet_Batch_forward (net, me, numberOfPatterns);
+			if (! my targets) {
+				continue;
+			}
+			for (integer ipattern = 1; ipattern <= numberOfPatterns; ipattern ++) {
+				const double *target = my targets [first + ipattern - 1];
+				const double *a = & my activity [ipattern] [firstOutputNode] - 1;
+				double *e = & my error [ipattern] [firstOutputNode] - 1;
+				my cost += ( net -> costFunctionType == FFNet_COST_MCE ?
+					crossEntropy (net -> nOutputs, target, a, e) : squaredError (net -> nOutputs, target, a, e) );
+			}
+			if (my dw.peek()) {
+				FFNet_Batch_backward (net, me, numberOfPatterns);
+			}
+		}
+	} catch (MelderError) {
+		*my cancelled = 1;
+		if (my isMainThread) throw;
+	}
+	MelderThread_RETURN;
+}
+
+double FFNet_computeCostsAndDerivative (FFNet me, double **inputs, double **targets, integer numberOfPatterns, double *dw) {
+	if (Melder_debug == -3) {
+		/*
+			Pattern by pattern, as before the blocked computation (see test_FFNet.praat).
+		*/
+		double cost = 0.0;
+		if (dw) {
+			for (integer k = 1; k <= my nWeights; k ++) {
+				dw [k] = 0.0;
+			}
+		}
+		for (integer ipattern = 1; ipattern <= numberOfPatterns; ipattern ++) {
+			FFNet_propagate (me, inputs [ipattern], nullptr);
+			if (! targets) {
+				continue;
+			}
+			cost += FFNet_computeError (me, targets [ipattern]);
+			if (dw) {
+				FFNet_computeDerivative (me);
+				for (integer k = 1; k <= my nWeights; k ++) {
+					dw [k] += my dwi [k];
+				}
+			}
+		}
+		return cost;
+	}
+	autoNUMvector <integer> firstNodeInLayer ((integer) 0, my nLayers);
+	autoNUMvector <integer> firstWeightInLayer ((integer) 0, my nLayers);
+	firstNodeInLayer [0] = 1;
+	for (integer layer = 1; layer <= my nLayers; layer ++) {
+		firstNodeInLayer [layer] = firstNodeInLayer [layer - 1] + my nUnitsInLayer [layer - 1] + 1;
+		firstWeightInLayer [layer] = my wFirst [firstNodeInLayer [layer]];
+	}
+
+	int numberOfThreads = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads > numberOfPatterns / FFNet_BATCH_BLOCKSIZE) numberOfThreads = (int) (numberOfPatterns / FFNet_BATCH_BLOCKSIZE);
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	integer numberOfPatternsPerThread = (numberOfPatterns - 1) / numberOfThreads + 1;
+	autoFFNet_Batch_Args args [16];
+	volatile int cancelled = 0;
+	integer firstPattern = 1;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoFFNet_Batch_Args arg = Thing_new (FFNet_Batch_Args);
+		arg -> net = me;
+		arg -> inputs = inputs;
+		arg -> targets = targets;
+		arg -> firstPattern = firstPattern;
+		arg -> lastPattern = ithread == numberOfThreads ? numberOfPatterns : firstPattern + numberOfPatternsPerThread - 1;
+		firstPattern = arg -> lastPattern + 1;
+		arg -> firstNodeInLayer = firstNodeInLayer.peek();
+		arg -> firstWeightInLayer = firstWeightInLayer.peek();
+		arg -> activity.reset (1, FFNet_BATCH_BLOCKSIZE, 1, my nNodes);
+		arg -> deriv.reset (1, FFNet_BATCH_BLOCKSIZE, 1, my nNodes);
+		arg -> error.reset (1, FFNet_BATCH_BLOCKSIZE, 1, my nNodes);
+		if (dw) {
+			arg -> dw.reset (1, my nWeights);
+		}
+		arg -> isMainThread = ( ithread == numberOfThreads );
+		arg -> cancelled = & cancelled;
+		args [ithread - 1] = arg.move();
+	}
+	MelderThread_run (FFNet_Batch_run, args, numberOfThreads);
+	if (cancelled)
+		Melder_throw (me, U": costs not computed.");
+
+	/*
+		Reduction, always in the same order.
+	*/
+	double cost = 0.0;
+	if (dw) {
+		for (integer k = 1; k <= my nWeights; k ++) {
+			dw [k] = 0.0;
+		}
+	}
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		FFNet_Batch_Args arg = args [ithread - 1].get();
+		cost += arg -> cost;
+		if (dw) {
+			for (integer k = 1; k <= my nWeights; k ++) {
+				dw [k] += arg -> dw [k];
+			}
+		}
+	}
+	return cost;
+}
+
+/******* end batch operation ************************************************/
+
 integer FFNet_getWinningUnit (FFNet me, int labeling) {
 	integer pos = 1, k = my nNodes - my nOutputs;
 	if (labeling == 2) { /* stochastic */
@@ -128,6 +128,7 @@ char32 * FFNet_createNameFromTopology (FFNet me);
 */
 
 #define FFNet_COST_MSE 1
+#define FFNet_COST_MCE 2
 
 void FFNet_setCostFunction (FFNet me, int type);
 
@@ -174,6 +175,14 @@ void FFNet_computeDerivative (FFNet me);
 /* step (4) compute derivative in my dwi */
 /* Precondition: step (3) */
 
+double FFNet_computeCostsAndDerivative (FFNet me, double **inputs, double **targets, integer numberOfPatterns, double *dw);
+/* steps (1) to (4) for the patterns inputs[1..numberOfPatterns] with targets[1..numberOfPatterns]:
+ * returns the total cost and, if dw != nullptr, the summed derivative in dw[1..nWeights].
+ * The patterns are propagated in blocks, layer by layer, and divided over threads.
+ * my activity, error, deriv and dwi are not changed.
+ * With Melder_debug == -3, steps (1) to (4) are performed pattern by pattern instead, for comparison.
+ */
+
 integer FFNet_getWinningUnit (FFNet me, int labeling);
 /* labeling = 1 : winner-takes-all */
 /* labeling = 2 : stochastic */
@@ -30,23 +30,14 @@
 static double func (Daata object, const double p []) {
 	FFNet me = (FFNet) object;
 	Minimizer thee = my minimizer.get();
-	double fp = 0.0;
 
 	for (integer j = 1, k = 1; k <= my nWeights; k ++) {
-		my dw [k] = 0.0;
 		if (my wSelected [k]) {
 			my w [k] = p [j ++];
 		}
 	}
-	for (integer i = 1; i <= my nPatterns; i ++) {
-		FFNet_propagate (me, my inputPattern [i], nullptr);
-		fp += FFNet_computeError (me, my targetActivation [i]);
-		FFNet_computeDerivative (me);
-		/* derivative (cumulative) */
-		for (integer k = 1; k <= my nWeights; k ++) {
-			my dw [k] += my dwi [k];
-		}
-	}
+	/* cost and derivative (cumulative) of all patterns */
+	double fp = FFNet_computeCostsAndDerivative (me, my inputPattern, my targetActivation, my nPatterns, my dw);
 	thy funcCalls ++;
 	return fp;
 }
@@ -156,12 +147,7 @@ double FFNet_PatternList_ActivationList_getCosts_total (FFNet me, PatternList p,
 		_FFNet_PatternList_ActivationList_checkDimensions (me, p, a);
 		FFNet_setCostFunction (me, costFunctionType);
 
-		double cost = 0.0;
-		for (integer i = 1; i <= p -> ny; i ++) {
-			FFNet_propagate (me, p -> z [i], nullptr);
-			cost += FFNet_computeError (me, a -> z [i]);
-		}
-		return cost;
+		return FFNet_computeCostsAndDerivative (me, p -> z, a -> z, p -> ny, nullptr);
 	} catch (MelderError) {
 		return undefined;
 	}
@@ -226,24 +226,116 @@ L60:
 	return ret_val;
 }								/* NUMblas_ddot */
 
+/*
+	Blocked matrix multiplication for NUMblas_dgemm.
+	C += op(A) * (alpha op(B)) is computed in blocks that fit in the caches: a DGEMM_MC x DGEMM_KC block
+	of op(A) is copied into panels of DGEMM_MR rows and a DGEMM_KC x DGEMM_NC block of alpha op(B) into
+	panels of DGEMM_NR columns. The kernel then reads both panels contiguously, whatever the
+	transpositions, and keeps a DGEMM_MR x DGEMM_NR block of C in registers, where the compiler can
+	vectorize it. Small products are left to the reference loops, for which the copying does not pay.
+	All indexes below are 0-based in column-major storage: X(i,j) = x [i + j * ldx].
+*/
+#define DGEMM_MR  4
+#define DGEMM_NR  4
+#define DGEMM_MC  128
+#define DGEMM_KC  256
+#define DGEMM_NC  1024
+#define DGEMM_MINIMUM_WORK  32768.0
+
+static void dgemm_packA (bool nota, const double *a, integer lda, integer i0, integer mc, integer l0, integer kc, double *packed) {
+	for (integer ip = 0; ip < mc; ip += DGEMM_MR) {
+		for (integer l = 0; l < kc; l ++) {
+			for (integer r = 0; r < DGEMM_MR; r ++) {
+				integer i = ip + r;
+				*packed ++ = ( i >= mc ? 0.0 : nota ? a [(i0 + i) + (l0 + l) * lda] : a [(l0 + l) + (i0 + i) * lda] );
+			}
+		}
+	}
+}
+
+static void dgemm_packB (bool notb, double alpha, const double *b, integer ldb, integer l0, integer kc, integer j0, integer nc, double *packed) {
+	for (integer jp = 0; jp < nc; jp += DGEMM_NR) {
+		for (integer l = 0; l < kc; l ++) {
+			for (integer c = 0; c < DGEMM_NR; c ++) {
+				integer j = jp + c;
+				*packed ++ = ( j >= nc ? 0.0 : alpha * (notb ? b [(l0 + l) + (j0 + j) * ldb] : b [(j0 + j) + (l0 + l) * ldb]) );
+			}
+		}
+	}
+}
+
+static void dgemm_kernel (integer kc, const double *pa, const double *pb, double *c, integer ldc, integer mr, integer nr) {
+	double ab [DGEMM_MR * DGEMM_NR] = { 0.0 };
+	for (integer l = 0; l < kc; l ++, pa += DGEMM_MR, pb += DGEMM_NR) {
+		for (integer j = 0; j < DGEMM_NR; j ++) {
+			for (integer i = 0; i < DGEMM_MR; i ++) {
+				ab [j * DGEMM_MR + i] += pa [i] * pb [j];
+			}
+		}
+	}
+	for (integer j = 0; j < nr; j ++) {
+		for (integer i = 0; i < mr; i ++) {
+			c [i + j * ldc] += ab [j * DGEMM_MR + i];
+		}
+	}
+}
+
+static void dgemm_blocked (bool nota, bool notb, integer m, integer n, integer k, double alpha, const double *a, integer lda,
+	const double *b, integer ldb, double beta, double *c, integer ldc)
+{
+	for (integer j = 0; j < n; j ++) {
+		double *cj = c + j * ldc;
+		if (beta == 0.0) {
+			for (integer i = 0; i < m; i ++) {
+				cj [i] = 0.0;
+			}
+		} else if (beta != 1.0) {
+			for (integer i = 0; i < m; i ++) {
+				cj [i] *= beta;
+			}
+		}
+	}
+	integer mcmax = MIN (m, DGEMM_MC), kcmax = MIN (k, DGEMM_KC), ncmax = MIN (n, DGEMM_NC);
+	autoNUMvector <double> packedA ((integer) 0, ((mcmax + DGEMM_MR - 1) / DGEMM_MR) * DGEMM_MR * kcmax - 1);
+	autoNUMvector <double> packedB ((integer) 0, ((ncmax + DGEMM_NR - 1) / DGEMM_NR) * DGEMM_NR * kcmax - 1);
+	for (integer j0 = 0; j0 < n; j0 += DGEMM_NC) {
+		integer nc = MIN (n - j0, DGEMM_NC);
+		for (integer l0 = 0; l0 < k; l0 += DGEMM_KC) {
+			integer kc = MIN (k - l0, DGEMM_KC);
+			dgemm_packB (notb, alpha, b, ldb, l0, kc, j0, nc, packedB.peek());
+			for (integer i0 = 0; i0 < m; i0 += DGEMM_MC) {
+				integer mc = MIN (m - i0, DGEMM_MC);
+				dgemm_packA (nota, a, lda, i0, mc, l0, kc, packedA.peek());
+				for (integer jr = 0; jr < nc; jr += DGEMM_NR) {
+					const double *pb = & packedB [jr * kc];
+					for (integer ir = 0; ir < mc; ir += DGEMM_MR) {
+						dgemm_kernel (kc, & packedA [ir * kc], pb, c + (i0 + ir) + (j0 + jr) * ldc, ldc,
+							MIN (mc - ir, DGEMM_MR), MIN (nc - jr, DGEMM_NR));
+					}
+				}
+			}
+		}
+	}
+}
+
 int NUMblas_dgemm (const char *transa, const char *transb, integer *m, integer *n, integer *k, double *alpha, double *a, integer *lda,
                    double *b, integer *ldb, double *beta, double *c__, integer *ldc) {
 	/* System generated locals */
 	integer a_dim1, a_offset, b_dim1, b_offset, c_dim1, c_offset, i__1, i__2, i__3;
 
 	/* Local variables */
-	static integer info;
-	static integer nota, notb;
-	static double temp;
-	static integer i__, j, l, ncola;
-	static integer nrowa, nrowb;
+	integer info;
+	integer nota, notb;
+	double temp;
+	integer i__, j, l;
+	integer nrowa, nrowb;
 
 #define a_ref(a_1,a_2) a[(a_2)*a_dim1 + a_1]
 #define b_ref(a_1,a_2) b[(a_2)*b_dim1 + a_1]
 #define c___ref(a_1,a_2) c__[(a_2)*c_dim1 + a_1]
 	/*
 	   Set NOTA and NOTB as true if A and B respectively are not transposed
-	   and set NROWA, NCOLA and NROWB as the number of rows and columns of A
+	   and set NROWA and NROWB as the number of rows of A
 	   and the number of rows of B respectively. Parameter adjustments */
 	a_dim1 = *lda;
 	a_offset = 1 + a_dim1 * 1;
@@ -259,10 +351,8 @@ int NUMblas_dgemm (const char *transa, const char *transb, integer *m, integer *
 	notb = lsame_ (transb, "N");
 	if (nota) {
 		nrowa = *m;
-		ncola = *k;
 	} else {
 		nrowa = *k;
-		ncola = *m;
 	}
 	if (notb) {
 		nrowb = *k;
@@ -296,6 +386,11 @@ int NUMblas_dgemm (const char *transa, const char *transb, integer *m, integer *
 	if (*m == 0 || *n == 0 || ((*alpha == 0. || *k == 0) && *beta == 1.)) {
 		return 0;
 	}
+	/* Large products are computed blockwise. */
+	if (*alpha != 0. && (double) *m * (double) *n * (double) *k >= DGEMM_MINIMUM_WORK) {
+		dgemm_blocked (nota, notb, *m, *n, *k, *alpha, & a_ref (1, 1), *lda, & b_ref (1, 1), *ldb, *beta, & c___ref (1, 1), *ldc);
+		return 0;
+	}
 	/* And if alpha.eq.zero. */
 	if (*alpha == 0.) {
 		if (*beta == 0.) {
@@ -531,10 +626,10 @@ int NUMblas_dgemv (const char *trans, integer *m, integer *n, double *alpha, dou
 	integer a_dim1, a_offset, i__1, i__2;
 
 	/* Local variables */
-	static integer info;
-	static double temp;
-	static integer lenx, leny, i__, j;
-	static integer ix, iy, jx, jy, kx, ky;
+	integer info;
+	double temp;
+	integer lenx, leny, i__, j;
+	integer ix, iy, jx, jy, kx, ky;
 
 #define a_ref(a_1,a_2) a[(a_2)*a_dim1 + a_1]
 
@@ -629,8 +724,22 @@ int NUMblas_dgemv (const char *trans, integer *m, integer *n, double *alpha, dou
 		/* Form y := alpha*A*x + y. */
 		jx = kx;
 		if (*incy == 1) {
+			/* Four columns at a time: y is loaded and stored once for every four columns. */
+			i__1 = *n - *n % 4;
+			for (j = 1; j <= i__1; j += 4) {
+				double t0 = *alpha * x[jx], t1 = *alpha * x[jx + *incx];
+				double t2 = *alpha * x[jx + 2 * *incx], t3 = *alpha * x[jx + 3 * *incx];
+				if (t0 != 0. || t1 != 0. || t2 != 0. || t3 != 0.) {
+					const double *a0 = & a_ref (1, j), *a1 = & a_ref (1, j + 1), *a2 = & a_ref (1, j + 2), *a3 = & a_ref (1, j + 3);
+					i__2 = *m;
+					for (i__ = 0; i__ < i__2; ++i__) {
+						y[i__ + 1] += t0 * a0[i__] + t1 * a1[i__] + t2 * a2[i__] + t3 * a3[i__];
+					}
+				}
+				jx += 4 * *incx;
+			}
 			i__1 = *n;
-			for (j = 1; j <= i__1; ++j) {
+			for (; j <= i__1; ++j) {
 				if (x[jx] != 0.) {
 					temp = *alpha * x[jx];
 					i__2 = *m;
@@ -663,8 +772,27 @@ int NUMblas_dgemv (const char *trans, integer *m, integer *n, double *alpha, dou
 		/* Form y := alpha*A'*x + y. */
 		jy = ky;
 		if (*incx == 1) {
+			/* Four columns at a time: x is loaded once for four inner products. */
+			i__1 = *n - *n % 4;
+			for (j = 1; j <= i__1; j += 4) {
+				const double *a0 = & a_ref (1, j), *a1 = & a_ref (1, j + 1), *a2 = & a_ref (1, j + 2), *a3 = & a_ref (1, j + 3);
+				double s0 = 0., s1 = 0., s2 = 0., s3 = 0.;
+				i__2 = *m;
+				for (i__ = 0; i__ < i__2; ++i__) {
+					double xi = x[i__ + 1];
+					s0 += a0[i__] * xi;
+					s1 += a1[i__] * xi;
+					s2 += a2[i__] * xi;
+					s3 += a3[i__] * xi;
+				}
+				y[jy] += *alpha * s0;
+				y[jy + *incy] += *alpha * s1;
+				y[jy + 2 * *incy] += *alpha * s2;
+				y[jy + 3 * *incy] += *alpha * s3;
+				jy += 4 * *incy;
+			}
 			i__1 = *n;
-			for (j = 1; j <= i__1; ++j) {
+			for (; j <= i__1; ++j) {
 				temp = 0.;
 				i__2 = *m;
 				for (i__ = 1; i__ <= i__2; ++i__) {
@@ -2647,7 +2775,7 @@ int NUMblas_dtrmv (const char *uplo, const char *trans, const char *diag, intege
 
 #undef a_ref
 
-int NUMblas_dtrsm (const char *side, const char *uplo, const char *transa, const char *diag, integer *m, integer *n,
+static int dtrsm_unblocked (const char *side, const char *uplo, const char *transa, const char *diag, integer *m, integer *n,
                    double *alpha, double *a, integer *lda, double *b, integer *ldb) {
 	/* System generated locals */
 	integer a_dim1, a_offset, b_dim1, b_offset, i__1, i__2, i__3;
@@ -2949,11 +3077,80 @@ int NUMblas_dtrsm (const char *side, const char *uplo, const char *transa, const
 		}
 	}
 	return 0;
-} /* NUMblas_dtrsm */
+} /* dtrsm_unblocked */
 
 #undef b_ref
 #undef a_ref
 
+/*
+	Recursive NUMblas_dtrsm: the triangular system is split in two halves, so that most of the work
+	is the update of the second half with the solution of the first, which is a matrix product
+	done by NUMblas_dgemm. Systems of order DTRSM_NB or less are solved by dtrsm_unblocked.
+	All indexes are 0-based in column-major storage: X(i,j) = x [i + j * ldx].
+*/
+#define DTRSM_NB  64
+
+static void dtrsm_recursive (bool lside, bool upper, bool notrans, const char *transa, const char *diag, integer m, integer n,
+	double alpha, double *a, integer lda, double *b, integer ldb)
+{
+	integer order = ( lside ? m : n );
+	if (order <= DTRSM_NB) {
+		dtrsm_unblocked (lside ? "L" : "R", upper ? "U" : "L", transa, diag, & m, & n, & alpha, a, & lda, b, & ldb);
+		return;
+	}
+	integer n1 = order / 2, n2 = order - n1;
+	double *a11 = a, *a12 = a + n1 * lda, *a21 = a + n1, *a22 = a + n1 + n1 * lda;
+	double minusOne = -1.0;
+	integer one_n1 = n1, one_n2 = n2;
+	/*
+		op(A) is lower triangular if A is lower and not transposed or upper and transposed.
+	*/
+	bool opAisLower = ( upper != notrans );
+	const char *tr = ( notrans ? "N" : "T" );
+	double *offDiagonal = ( upper ? a12 : a21 );   // its op() is op(A)21 if op(A) is lower, op(A)12 if upper
+	if (lside) {
+		double *b1 = b, *b2 = b + n1;
+		if (opAisLower) {
+			/* op(A11) X1 = alpha B1; B2 := alpha B2 - op(A)21 X1; op(A22) X2 = B2 */
+			dtrsm_recursive (lside, upper, notrans, transa, diag, n1, n, alpha, a11, lda, b1, ldb);
+			NUMblas_dgemm (tr, "N", & one_n2, & n, & one_n1, & minusOne, offDiagonal, & lda, b1, & ldb, & alpha, b2, & ldb);
+			dtrsm_recursive (lside, upper, notrans, transa, diag, n2, n, 1.0, a22, lda, b2, ldb);
+		} else {
+			/* op(A22) X2 = alpha B2; B1 := alpha B1 - op(A)12 X2; op(A11) X1 = B1 */
+			dtrsm_recursive (lside, upper, notrans, transa, diag, n2, n, alpha, a22, lda, b2, ldb);
+			NUMblas_dgemm (tr, "N", & one_n1, & n, & one_n2, & minusOne, offDiagonal, & lda, b2, & ldb, & alpha, b1, & ldb);
+			dtrsm_recursive (lside, upper, notrans, transa, diag, n1, n, 1.0, a11, lda, b1, ldb);
+		}
+	} else {
+		double *b1 = b, *b2 = b + n1 * ldb;
+		if (opAisLower) {
+			/* X2 op(A22) = alpha B2; B1 := alpha B1 - X2 op(A)21; X1 op(A11) = B1 */
+			dtrsm_recursive (lside, upper, notrans, transa, diag, m, n2, alpha, a22, lda, b2, ldb);
+			NUMblas_dgemm ("N", tr, & m, & one_n1, & one_n2, & minusOne, b2, & ldb, offDiagonal, & lda, & alpha, b1, & ldb);
+			dtrsm_recursive (lside, upper, notrans, transa, diag, m, n1, 1.0, a11, lda, b1, ldb);
+		} else {
+			/* X1 op(A11) = alpha B1; B2 := alpha B2 - X1 op(A)12; X2 op(A22) = B2 */
+			dtrsm_recursive (lside, upper, notrans, transa, diag, m, n1, alpha, a11, lda, b1, ldb);
+			NUMblas_dgemm ("N", tr, & m, & one_n2, & one_n1, & minusOne, b1, & ldb, offDiagonal, & lda, & alpha, b2, & ldb);
+			dtrsm_recursive (lside, upper, notrans, transa, diag, m, n2, 1.0, a22, lda, b2, ldb);
+		}
+	}
+}
+
+int NUMblas_dtrsm (const char *side, const char *uplo, const char *transa, const char *diag, integer *m, integer *n,
+                   double *alpha, double *a, integer *lda, double *b, integer *ldb) {
+	bool lside = lsame_ (side, "L"), upper = lsame_ (uplo, "U"), notrans = lsame_ (transa, "N");
+	integer nrowa = ( lside ? *m : *n );
+	bool valid = (lside || lsame_ (side, "R")) && (upper || lsame_ (uplo, "L")) &&
+		(notrans || lsame_ (transa, "T") || lsame_ (transa, "C")) && (lsame_ (diag, "U") || lsame_ (diag, "N")) &&
+		*m >= 0 && *n >= 0 && *lda >= MAX (1, nrowa) && *ldb >= MAX (1, *m);
+	if (! valid || nrowa <= DTRSM_NB || *alpha == 0.) {
+		return dtrsm_unblocked (side, uplo, transa, diag, m, n, alpha, a, lda, b, ldb);
+	}
+	dtrsm_recursive (lside, upper, notrans, transa, diag, *m, *n, *alpha, a, *lda, b, *ldb);
+	return 0;
+} /* NUMblas_dtrsm */
+
 integer NUMblas_idamax (integer *n, double *dx, integer *incx) {
 	/* System generated locals */
 	integer ret_val, i__1;
@@ -25,6 +25,7 @@
  */
 
 #include "CCs_to_DTW.h"
+#include "MelderThread.h"
 
 static void regression (CC me, integer frame, double r[], integer nr) {
 
@@ -54,7 +55,48 @@ static void regression (CC me, integer frame, double r[], integer nr) {
 	}
 }
 
-autoDTW CCs_to_DTW (CC me, CC thee, double wc, double wle, double wr, double wer, double dtr) {
+static double CC_Frames_getDistance (CC_Frame fi, CC_Frame fj, double *ri, double *rj, double wc, double wle, double wr, double wer) {
+	longdouble dist = 0.0, distr = 0.0;
+
+	/* Cepstral distance. */
+
+	if (wc != 0.0) {
+		for (integer k = 1; k <= fj -> numberOfCoefficients; k ++) {
+			double d = fi -> c [k] - fj -> c [k];
+			dist += d * d;
+		}
+		dist *= wc;
+	}
+
+	/* Log energy distance. */
+
+	if (wle != 0.0) {
+		double d = fi -> c0 - fj -> c0;
+		dist += wle * d * d;
+	}
+
+	/* Regression distance. */
+
+	if (wr != 0.0) {
+		for (integer k = 1; k <= fj -> numberOfCoefficients; k ++) {
+			double d = ri [k] - rj [k];
+			distr += d * d;
+		}
+		dist += wr * distr;
+	}
+
+	/* Regression on c[0]: log(energy) */
+
+	if (wer != 0.0) {
+		double d = ri [0] - rj [0];
+		dist += wer * d * d;
+	}
+
+	dist /= wc + wle + wr + wer;
+	return sqrt ((double) dist);
+}
+
+autoDTW CCs_to_DTW (CC me, CC thee, double wc, double wle, double wr, double wer, double dtr, double sakoeChibaBand, int slope) {
 	try {
 		integer nr = Melder_ifloor (dtr / my dx);
 		
@@ -70,7 +112,7 @@ autoDTW CCs_to_DTW (CC me, CC thee, double wc, double wle, double wr, double wer
 			Melder_casual (nr, U" frames used for regression coefficients.");
 		}
 
-		autoDTW him = DTW_create (my xmin, my xmax, my nx, my dx, my x1, thy xmin, thy xmax, thy nx, thy dx, thy x1);
+		autoDTW him = DTW_createBanded (my xmin, my xmax, my nx, my dx, my x1, thy xmin, thy xmax, thy nx, thy dx, thy x1, sakoeChibaBand, slope);
 		autoNUMvector <double> ri ((integer) 0, my maximumNumberOfCoefficients);
 		autoNUMvector <double> rj ((integer) 0, my maximumNumberOfCoefficients);
 
@@ -82,59 +124,279 @@ autoDTW CCs_to_DTW (CC me, CC thee, double wc, double wle, double wr, double wer
 
 			regression (me, i, ri.peek(), nr);
 
-			for (integer j = 1; j <= thy nx; j ++) {
+			integer jfrom, jto;
+			DTW_getBandColumns (him.get(), i, & jfrom, & jto);
+			for (integer j = jfrom; j <= jto; j ++) {
 				CC_Frame fj = & thy frame [j];
-				longdouble dist = 0.0, distr = 0.0;
+				if (wr != 0.0 || wer != 0.0) {
+					regression (thee, j, rj.peek(), nr);
+				}
+				double dist = CC_Frames_getDistance (fi, fj, ri.peek(), rj.peek(), wc, wle, wr, wer);
+				DTW_setDistance (him.get(), i, j, dist);   // prototype along y-direction
+			}
 
-				/* Cepstral distance. */
+			if (i % 10 == 1) {
+				Melder_progress (0.999 * i / my nx, U"Calculate distances: frame ", i, U" from ", my nx, U".");
+			}
+		}
+		return him;
+	} catch (MelderError) {
+		Melder_throw (U"DTW not created from CCs.");
+	}
+}
 
-				if (wc != 0.0) {
-					for (integer k = 1; k <= fj -> numberOfCoefficients; k ++) {
-						double d = fi -> c [k] - fj -> c [k];
-						dist += d * d;
-					}
-					dist *= wc;
-				}
+/*
+	Many-to-many DTW: the distance between each pair of CCs is the weighted distance of the best path.
+	The pairs are independent, so we distribute them over threads. The distances of a pair are
+	computed column by column inside DTW_findWeightedDistance, so no distance matrix is ever stored.
+	The regression coefficients of each CC are computed once, in frame order, like CCs_to_DTW does for the prototype.
+*/
 
-				/* Log energy distance. */
+static void CC_into_regressionCoefficients (CC me, integer nr, double **r) {
+	autoNUMvector <double> ri ((integer) 0, my maximumNumberOfCoefficients);
+	for (integer i = 1; i <= my nx; i ++) {
+		regression (me, i, ri.peek(), nr);
+		for (integer k = 0; k <= my maximumNumberOfCoefficients; k ++) {
+			r [i] [k] = ri [k];
+		}
+	}
+}
 
-				if (wle != 0.0) {
-					double d = fi -> c0 - fj -> c0;
-					dist += wle * d * d;
-				}
+Thing_define (CCs_to_Distance_dtw_Args, Thing) { public:
+	OrderedOf<structCC> *ccs;
+	double ***regressions;   // [1..numberOfCCs], null if not needed
+	integer *prototype, *candidate;   // [1..numberOfPairs]
+	integer numberOfPairs, firstPair, pairStep;
+	double wc, wle, wr, wer, sakoeChibaBand, maximumDistance;
+	int slope;
+	double **distances;   // [1..numberOfCCs] [1..numberOfCCs]
+	/*
+		The state of the current pair.
+	*/
+	CC me, thee;   // prototype along y, candidate along x
+	double **rme, **rthee;
+	integer numberOfCoefficients;
+	autoNUMmatrix <integer> minQueue, maxQueue;   // per coefficient a monotone queue of frames of the prototype
+	autoNUMvector <integer> minHead, minTail, maxHead, maxTail;
+	integer lastFrameInQueues;
+	bool isMainThread;
+	volatile int *cancelled;
+};
 
-				/* Regression distance. */
+Thing_implement (CCs_to_Distance_dtw_Args, Thing, 0);
 
-				if (wr != 0.0) {
-					regression (thee, j, rj.peek(), nr);
-					for (integer k = 1; k <= fj -> numberOfCoefficients; k ++) {
-						double d = ri [k] - rj [k];
-						distr += d * d;
-					}
-					dist += wr * distr;
-				}
+static inline double CC_Frame_getValue (CC_Frame me, integer k) {
+	return k == 0 ? my c0 : my c [k];
+}
+
+static void CCs_to_Distance_dtw_getDistances (void *void_me, integer ix, integer iyFirst, integer iyLast, double *distances) {
+	CCs_to_Distance_dtw_Args me = (CCs_to_Distance_dtw_Args) void_me;
+	CC_Frame fj = & my thee -> frame [ix];
+	double *rj = my rthee ? my rthee [ix] : nullptr;
+	for (integer iy = iyFirst; iy <= iyLast; iy ++) {
+		distances [iy] = CC_Frames_getDistance (& my me -> frame [iy], fj, my rme ? my rme [iy] : nullptr, rj,
+			my wc, my wle, my wr, my wer);
+	}
+}
 
-				/* Regression on c[0]: log(energy) */
+/*
+	An LB_Keogh lower bound of the distances of frame ix of the candidate to the prototype frames iyFirst..iyLast:
+	the distance of the candidate's coefficients to the envelope of the prototype's coefficients in these frames.
+	Only the cepstral and energy terms count, because the regression terms can be zero.
+	The row ranges only move up with ix, so the envelopes can be maintained with monotone queues.
+*/
+static double CCs_to_Distance_dtw_getLowerBound (void *void_me, integer ix, integer iyFirst, integer iyLast) {
+	CCs_to_Distance_dtw_Args me = (CCs_to_Distance_dtw_Args) void_me;
+	CC_Frame fj = & my thee -> frame [ix];
+	for (integer iy = my lastFrameInQueues + 1; iy <= iyLast; iy ++) {
+		CC_Frame fi = & my me -> frame [iy];
+		for (integer k = 0; k <= my numberOfCoefficients; k ++) {
+			double value = CC_Frame_getValue (fi, k);
+			integer *minQueue = my minQueue [k], *maxQueue = my maxQueue [k];
+			while (my minTail [k] >= my minHead [k] && CC_Frame_getValue (& my me -> frame [minQueue [my minTail [k]]], k) >= value) {
+				my minTail [k] --;
+			}
+			minQueue [++ my minTail [k]] = iy;
+			while (my maxTail [k] >= my maxHead [k] && CC_Frame_getValue (& my me -> frame [maxQueue [my maxTail [k]]], k) <= value) {
+				my maxTail [k] --;
+			}
+			maxQueue [++ my maxTail [k]] = iy;
+		}
+	}
+	if (iyLast > my lastFrameInQueues) {
+		my lastFrameInQueues = iyLast;
+	}
+	longdouble sumc = 0.0, sume = 0.0;
+	for (integer k = 0; k <= my numberOfCoefficients; k ++) {
+		integer *minQueue = my minQueue [k], *maxQueue = my maxQueue [k];
+		while (minQueue [my minHead [k]] < iyFirst) {
+			my minHead [k] ++;
+		}
+		while (maxQueue [my maxHead [k]] < iyFirst) {
+			my maxHead [k] ++;
+		}
+		double value = CC_Frame_getValue (fj, k);
+		double lower = CC_Frame_getValue (& my me -> frame [minQueue [my minHead [k]]], k);
+		double upper = CC_Frame_getValue (& my me -> frame [maxQueue [my maxHead [k]]], k);
+		double d = ( value < lower ? lower - value : value > upper ? value - upper : 0.0 );
+		if (k == 0) {
+			sume = d * d;
+		} else {
+			sumc += d * d;
+		}
+	}
+	double dist = ( my wc * (double) sumc + my wle * (double) sume ) / (my wc + my wle + my wr + my wer);
+	return sqrt (dist);
+}
 
-				if (wer != 0.0) {
-					if (wr == 0.0) {
-						regression (thee, j, rj.peek(), nr);
-					}
-					double d = ri [0] - rj [0];
-					dist += wer * d * d;
+static MelderThread_RETURN_TYPE CCs_to_Distance_dtw_pairs (CCs_to_Distance_dtw_Args me) {
+	try {
+		integer numberOfPairsDone = 0, numberOfPairsToDo = (my numberOfPairs - my firstPair) / my pairStep + 1;
+		for (integer ipair = my firstPair; ipair <= my numberOfPairs; ipair += my pairStep) {
+			if (*my cancelled) MelderThread_RETURN;
+			integer i = my prototype [ipair], j = my candidate [ipair];
+			my me = my ccs -> at [i];
+			my thee = my ccs -> at [j];
+			my rme = my regressions ? my regressions [i] : nullptr;
+			my rthee = my regressions ? my regressions [j] : nullptr;
+			bool useLowerBound = my maximumDistance > 0.0 && (my wc != 0.0 || my wle != 0.0);
+			if (useLowerBound) {
+				my numberOfCoefficients = CC_getMinimumNumberOfCoefficients (my thee, 1, my thee -> nx);
+				integer minimumOfPrototype = CC_getMinimumNumberOfCoefficients (my me, 1, my me -> nx);
+				if (minimumOfPrototype < my numberOfCoefficients) {
+					my numberOfCoefficients = minimumOfPrototype;
+				}
+				if (my wc == 0.0) {
+					my numberOfCoefficients = 0;
+				}
+				my minQueue.reset (0, my numberOfCoefficients, 1, my me -> nx);
+				my maxQueue.reset (0, my numberOfCoefficients, 1, my me -> nx);
+				my minHead.reset (0, my numberOfCoefficients);
+				my maxHead.reset (0, my numberOfCoefficients);
+				my minTail.reset (0, my numberOfCoefficients);
+				my maxTail.reset (0, my numberOfCoefficients);
+				for (integer k = 0; k <= my numberOfCoefficients; k ++) {
+					my minHead [k] = my maxHead [k] = 1;
 				}
+				my lastFrameInQueues = 0;
+			}
+			double distance = DTW_findWeightedDistance (my me -> xmin, my me -> xmax, my me -> nx, my me -> dx, my me -> x1,
+				my thee -> xmin, my thee -> xmax, my thee -> nx, my thee -> dx, my thee -> x1, my sakoeChibaBand, my slope,
+				CCs_to_Distance_dtw_getDistances, useLowerBound ? CCs_to_Distance_dtw_getLowerBound : nullptr, me, my maximumDistance);
+			if (isundef (distance)) {
+				distance = my maximumDistance;
+			}
+			my distances [i] [j] = my distances [j] [i] = distance;
+			numberOfPairsDone ++;
+			if (my isMainThread) {
+				Melder_progress ((double) numberOfPairsDone / numberOfPairsToDo,
+					U"Pair ", numberOfPairsDone, U" out of ", numberOfPairsToDo, U".");
+			}
+		}
+	} catch (MelderError) {
+		*my cancelled = 1;
+		if (my isMainThread) throw;
+	}
+	MelderThread_RETURN;
+}
+
+autoDistance CCs_to_Distance_dtw (OrderedOf<structCC> *me, double wc, double wle, double wr, double wer, double dtr, double sakoeChibaBand, int slope, double maximumDistance) {
+	try {
+		integer numberOfCCs = my size;
+		Melder_require (numberOfCCs > 1,
+			U"There should be at least two CCs.");
+		Melder_require (wc != 0.0 || wle != 0.0 || wr != 0.0 || wer != 0.0,
+			U"At least one of the weights should not be zero.");
+		Melder_require (slope >= 1 && slope <= 4,
+			U"The slope constraint should be 1, 2, 3 or 4.");
+		CC first = my at [1];
+		for (integer i = 2; i <= numberOfCCs; i ++) {
+			Melder_require (my at [i] -> maximumNumberOfCoefficients == first -> maximumNumberOfCoefficients,
+				U"CC orders should be equal.");
+			Melder_require (my at [i] -> dx == first -> dx,
+				U"The time steps of the CCs should be equal.");
+		}
+		integer nr = Melder_ifloor (dtr / first -> dx);
+		Melder_require (! (wr != 0.0 && nr < 2),
+			U"Time window for regression is too small.");
+		if (nr % 2 == 0) {
+			nr ++;
+		}
+
+		autoDistance thee = Distance_create (numberOfCCs);
+		for (integer i = 1; i <= numberOfCCs; i ++) {
+			const char32 *name = Thing_getName (my at [i]);
+			TableOfReal_setRowLabel (thee.get(), i, name ? name : U"");
+			TableOfReal_setColumnLabel (thee.get(), i, name ? name : U"");
+		}
 
-				dist /= wc + wle + wr + wer;
-				his z [i] [j] = sqrt ((double) dist);   // prototype along y-direction
+		/*
+			The regression coefficients of all CCs in one matrix, CC i in rows offset [i] + 1 .. offset [i] + nx.
+		*/
+		autoNUMmatrix <double> regressionCoefficients;
+		autoNUMvector <double **> regressions;
+		if (wr != 0.0 || wer != 0.0) {
+			autoNUMvector <integer> offset ((integer) 1, numberOfCCs);
+			integer numberOfFrames = 0;
+			for (integer i = 1; i <= numberOfCCs; i ++) {
+				offset [i] = numberOfFrames;
+				numberOfFrames += my at [i] -> nx;
+			}
+			regressionCoefficients.reset (1, numberOfFrames, 0, first -> maximumNumberOfCoefficients);
+			regressions.reset (1, numberOfCCs);
+			for (integer i = 1; i <= numberOfCCs; i ++) {
+				regressions [i] = regressionCoefficients.peek() + offset [i];
+				CC_into_regressionCoefficients (my at [i], nr, regressions [i]);
 			}
+		}
 
-			if (i % 10 == 1) {
-				Melder_progress (0.999 * i / my nx, U"Calculate distances: frame ", i, U" from ", my nx, U".");
+		integer numberOfPairs = numberOfCCs * (numberOfCCs - 1) / 2;
+		autoNUMvector <integer> prototype ((integer) 1, numberOfPairs), candidate ((integer) 1, numberOfPairs);
+		integer ipair = 0;
+		for (integer i = 1; i < numberOfCCs; i ++) {
+			for (integer j = i + 1; j <= numberOfCCs; j ++) {
+				ipair ++;
+				prototype [ipair] = i;
+				candidate [ipair] = j;
 			}
 		}
-		return him;
+
+		int numberOfThreads = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads > numberOfPairs) numberOfThreads = (int) numberOfPairs;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		autoCCs_to_Distance_dtw_Args args [16];
+		volatile int cancelled = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			autoCCs_to_Distance_dtw_Args arg = Thing_new (CCs_to_Distance_dtw_Args);
+			arg -> ccs = me;
+			arg -> regressions = regressions.peek();
+			arg -> prototype = prototype.peek();
+			arg -> candidate = candidate.peek();
+			arg -> numberOfPairs = numberOfPairs;
+			arg -> firstPair = ithread;
+			arg -> pairStep = numberOfThreads;
+			arg -> wc = wc;
+			arg -> wle = wle;
+			arg -> wr = wr;
+			arg -> wer = wer;
+			arg -> sakoeChibaBand = sakoeChibaBand;
+			arg -> maximumDistance = maximumDistance;
+			arg -> slope = slope;
+			arg -> distances = thy data;
+			arg -> isMainThread = ( ithread == numberOfThreads );
+			arg -> cancelled = & cancelled;
+			args [ithread - 1] = arg.move();
+		}
+		{// scope
+			autoMelderProgress progress (U"CCs_to_Distance_dtw");
+			MelderThread_run (CCs_to_Distance_dtw_pairs, args, numberOfThreads);
+		}
+		if (cancelled)
+			Melder_throw (U"Calculation interrupted.");
+		return thee;
 	} catch (MelderError) {
-		Melder_throw (U"DTW not created from CCs.");
+		Melder_throw (U"Distance not created from CCs.");
 	}
 }
 
@@ -27,9 +27,10 @@
 
 #include "CC.h"
 #include "DTW.h"
+#include "Distance.h"
 
 
-autoDTW CCs_to_DTW (CC me, CC thee, double wc, double wle, double wr, double wer, double dtr);
+autoDTW CCs_to_DTW (CC me, CC thee, double wc, double wle, double wr, double wer, double dtr, double sakoeChibaBand, int slope);
 /*
 	1. Calculate distances between CCs:
 		Distance between frame i (from me) and j (from thee) is
@@ -44,9 +45,23 @@ autoDTW CCs_to_DTW (CC me, CC thee, double wc, double wle, double wr, double wer
 			d4 = regression on energy (c[0])
 	2. Find optimum path through the distance matrix (see DTW).
 
+	If sakoeChibaBand > 0, only the distances inside the band that a path with the slope
+	constraint can visit are calculated and stored (see DTW_createBanded).
+
 	PRECONDITIONS:
 
 	at least one of wc, wle, wr, wer != 0
 */
 
+autoDistance CCs_to_Distance_dtw (OrderedOf<structCC> *me, double wc, double wle, double wr, double wer, double dtr, double sakoeChibaBand, int slope, double maximumDistance);
+/*
+	The weighted DTW distance between each pair of CCs, with the frame distances as in CCs_to_DTW
+	and the path as found by DTW_findPath_bandAndSlope. Only the cumulative distances of the last
+	few columns are kept for each pair, and the pairs are computed in parallel.
+	If maximumDistance > 0, the calculation of a pair is abandoned as soon as its distance is certain
+	to exceed maximumDistance (an LB_Keogh bound on the cepstral and energy terms is tried first),
+	and maximumDistance is reported for that pair.
+	The row and column labels are the names of the CCs.
+*/
+
 #endif /* _CCs_to_DTW_h_ */
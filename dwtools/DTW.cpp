@@ -76,16 +76,53 @@ void structDTW :: v_info () {
 	if (nx == ny) {
 		double dd = 0;
 		for (integer i = 1; i <= nx; i ++) {
-			dd += z [i] [i];
+			dd += DTW_getDistance (this, i, i);
 		}
 		MelderInfo_writeLine (U"Distance ilong diagonal: ", dd / nx);
 	}
+	if (bandDistances) {
+		MelderInfo_writeLine (U"Number of distances stored in Sakoe-Chiba band: ", numberOfBandCells);
+		MelderInfo_writeLine (U"A DTW with a Sakoe-Chiba band cannot be saved; \"Expand Sakoe-Chiba band\" first.");
+	}
+}
+
+bool structDTW :: v_writable () {
+	return ! bandDistances;   // the file format has no place for the band; see DTW_expandBand
+}
+
+double structDTW :: v_getMatrix (integer irow, integer icol) {
+	if (! bandDistances) {
+		return DTW_Parent :: v_getMatrix (irow, icol);
+	}
+	if (irow < 1 || irow > ny || icol < 1 || icol > nx) {
+		return 0.0;
+	}
+	return DTW_getDistance (this, irow, icol);
+}
+
+double structDTW :: v_getFunction2 (double x, double y) {
+	if (! bandDistances) {
+		return DTW_Parent :: v_getFunction2 (x, y);
+	}
+	integer irow = Matrix_yToNearestRow (this, y), icol = Matrix_xToNearestColumn (this, x);
+	return v_getMatrix (irow, icol);
+}
+
+double structDTW :: v_getValueAtSample (integer isamp, integer ilevel, int unit) {
+	if (! bandDistances) {
+		return DTW_Parent :: v_getValueAtSample (isamp, ilevel, unit);
+	}
+	double value = DTW_getDistance (this, ilevel, isamp);
+	return ( isdefined (value) ? v_convertStandardToSpecialUnit (value, ilevel, unit) : undefined );
 }
 
 static void DTW_drawPath_raw (DTW me, Graphics g, double xmin, double xmax, double ymin, double ymax, bool garnish, bool inset);
 static void DTW_paintDistances_raw (DTW me, Graphics g, double xmin, double xmax, double ymin, double ymax, double minimum, double maximum, bool garnish, bool inset);
 static double _DTW_Sounds_getPartY (Graphics g, double dtw_part_x);
 static void DTW_findPath_special (DTW me, bool matchStart, bool matchEnd, int slope, autoMatrix *cumulativeDists);
+static void DTW_checkSlopeConstraints (DTW me, double band, int slope);
+static bool DTW_canMeetSlopeConstraints (DTW me, double band, int slope);
+static autoPolygon DTW_to_Polygon_raw (DTW me, double band, int slope);
 /*
 	Two 'slope lines, lh and ll, start in the lower left corner, the upper/lower has the maximum/minimum allowed slope.
 	Two other lines, ru and rl, end in the upper-right corner. The upper/lower line have minimum/maximum slope.
@@ -128,8 +165,7 @@ static void DTW_findPath_special (DTW me, bool matchStart, bool matchEnd, int sl
 		(x,y) = (nx*dx, dy) * (ny-1)/(nx*ny-1)
 */
 
-/* DTW_getXTime (DTW me, (DTW_getYTime (DTW me, double tx)) == tx */
-double DTW_getYTimeFromXTime (DTW me, double tx) {
+static double DTW_getYTimeFromXTime_continued (DTW me, double tx, integer *inout_lowIndex) {
 	// Catch cases where tier would give constant extrapolation
 	if (tx < my xmin) {
 		return my ymin - (my xmin - tx);
@@ -138,11 +174,10 @@ double DTW_getYTimeFromXTime (DTW me, double tx) {
 		return my ymax + (tx - my xmax);
 	}
 	DTW_Path_Query thee = & my pathQuery;
-	return RealTier_getValueAtTime(thy yfromx.get(), tx);
-
+	return RealTier_getValueAtTime_continued (thy yfromx.get(), tx, inout_lowIndex);
 }
 
-double DTW_getXTimeFromYTime (DTW me, double ty) {
+static double DTW_getXTimeFromYTime_continued (DTW me, double ty, integer *inout_lowIndex) {
 	// Catch cases where tier would give constant extrapolation
 	if (ty < my ymin) {
 		return my ymin - (my ymin - ty);
@@ -152,7 +187,32 @@ double DTW_getXTimeFromYTime (DTW me, double ty) {
 	}
 
 	DTW_Path_Query thee = & my pathQuery;
-	return RealTier_getValueAtTime(thy xfromy.get(), ty);
+	return RealTier_getValueAtTime_continued (thy xfromy.get(), ty, inout_lowIndex);
+}
+
+/* DTW_getXTime (DTW me, (DTW_getYTime (DTW me, double tx)) == tx */
+double DTW_getYTimeFromXTime (DTW me, double tx) {
+	integer lowIndex = 0;
+	return DTW_getYTimeFromXTime_continued (me, tx, & lowIndex);
+}
+
+double DTW_getXTimeFromYTime (DTW me, double ty) {
+	integer lowIndex = 0;
+	return DTW_getXTimeFromYTime_continued (me, ty, & lowIndex);
+}
+
+void DTW_getYTimesFromXTimes (DTW me, const double tx [], integer numberOfTimes, double ty []) {
+	integer lowIndex = 0;
+	for (integer i = 1; i <= numberOfTimes; i ++) {
+		ty [i] = DTW_getYTimeFromXTime_continued (me, tx [i], & lowIndex);
+	}
+}
+
+void DTW_getXTimesFromYTimes (DTW me, const double ty [], integer numberOfTimes, double tx []) {
+	integer lowIndex = 0;
+	for (integer i = 1; i <= numberOfTimes; i ++) {
+		tx [i] = DTW_getXTimeFromYTime_continued (me, ty [i], & lowIndex);
+	}
 }
 
 void DTW_Path_Query_init (DTW_Path_Query me, integer ny, integer nx) {
@@ -436,6 +496,170 @@ autoDTW DTW_create (double tminp, double tmaxp, integer ntp, double dtp, double
 	}
 }
 
+static autoDTW DTW_createWithoutDistances (double tminp, double tmaxp, integer ntp, double dtp, double t1p, double tminc, double tmaxc, integer ntc, double dtc, double t1c) {
+	autoDTW me = Thing_new (DTW);
+	Sampled_init (me.get(), tminc, tmaxc, ntc, dtc, t1c);
+	my ymin = tminp;
+	my ymax = tmaxp;
+	my ny = ntp;
+	my dy = dtp;
+	my y1 = t1p;
+	my wx = 1;
+	my wy = 1;
+	my wd = 2;
+	return me;
+}
+
+/*
+	Per column the rows between the lower and the upper border of the polygon, with one extra row on both sides.
+	Both borders never go down, as DTW_getBandColumns requires.
+*/
+static void DTW_Polygon_getRowLimits (DTW me, Polygon thee, integer *first, integer *last) {
+	for (integer ix = 1; ix <= my nx; ix ++) {
+		double x = my x1 + (ix - 1) * my dx;
+		double ylow = my ymax, yhigh = my ymin;
+		for (integer i = 1; i <= thy numberOfPoints; i ++) {
+			integer j = i % thy numberOfPoints + 1;
+			double xi = thy x [i], yi = thy y [i], xj = thy x [j], yj = thy y [j];
+			if ((x < xi && x < xj) || (x > xi && x > xj)) {
+				continue;
+			}
+			double ya = yi, yb = yj;
+			if (xi != xj) {
+				ya = yb = yi + (x - xi) * (yj - yi) / (xj - xi);
+			}
+			if (ya < ylow) ylow = ya;
+			if (yb < ylow) ylow = yb;
+			if (ya > yhigh) yhigh = ya;
+			if (yb > yhigh) yhigh = yb;
+		}
+		first [ix] = Melder_ifloor ((ylow - my y1) / my dy);   // = row - 1
+		last [ix] = Melder_iceiling ((yhigh - my y1) / my dy) + 2;   // = row + 1
+		if (ix > 1 && first [ix] < first [ix - 1]) first [ix] = first [ix - 1];
+		if (ix > 1 && last [ix] < last [ix - 1]) last [ix] = last [ix - 1];
+		if (first [ix] < 1) first [ix] = 1;
+		if (first [ix] > my ny) first [ix] = my ny;
+		if (last [ix] > my ny) last [ix] = my ny;
+		if (last [ix] < first [ix]) last [ix] = first [ix];
+	}
+}
+
+autoDTW DTW_createBanded (double tminp, double tmaxp, integer ntp, double dtp, double t1p, double tminc, double tmaxc, integer ntc, double dtc, double t1c, double sakoeChibaBand, int slope) {
+	try {
+		autoDTW me = DTW_createWithoutDistances (tminp, tmaxp, ntp, dtp, t1p, tminc, tmaxc, ntc, dtc, t1c);
+		my path = NUMvector<structDTW_Path> (1, ntc + ntp - 1);
+		DTW_Path_Query_init (& my pathQuery, ntp, ntc);
+		/*
+			If the constraints cannot be met the path finder will relax them and report.
+		*/
+		if (sakoeChibaBand > 0.0 && DTW_canMeetSlopeConstraints (me.get(), sakoeChibaBand, slope)) {
+			/*
+				Store the rows that the path finder may visit inside the polygon.
+			*/
+			autoPolygon thee = DTW_to_Polygon_raw (me.get(), sakoeChibaBand, slope);
+			autoNUMvector <integer> first (1, ntc), last (1, ntc), offset (1, ntc);
+			DTW_Polygon_getRowLimits (me.get(), thee.get(), first.peek(), last.peek());
+			integer numberOfCells = 0;
+			for (integer ix = 1; ix <= ntc; ix ++) {
+				offset [ix] = numberOfCells + 1 - first [ix];
+				numberOfCells += last [ix] - first [ix] + 1;
+			}
+			if ((double) numberOfCells < (double) ntc * ntp) {
+				my numberOfBandCells = numberOfCells;
+				my bandDistances = NUMvector <double> (1, numberOfCells);
+				my bandFirst = first.transfer();
+				my bandLast = last.transfer();
+				my bandOffset = offset.transfer();
+				return me;
+			}
+		}
+		my z = NUMmatrix <double> (1, ntp, 1, ntc);
+		return me;
+	} catch (MelderError) {
+		Melder_throw (U"Banded DTW not created.");
+	}
+}
+
+void DTW_expandBand (DTW me) {
+	try {
+		if (! my bandDistances) return;
+		autoNUMmatrix <double> z (1, my ny, 1, my nx);
+		for (integer ix = 1; ix <= my nx; ix ++) {
+			for (integer iy = 1; iy <= my ny; iy ++) {
+				z [iy] [ix] = DTW_getDistance (me, iy, ix);
+			}
+		}
+		my z = z.transfer();
+		NUMvector_free (my bandDistances, 1);
+		NUMvector_free (my bandFirst, 1);
+		NUMvector_free (my bandLast, 1);
+		NUMvector_free (my bandOffset, 1);
+		my bandDistances = nullptr;
+		my bandFirst = my bandLast = my bandOffset = nullptr;
+		my numberOfBandCells = 0;
+	} catch (MelderError) {
+		Melder_throw (me, U": band not expanded.");
+	}
+}
+
+void DTW_getBandColumns (DTW me, integer iy, integer *ixFirst, integer *ixLast) {
+	*ixFirst = 1;
+	*ixLast = my nx;
+	if (! my bandDistances) {
+		return;
+	}
+	/*
+		Both bandFirst and bandLast never decrease: bisect for the first column whose band reaches up to iy
+		and for the last column whose band starts at or below iy.
+	*/
+	integer lo = 1, hi = my nx + 1;
+	while (lo < hi) {
+		integer mid = (lo + hi) / 2;
+		if (my bandLast [mid] >= iy) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	*ixFirst = lo;
+	lo = 0;
+	hi = my nx;
+	while (lo < hi) {
+		integer mid = (lo + hi + 1) / 2;
+		if (my bandFirst [mid] <= iy) {
+			lo = mid;
+		} else {
+			hi = mid - 1;
+		}
+	}
+	*ixLast = lo;
+}
+
+void DTW_getWindowExtrema (DTW me, integer ixmin, integer ixmax, integer iymin, integer iymax, double *minimum, double *maximum) {
+	if (! my bandDistances) {
+		(void) Matrix_getWindowExtrema (me, ixmin, ixmax, iymin, iymax, minimum, maximum);
+		return;
+	}
+	if (ixmin == 0) ixmin = 1;
+	if (ixmax == 0) ixmax = my nx;
+	if (iymin == 0) iymin = 1;
+	if (iymax == 0) iymax = my ny;
+	*minimum = *maximum = undefined;
+	for (integer ix = ixmin; ix <= ixmax; ix ++) {
+		integer iyfrom = my bandFirst [ix] > iymin ? my bandFirst [ix] : iymin;
+		integer iyto = my bandLast [ix] < iymax ? my bandLast [ix] : iymax;
+		for (integer iy = iyfrom; iy <= iyto; iy ++) {
+			double d = my bandDistances [my bandOffset [ix] + iy];
+			if (isundef (*minimum) || d < *minimum) {
+				*minimum = d;
+			}
+			if (isundef (*maximum) || d > *maximum) {
+				*maximum = d;
+			}
+		}
+	}
+}
+
 void DTW_setWeights (DTW me, double wx, double wy, double wd) {
 	my wx = wx;
 	my wy = wy;
@@ -444,6 +668,7 @@ void DTW_setWeights (DTW me, double wx, double wy, double wd) {
 
 autoDTW DTW_swapAxes (DTW me) {
 	try {
+		Melder_require (! DTW_isBanded (me), U"The axes of a banded DTW cannot be swapped.");
 		autoDTW thee = DTW_create (my xmin, my xmax, my nx, my dx, my x1, my ymin, my ymax, my ny, my dy, my y1);
 
 		for (integer x = 1; x <= my nx; x ++) {
@@ -615,7 +840,7 @@ static void DTW_paintDistances_raw (DTW me, Graphics g, double xmin, double xmax
 	(void) Matrix_getWindowSamplesX (me, xmin - 0.49999 * my dx, xmax + 0.49999 * my dx, & ixmin, & ixmax);
 	(void) Matrix_getWindowSamplesY (me, ymin - 0.49999 * my dy, ymax + 0.49999 * my dy, & iymin, & iymax);
 	if (maximum <= minimum) {
-		(void) Matrix_getWindowExtrema (me, ixmin, ixmax, iymin, iymax, & minimum, & maximum);
+		DTW_getWindowExtrema (me, ixmin, ixmax, iymin, iymax, & minimum, & maximum);
 	}
 	if (maximum <= minimum) {
 		minimum -= 1.0;
@@ -624,11 +849,25 @@ static void DTW_paintDistances_raw (DTW me, Graphics g, double xmin, double xmax
 	if (xmin >= xmax || ymin >= ymax) {
 		return;
 	}
+	/*
+		A banded DTW has no distances outside the band: paint these cells as the minimum.
+	*/
+	autoNUMmatrix <double> banded;
+	double **z = my z;
+	if (DTW_isBanded (me)) {
+		banded.reset (iymin, iymax, ixmin, ixmax);
+		for (integer iy = iymin; iy <= iymax; iy ++) {
+			for (integer ix = ixmin; ix <= ixmax; ix ++) {
+				banded [iy] [ix] = ( DTW_isInBand (me, iy, ix) ? DTW_getDistance (me, iy, ix) : minimum );
+			}
+		}
+		z = banded.peek();
+	}
 	if (inset) {
 		Graphics_setInner (g);
 	}
 	Graphics_setWindow (g, xmin, xmax, ymin, ymax);
-	Graphics_cellArray (g, my z, ixmin, ixmax, Matrix_columnToX (me, ixmin - 0.5), Matrix_columnToX (me, ixmax + 0.5), iymin, iymax, Matrix_rowToY (me, iymin - 0.5), Matrix_rowToY (me, iymax + 0.5), minimum, maximum);
+	Graphics_cellArray (g, z, ixmin, ixmax, Matrix_columnToX (me, ixmin - 0.5), Matrix_columnToX (me, ixmax + 0.5), iymin, iymax, Matrix_rowToY (me, iymin - 0.5), Matrix_rowToY (me, iymax + 0.5), minimum, maximum);
 	Graphics_rectangle (g, xmin, xmax, ymin, ymax);
 	if (inset) {
 		Graphics_unsetInner (g);
@@ -863,7 +1102,15 @@ void DTW_Sounds_drawWarpX (DTW me, Sound yy, Sound xx, Graphics g, double xmin,
 autoMatrix DTW_to_Matrix_distances (DTW me) {
 	try {
 		autoMatrix thee = Matrix_create (my xmin, my xmax, my nx, my dx, my x1, my ymin, my ymax, my ny, my dy, my y1);
-		NUMmatrix_copyElements (my z, thy z, 1, my ny, 1, my nx);
+		if (DTW_isBanded (me)) {
+			for (integer iy = 1; iy <= my ny; iy ++) {
+				for (integer ix = 1; ix <= my nx; ix ++) {
+					thy z [iy] [ix] = DTW_getDistance (me, iy, ix);   // undefined outside the band
+				}
+			}
+		} else {
+			NUMmatrix_copyElements (my z, thy z, 1, my ny, 1, my nx);
+		}
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": distances not converted to Matrix.");
@@ -894,7 +1141,7 @@ void DTW_drawDistancesAlongPath (DTW me, Graphics g, double xmin, double xmax, d
 	autoNUMvector<double> d (ixmin, ixmax);
 
 	for (integer i = ixmin; i <= ixmax; i ++) {
-		d [i] = my z [my path [i]. y] [i];
+		d [i] = DTW_getDistance (me, my path [i]. y, i);
 	}
 
 	if (dmin >= dmax) {
@@ -925,14 +1172,16 @@ void DTW_drawDistancesAlongPath (DTW me, Graphics g, double xmin, double xmax, d
 /*
 	metric = 1...n (sum (a_i^n))^(1/n)
 */
-autoDTW Matrices_to_DTW (Matrix me, Matrix thee, bool matchStart, bool matchEnd, int slope, double metric) {
+autoDTW Matrices_to_DTW (Matrix me, Matrix thee, bool matchStart, bool matchEnd, int slope, double metric, double sakoeChibaBand) {
 	try {
 		Melder_require (thy ny == my ny, U"Column sizes should be equal.");
 
-		autoDTW him = DTW_create (my xmin, my xmax, my nx, my dx, my x1, thy xmin, thy xmax, thy nx, thy dx, thy x1);
+		autoDTW him = DTW_createBanded (my xmin, my xmax, my nx, my dx, my x1, thy xmin, thy xmax, thy nx, thy dx, thy x1, sakoeChibaBand, slope);
 		autoMelderProgress progess (U"Calculate distances");
 		for (integer i = 1; i <= my nx; i ++) {
-			for (integer j = 1; j <= thy nx; j ++) {
+			integer jfrom, jto;
+			DTW_getBandColumns (him.get(), i, & jfrom, & jto);
+			for (integer j = jfrom; j <= jto; j ++) {
 				/*
 					First divide distance by maximum to prevent overflow when metric
 					is a large number.
@@ -952,7 +1201,7 @@ autoDTW Matrices_to_DTW (Matrix me, Matrix thee, bool matchStart, bool matchEnd,
 					}
 				}
 				d = dmax * pow (d, 1.0 / metric);
-				his z [i] [j] = d / my ny; // == d * dy / ymax
+				DTW_setDistance (him.get(), i, j, d / my ny); // == d * dy / ymax
 			}
 			if ((i % 10) == 1) {
 				Melder_progress (0.999 * i / my nx, U"Calculate distances: column ", i, U" from ", my nx, U".");
@@ -965,7 +1214,7 @@ autoDTW Matrices_to_DTW (Matrix me, Matrix thee, bool matchStart, bool matchEnd,
 	}
 }
 
-autoDTW Spectrograms_to_DTW (Spectrogram me, Spectrogram thee, bool matchStart, bool matchEnd, int slope, double metric) {
+autoDTW Spectrograms_to_DTW (Spectrogram me, Spectrogram thee, bool matchStart, bool matchEnd, int slope, double metric, double sakoeChibaBand) {
 	try {
 		Melder_require (my xmin == thy xmin && my ymax == thy ymax && my ny == thy ny, U"The number of frequencies and/or frequency ranges should be equal.");
 
@@ -985,7 +1234,7 @@ autoDTW Spectrograms_to_DTW (Spectrogram me, Spectrogram thee, bool matchStart,
 			}
 		}
 
-		autoDTW him = Matrices_to_DTW (m1.get(), m2.get(), matchStart, matchEnd, slope, metric);
+		autoDTW him = Matrices_to_DTW (m1.get(), m2.get(), matchStart, matchEnd, slope, metric, sakoeChibaBand);
 		return him;
 	} catch (MelderError) {
 		Melder_throw (U"DTW not created from Spectrograms.");
@@ -1101,6 +1350,7 @@ void DTW_Matrix_replace (DTW me, Matrix thee) {
 			U"The X and Y domains of the matrix and the DTW must be equal.");
 		Melder_require (my nx == thy nx && my dx == thy dx && my ny == thy ny && my dy == thy dy,
 			U"The sampling of the matrix and the DTW should be equal.");
+		Melder_require (! DTW_isBanded (me), U"The distances of a banded DTW cannot be replaced.");
 		
 		double minimum, maximum;
 		Matrix_getWindowExtrema (me, 0, 0, 0, 0, & minimum, & maximum);
@@ -1136,6 +1386,18 @@ static void DTW_relaxConstraints (DTW me, double band, int slope, double *relaxe
 	*relaxedSlope = 1;
 }
 
+static bool DTW_canMeetSlopeConstraints (DTW me, double band, int slope) {
+	double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 } ;
+	double dtw_slope = (my ymax - my ymin - band) / (my xmax - my xmin - band);
+	if (slope < 1 || slope > 4 || (dtw_slope == 0.0 && slope != 1)) {
+		return false;
+	}
+	if (dtw_slope < 1.0) {
+		dtw_slope = 1.0 / dtw_slope;
+	}
+	return dtw_slope <= slopes [slope];
+}
+
 static void DTW_checkSlopeConstraints (DTW me, double band, int slope) {
     try {
         double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 } ;
@@ -1152,52 +1414,173 @@ static void DTW_checkSlopeConstraints (DTW me, double band, int slope) {
     }
 }
 
-static void DTW_Polygon_setUnreachableParts (DTW me, Polygon thee, integer **psi) {
-    try {
-        double eps = my dx / 100.0;   // safe enough
-        double dtw_slope = (my ymax - my ymin) / (my xmax - my xmin);
-
-        double xmin, xmax, ymin, ymax;
-        Polygon_getExtrema (thee, & xmin, & xmax, & ymin, & ymax);
-        // if the Polygon and the DTW don't overlap everything is unreachable!
-        if (xmax <= my xmin || xmin >= my xmax || ymax <= my ymin || ymin >= my ymax) {
-            Melder_throw (U"DTW and Polygon don't overlap.");
-        }
-        // find border "above" polygon
-        for (integer ix = 1; ix <= my nx; ix ++) {
-            double x = my x1 + (ix - 1) * my dx;
-            integer iystart = Melder_ifloor (dtw_slope * ix * (my dx / my dy)) + 1;
-            for (integer iy = iystart + 1; iy <= my ny; iy ++) {
-                double y = my y1 + (iy - 1) * my dy;
-                if (Polygon_getLocationOfPoint (thee, x, y, eps) == Polygon_OUTSIDE) {
-                    for (integer k = iy; k <= my ny; k ++) {
-                        psi [k] [ix] =  DTW_UNREACHABLE;
-                    }
-                    break;
-                }
-            }
-        }
-        // find border "below" polygon
-        for (integer ix = 2; ix <= my nx; ix ++) {
-            double x = my x1 + (ix - 1) * my dx;
-            integer iystart = Melder_ifloor (dtw_slope * ix * (my dx / my dy));   // start 1 lower
-            if (iystart > my ny) iystart = my ny;
-            for (integer iy = iystart - 1; iy >= 1; iy --) {
-                double y = my y1 + (iy - 1) * my dy;
-                if (Polygon_getLocationOfPoint (thee, x, y, eps) == Polygon_OUTSIDE) {
-                    for (integer k = iy; k >= 1; k --) {
-                        psi [k] [ix] = DTW_UNREACHABLE;
-                    }
-                    break;
-                }
-            }
-        }
-    } catch (MelderError) {
-        Melder_throw (me, U" cannot set unreachable parts.");
-    }
+/*
+	The cumulative distances (delta) and the back pointers (psi) of the path search are stored
+	column by column, for the rows first [ix] .. last [ix] only: all rows for a DTW with a full
+	distance matrix, the Sakoe-Chiba band for a banded DTW.
+	Cells outside these rows are unreachable.
+	Without a DTW the distances are computed column by column with getDistances, and only the last
+	four columns are kept (the search looks back at most three columns).
+*/
+struct DTW_SearchCells {
+	integer nx, ny;
+	DTW dtw;   // where the distances are, if any
+	void (*getDistances) (void *closure, integer ix, integer iyFirst, integer iyLast, double *distances);
+	void *closure;
+	autoNUMvector <integer> first, last, offset;
+	autoNUMvector <double> distance, delta;
+	autoNUMvector <integer> psi;
+};
+
+static void DTW_SearchCells_init (DTW_SearchCells *me, DTW dtw) {
+	my nx = dtw -> nx;
+	my ny = dtw -> ny;
+	my dtw = dtw;
+	my getDistances = nullptr;
+	my closure = nullptr;
+	my first.reset (1, dtw -> nx);
+	my last.reset (1, dtw -> nx);
+	my offset.reset (1, dtw -> nx);
+	integer numberOfCells = 0;
+	for (integer ix = 1; ix <= dtw -> nx; ix ++) {
+		my first [ix] = DTW_isBanded (dtw) ? dtw -> bandFirst [ix] : 1;
+		my last [ix] = DTW_isBanded (dtw) ? dtw -> bandLast [ix] : dtw -> ny;
+		my offset [ix] = numberOfCells + 1 - my first [ix];
+		numberOfCells += my last [ix] - my first [ix] + 1;
+	}
+	my delta.reset (1, numberOfCells);
+	my psi.reset (1, numberOfCells);
+}
+
+static void DTW_SearchCells_initRolling (DTW_SearchCells *me, DTW frame, Polygon polygon,
+	void (*getDistances) (void *closure, integer ix, integer iyFirst, integer iyLast, double *distances), void *closure)
+{
+	my nx = frame -> nx;
+	my ny = frame -> ny;
+	my dtw = nullptr;
+	my getDistances = getDistances;
+	my closure = closure;
+	my first.reset (1, frame -> nx);
+	my last.reset (1, frame -> nx);
+	my offset.reset (1, frame -> nx);
+	DTW_Polygon_getRowLimits (frame, polygon, my first.peek(), my last.peek());
+	integer height = 0;
+	for (integer ix = 1; ix <= frame -> nx; ix ++) {
+		if (my last [ix] - my first [ix] + 1 > height) {
+			height = my last [ix] - my first [ix] + 1;
+		}
+	}
+	for (integer ix = 1; ix <= frame -> nx; ix ++) {
+		my offset [ix] = (ix % 4) * height + 1 - my first [ix];
+	}
+	my distance.reset (1, 4 * height);
+	my delta.reset (1, 4 * height);
+	my psi.reset (1, 4 * height);
+}
+
+inline static bool DTW_SearchCells_contains (DTW_SearchCells *me, integer iy, integer ix) {
+	return ix >= 1 && ix <= my nx && iy >= my first [ix] && iy <= my last [ix];
+}
+
+inline static double DTW_SearchCells_getDistance (DTW_SearchCells *me, integer iy, integer ix) {
+	return ( my dtw ? DTW_getDistance (my dtw, iy, ix) : my distance [my offset [ix] + iy] );
 }
 
-#define DTW_ISREACHABLE(y,x) ((psi [y] [x] != DTW_UNREACHABLE) && (psi [y] [x] != DTW_FORBIDDEN))
+inline static integer DTW_SearchCells_getPsi (DTW_SearchCells *me, integer iy, integer ix) {
+	return ( DTW_SearchCells_contains (me, iy, ix) ? my psi [my offset [ix] + iy] : DTW_UNREACHABLE );
+}
+
+inline static void DTW_SearchCells_setPsi (DTW_SearchCells *me, integer iy, integer ix, integer direction) {
+	if (DTW_SearchCells_contains (me, iy, ix)) {
+		my psi [my offset [ix] + iy] = direction;
+	}
+}
+
+/*
+	Column ix before the forward pass: distances, outside borders and the begin parts of
+	the first column and the first row.
+*/
+static void DTW_SearchCells_initColumn (DTW_SearchCells *me, integer ix, int localSlope, integer rowto, integer colto) {
+	if (my getDistances) {
+		my getDistances (my closure, ix, my first [ix], my last [ix], & my distance [my offset [ix]]);
+	}
+	for (integer iy = my first [ix]; iy <= my last [ix]; iy ++) {
+		my delta [my offset [ix] + iy] = DTW_SearchCells_getDistance (me, iy, ix);
+		my psi [my offset [ix] + iy] = 0;
+	}
+	// start by making the outside unreachable
+	DTW_SearchCells_setPsi (me, 1, ix, DTW_UNREACHABLE);
+	if (ix == 1) {
+		for (integer iy = my first [1]; iy <= my last [1]; iy ++) {
+			DTW_SearchCells_setPsi (me, iy, 1, DTW_UNREACHABLE);
+		}
+		// Make begin part of first column reachable
+		for (integer iy = 2; iy <= rowto && DTW_SearchCells_contains (me, iy, 1); iy ++) {
+			if (localSlope != 1) {
+				my delta [my offset [1] + iy] = my delta [my offset [1] + iy - 1] + DTW_SearchCells_getDistance (me, iy, 1);
+				DTW_SearchCells_setPsi (me, iy, 1, DTW_Y);
+			} else {
+				DTW_SearchCells_setPsi (me, iy, 1, DTW_START); // will be adapted by DTW_Polygon_setUnreachableParts
+			}
+		}
+	} else if (ix <= colto && my first [ix] == 1) {
+		// Make begin part of first row reachable
+		if (localSlope != 1) {
+			my delta [my offset [ix] + 1] = my delta [my offset [ix - 1] + 1] + DTW_SearchCells_getDistance (me, 1, ix);
+			DTW_SearchCells_setPsi (me, 1, ix, DTW_X);
+		} else {
+			DTW_SearchCells_setPsi (me, 1, ix, DTW_START); // will be adapted by DTW_Polygon_setUnreachableParts
+		}
+	}
+}
+
+static void DTW_Polygon_checkOverlap (DTW me, Polygon thee) {
+	double xmin, xmax, ymin, ymax;
+	Polygon_getExtrema (thee, & xmin, & xmax, & ymin, & ymax);
+	// if the Polygon and the DTW don't overlap everything is unreachable!
+	if (xmax <= my xmin || xmin >= my xmax || ymax <= my ymin || ymin >= my ymax) {
+		Melder_throw (me, U" cannot set unreachable parts: DTW and Polygon don't overlap.");
+	}
+}
+
+static void DTW_Polygon_setUnreachableParts (DTW me, Polygon thee, DTW_SearchCells *cells, integer ix) {
+	double eps = my dx / 100.0;   // safe enough
+	double dtw_slope = (my ymax - my ymin) / (my xmax - my xmin);
+	double x = my x1 + (ix - 1) * my dx;
+	// find border "above" polygon
+	integer iystart = Melder_ifloor (dtw_slope * ix * (my dx / my dy)) + 1;
+	if (iystart < cells -> first [ix] - 1) iystart = cells -> first [ix] - 1;
+	for (integer iy = iystart + 1; iy <= cells -> last [ix]; iy ++) {
+		double y = my y1 + (iy - 1) * my dy;
+		if (Polygon_getLocationOfPoint (thee, x, y, eps) == Polygon_OUTSIDE) {
+			for (integer k = iy; k <= cells -> last [ix]; k ++) {
+				DTW_SearchCells_setPsi (cells, k, ix, DTW_UNREACHABLE);
+			}
+			break;
+		}
+	}
+	// find border "below" polygon
+	if (ix < 2) {
+		return;
+	}
+	iystart = Melder_ifloor (dtw_slope * ix * (my dx / my dy));   // start 1 lower
+	if (iystart > cells -> last [ix] + 1) iystart = cells -> last [ix] + 1;
+	if (iystart > my ny) iystart = my ny;
+	for (integer iy = iystart - 1; iy >= cells -> first [ix]; iy --) {
+		double y = my y1 + (iy - 1) * my dy;
+		if (Polygon_getLocationOfPoint (thee, x, y, eps) == Polygon_OUTSIDE) {
+			for (integer k = iy; k >= cells -> first [ix]; k --) {
+				DTW_SearchCells_setPsi (cells, k, ix, DTW_UNREACHABLE);
+			}
+			break;
+		}
+	}
+}
+
+#define DTW_PSI(y,x) DTW_SearchCells_getPsi (cells, y, x)
+#define DTW_DELTA(y,x) cells -> delta [cells -> offset [x] + (y)]
+#define DTW_DISTANCE(y,x) DTW_SearchCells_getDistance (cells, y, x)
+#define DTW_ISREACHABLE(y,x) ((DTW_PSI (y, x) != DTW_UNREACHABLE) && (DTW_PSI (y, x) != DTW_FORBIDDEN))
 static void DTW_findPath_special (DTW me, bool matchStart, bool matchEnd, int slope, autoMatrix *cumulativeDists) {
     (void) matchStart;
     (void) matchEnd;
@@ -1217,14 +1600,17 @@ static void getIntersectionPoint (double x1, double y1, double x2, double y2, do
 }
 
 autoPolygon DTW_to_Polygon (DTW me, double band, int slope) {
+	try {
+		DTW_checkSlopeConstraints (me, band, slope);
+	} catch (MelderError) {
+		DTW_relaxConstraints (me, band, slope, & band, & slope);
+		Melder_flushError ();
+	}
+	return DTW_to_Polygon_raw (me, band, slope);
+}
+
+static autoPolygon DTW_to_Polygon_raw (DTW me, double band, int slope) {
     try {
-		try {
-			DTW_checkSlopeConstraints (me, band, slope);
-		} catch (MelderError) {
-			DTW_relaxConstraints (me, band, slope, & band, & slope);
-			Melder_flushError ();
-		}
-			
         double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 } ;
         if (band <= 0) {
             if (slope == 1) {
@@ -1333,164 +1719,150 @@ void DTW_findPath_bandAndSlope (DTW me, double sakoeChibaBand, int localSlope, a
     }
 }
 
-void DTW_Polygon_findPathInside (DTW me, Polygon thee, int localSlope, autoMatrix *cumulativeDists) {
-    try {
-        double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 };
-        // if localSlope == 1 start of path is within 10% of minimum duration. Starts farther away
-        integer delta_xy = (my nx < my ny ? my nx : my ny) / 10; // if localSlope == 1 start within 10% of
-
-        if (localSlope < 1 || localSlope > 4) {
-            Melder_throw (U"Local slope parameter is illegal.");
+static void DTW_SearchCells_forward (DTW_SearchCells *cells, integer j, int localSlope, integer *numberOfIsolatedPoints) {
+    integer ifrom = cells -> first [j] > 2 ? cells -> first [j] : 2;
+    for (integer i = ifrom; i <= cells -> last [j]; i ++) {
+        if (! DTW_ISREACHABLE (i, j)) continue;
+        double dij = DTW_DISTANCE (i, j);
+        double g, gmin = DTW_BIG;
+        integer direction = 0;
+        if (DTW_ISREACHABLE (i - 1, j - 1)) {
+            gmin = DTW_DELTA (i - 1, j - 1) + 2.0 * dij;
+            direction = DTW_XANDY;
+        } else if (DTW_ISREACHABLE (i, j - 1)) {
+            gmin = DTW_DELTA (i, j - 1) + dij;
+            direction = DTW_X;
+        } else if (DTW_ISREACHABLE (i - 1, j)) {
+            gmin = DTW_DELTA (i - 1, j) + dij;
+            direction = DTW_Y;
+        } else {
+            (*numberOfIsolatedPoints) ++;
+            continue;
         }
 
-        autoNUMmatrix<double> delta (-2, my ny, -2, my nx);
-        autoNUMmatrix<integer> psi (-2, my ny, -2, my nx);
-        for (integer i = 1; i <= my ny; i ++) {
-            for (integer j = 1; j <= my nx; j ++) {
-                delta [i] [j] = my z [i] [j];
+        switch (localSlope) {
+        case 1:  { // no restriction
+            if (DTW_ISREACHABLE (i, j - 1) && ((g = DTW_DELTA (i, j - 1) + dij) < gmin)) {
+                gmin = g;
+                direction = DTW_X;
+            }
+            if (DTW_ISREACHABLE (i - 1, j) && ((g = DTW_DELTA (i - 1, j) + dij) < gmin)) {
+                gmin = g;
+                direction = DTW_Y;
             }
         }
-        // start by making the outside unreachable
-        for (integer k = -2; k <= 1; k ++) {
-           for (integer j = -2; j <= my nx; j ++) {
-               // delta [k] [j] = DTW_BIG;
-                psi [k] [j] = DTW_UNREACHABLE;
+        break;
+
+        // P = 1/2
+
+        case 2: { // P = 1/2
+            if (DTW_ISREACHABLE (i - 1, j - 3) && DTW_PSI (i, j - 1) == DTW_X && DTW_PSI (i, j - 2) == DTW_XANDY &&
+                (g = DTW_DELTA (i-1, j-3) + 2.0 * DTW_DISTANCE (i, j-2) + DTW_DISTANCE (i, j-1) + dij) < gmin) {
+                gmin = g;
+                direction = DTW_X;
             }
-            for (integer i = 1; i <= my ny; i ++) {
-             //   delta [i] [k] = DTW_BIG;
-                psi [i] [k] = DTW_UNREACHABLE;
+            if (DTW_ISREACHABLE (i - 1, j - 2) && DTW_PSI (i, j - 1) == DTW_XANDY &&
+                (g = DTW_DELTA (i - 1, j - 2) + 2.0 * DTW_DISTANCE (i, j - 1) + dij) < gmin) {
+                gmin = g;
+                direction = DTW_X;
+            }
+            if (DTW_ISREACHABLE (i - 2, j - 1) && DTW_PSI (i - 1, j) == DTW_XANDY &&
+                (g = DTW_DELTA (i - 2, j - 1) + 2.0 * DTW_DISTANCE (i - 1, j) + dij) < gmin) {
+                gmin = g;
+                direction = DTW_Y;
+            }
+            if (DTW_ISREACHABLE (i - 3, j - 1) && DTW_PSI (i - 1, j) == DTW_Y && DTW_PSI (i - 2, j) == DTW_XANDY &&
+                (g = DTW_DELTA (i-3, j-1) + 2.0 * DTW_DISTANCE (i-2, j) + DTW_DISTANCE (i-1, j) + dij) < gmin) {
+                gmin = g;
+                direction = DTW_Y;
             }
         }
+        break;
 
-        // Make begin part of first column reachable
-        integer rowto = delta_xy;
-        if (localSlope != 1) {
-			rowto = Melder_ifloor (slopes [localSlope]) + 1;
-		}
-        for (integer iy = 2; iy <= rowto; iy ++) {
-            if (localSlope != 1) {
-                delta [iy] [1] = delta [iy - 1] [1] + my z [iy] [1];
-                psi [iy] [1] = DTW_Y;
-            } else {
-                psi [iy] [1] = DTW_START; // will be adapted by DTW_Polygon_setUnreachableParts
+        // P = 1
+
+        case 3: {
+            if (DTW_ISREACHABLE (i - 1, j - 2) && DTW_PSI (i, j - 1) == DTW_XANDY &&
+                (g = DTW_DELTA (i - 1, j - 2) + 2.0 * DTW_DISTANCE (i, j - 1) + dij) < gmin) {
+                gmin = g;
+                direction = DTW_X;
+            }
+            if (DTW_ISREACHABLE (i - 2, j - 1) && DTW_PSI (i - 1, j) == DTW_XANDY &&
+                (g = DTW_DELTA (i - 2, j - 1) + 2.0 * DTW_DISTANCE (i - 1, j) + dij) < gmin) {
+                gmin = g;
+                direction = DTW_Y;
             }
         }
-        // Make begin part of first row reachable
-        integer colto = delta_xy;
-        if (localSlope != 1) {
-			colto = Melder_ifloor (slopes [localSlope]) + 1;
-		}
-        for (integer ix = 2; ix <= colto; ix ++) {
-            if (localSlope != 1) {
-                delta [1] [ix] = delta [1] [ix -1] + my z [1] [ix];
-                psi [1] [ix] = DTW_X;
-            } else {
-                psi [1] [ix] = DTW_START; // will be adapted by DTW_Polygon_setUnreachableParts
-           }
-        }
+        break;
 
-        // Now we can set the unreachable parts from the Polygon
-        DTW_Polygon_setUnreachableParts (me, thee, psi.peek());
+        // P = 2
 
-        // Forward pass.
-        integer numberOfIsolatedPoints = 0;
-        autoMelderProgress progress (U"Find path");
-        for (integer j = 2; j <= my nx; j ++) {
-            for (integer i = 2; i <= my ny; i ++) {
-                if (! DTW_ISREACHABLE (i, j)) continue;
-                double g, gmin = DTW_BIG;
-                integer direction = 0;
-                if (DTW_ISREACHABLE (i - 1, j - 1)) {
-                    gmin = delta [i - 1] [j - 1] + 2.0 * my z [i] [j];
-                    direction = DTW_XANDY;
-                } else if (DTW_ISREACHABLE (i, j - 1)) {
-                    gmin = delta [i] [j - 1] + my z [i] [j];
+        case 4: {
+            if (DTW_ISREACHABLE (i - 2, j - 3) && DTW_PSI (i, j - 1) == DTW_XANDY && DTW_PSI (i - 1, j - 2) == DTW_XANDY &&
+                (g = DTW_DELTA (i-2, j-3) + 2.0 * DTW_DISTANCE (i-1, j-2) + 2.0 * DTW_DISTANCE (i, j-1) + dij) < gmin) {
+                    gmin = g;
                     direction = DTW_X;
-                } else if (DTW_ISREACHABLE (i - 1, j)) {
-                    gmin = delta [i - 1] [j] + my z [i] [j];
+            }
+            if (DTW_ISREACHABLE (i - 3, j - 2) && DTW_PSI (i - 1, j) == DTW_XANDY && DTW_PSI (i - 2, j - 1) == DTW_XANDY &&
+                (g = DTW_DELTA (i-3, j-2) + 2.0 * DTW_DISTANCE (i-2, j-1) + 2.0 * DTW_DISTANCE (i-1, j) + dij) < gmin) {
+                    gmin = g;
                     direction = DTW_Y;
-                } else {
-                    numberOfIsolatedPoints ++;
-                    continue;
-                }
+            }
+        }
+        break;
+        default:
+        break;
+        }
+        Melder_assert (direction != 0);
+        DTW_SearchCells_setPsi (cells, i, j, direction);
+        DTW_DELTA (i, j) = gmin;
+    }
+}
 
-                switch (localSlope) {
-                case 1:  { // no restriction
-                    if (DTW_ISREACHABLE (i, j - 1) && ((g = delta [i] [j - 1] + my z [i] [j]) < gmin)) {
-                        gmin = g;
-                        direction = DTW_X;
-                    }
-                    if (DTW_ISREACHABLE (i - 1, j) && ((g = delta [i - 1] [j] + my z [i] [j]) < gmin)) {
-                        gmin = g;
-                        direction = DTW_Y;
-                    }
-                }
-                break;
+static double DTW_SearchCells_getMinimumAtEnd (DTW_SearchCells *cells, integer *p_iy) {
+    integer iy = cells -> ny, nx = cells -> nx;
+    double minimum = DTW_DELTA (iy, nx);
+    for (integer i = cells -> ny - 1; i > 0; i --) {
+        if (! DTW_ISREACHABLE (i, nx)) {
+            break;   // we're in unreachable places
+        } else if (DTW_DELTA (i, nx) < minimum) {
+            minimum = DTW_DELTA (iy = i, nx);
+        }
+    }
+    if (p_iy) {
+        *p_iy = iy;
+    }
+    return minimum;
+}
 
-                // P = 1/2
-
-                case 2: { // P = 1/2
-                    if (DTW_ISREACHABLE (i - 1, j - 3) && psi [i] [j - 1] == DTW_X && psi [i] [j - 2] == DTW_XANDY &&
-                        (g = delta [i-1] [j-3] + 2.0 * my z [i] [j-2] + my z [i] [j-1] + my z [i] [j]) < gmin) {
-                        gmin = g;
-                        direction = DTW_X;
-                    }
-                    if (DTW_ISREACHABLE (i - 1, j - 2) && psi [i] [j - 1] == DTW_XANDY &&
-                        (g = delta [i - 1] [j - 2] + 2.0 * my z [i] [j - 1] + my z [i] [j]) < gmin) {
-                        gmin = g;
-                        direction = DTW_X;
-                    }
-                    if (DTW_ISREACHABLE (i - 2, j - 1) && psi [i - 1] [j] == DTW_XANDY &&
-                        (g = delta [i - 2] [j - 1] + 2.0 * my z [i - 1] [j] + my z [i] [j]) < gmin) {
-                        gmin = g;
-                        direction = DTW_Y;
-                    }
-                    if (DTW_ISREACHABLE (i - 3, j - 1) && psi [i - 1] [j] == DTW_Y && psi [i - 2] [j] == DTW_XANDY &&
-                        (g = delta [i-3] [j-1] + 2.0 * my z [i-2] [j] + my z [i-1] [j] + my z [i] [j]) < gmin) {
-                        gmin = g;
-                        direction = DTW_Y;
-                    }
-                }
-                break;
+void DTW_Polygon_findPathInside (DTW me, Polygon thee, int localSlope, autoMatrix *cumulativeDists) {
+    try {
+        double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 };
+        // if localSlope == 1 start of path is within 10% of minimum duration. Starts farther away
+        integer delta_xy = (my nx < my ny ? my nx : my ny) / 10; // if localSlope == 1 start within 10% of
 
-                // P = 1
-
-                case 3: {
-                    if (DTW_ISREACHABLE (i - 1, j - 2) && psi [i] [j - 1] == DTW_XANDY &&
-                        (g = delta [i - 1] [j - 2] + 2.0 * my z [i] [j - 1] + my z [i] [j]) < gmin) {
-                        gmin = g;
-                        direction = DTW_X;
-                    }
-                    if (DTW_ISREACHABLE (i - 2, j - 1) && psi [i - 1] [j] == DTW_XANDY &&
-                        (g = delta [i - 2] [j - 1] + 2.0 * my z [i - 1] [j] + my z [i] [j]) < gmin) {
-                        gmin = g;
-                        direction = DTW_Y;
-                    }
-                }
-                break;
+        if (localSlope < 1 || localSlope > 4) {
+            Melder_throw (U"Local slope parameter is illegal.");
+        }
 
-                // P = 2
-
-                case 4: {
-                    if (DTW_ISREACHABLE (i - 2, j - 3) && psi [i] [j - 1] == DTW_XANDY && psi [i - 1] [j - 2] == DTW_XANDY &&
-                        (g = delta [i-2] [j-3] + 2.0 * my z [i-1] [j-2] + 2.0 * my z [i] [j-1] + my z [i] [j]) < gmin) {
-                            gmin = g;
-                            direction = DTW_X;
-                    }
-                    if (DTW_ISREACHABLE (i - 3, j - 2) && psi [i - 1] [j] == DTW_XANDY && psi [i - 2] [j - 1] == DTW_XANDY &&
-                        (g = delta [i-3] [j-2] + 2.0 * my z [i-2] [j-1] + 2.0 * my z [i-1] [j] + my z [i] [j]) < gmin) {
-                            gmin = g;
-                            direction = DTW_Y;
-                    }
-                }
-                break;
-                default:
-                break;
-                }
-                Melder_assert (direction != 0);
-                psi [i] [j] = direction;
-                delta [i] [j] = gmin;
-            }
+        integer rowto = delta_xy, colto = delta_xy;
+        if (localSlope != 1) {
+			rowto = colto = Melder_ifloor (slopes [localSlope]) + 1;
+		}
+        DTW_Polygon_checkOverlap (me, thee);
+
+        DTW_SearchCells searchCells;
+        DTW_SearchCells *cells = & searchCells;
+        DTW_SearchCells_init (cells, me);
+
+        // Column by column: initialize, set the unreachable parts from the Polygon, forward pass.
+        integer numberOfIsolatedPoints = 0;
+        autoMelderProgress progress (U"Find path");
+        for (integer j = 1; j <= my nx; j ++) {
+            DTW_SearchCells_initColumn (cells, j, localSlope, rowto, colto);
+            DTW_Polygon_setUnreachableParts (me, thee, cells, j);
+            if (j == 1) continue;
+            DTW_SearchCells_forward (cells, j, localSlope, & numberOfIsolatedPoints);
             if ((j % 10) == 2) {
                 Melder_progress (0.999 * j / my nx, U"Calculate time warp: frame ", j, U" from ", my nx, U".");
             }
@@ -1498,15 +1870,8 @@ void DTW_Polygon_findPathInside (DTW me, Polygon thee, int localSlope, autoMatri
 
         // Find minimum at end of path and trace back.
 
-        integer iy = my ny;
-        double minimum = delta [iy] [my nx];
-        for (integer i = my ny - 1; i > 0; i --) {
-            if (! DTW_ISREACHABLE (i, my nx)) {
-                break;   // we're in unreachable places
-            } else if (delta [i] [my nx] < minimum) {
-                minimum = delta [iy = i] [my nx];
-            }
-        }
+        integer iy;
+        double minimum = DTW_SearchCells_getMinimumAtEnd (cells, & iy);
         
         integer pathIndex = my nx + my ny - 1;   // maximum path length
         my weightedDistance = minimum / (my nx + my ny);
@@ -1516,14 +1881,14 @@ void DTW_Polygon_findPathInside (DTW me, Polygon thee, int localSlope, autoMatri
         // Fill path backwards.
 
         while (ix > 1) {
-            if (psi [iy] [ix] == DTW_XANDY) {
+            if (DTW_PSI (iy, ix) == DTW_XANDY) {
                 ix --;
                 iy --;
-            } else if (psi [iy] [ix] == DTW_X) {
+            } else if (DTW_PSI (iy, ix) == DTW_X) {
                 ix --;
-            } else if (psi [iy] [ix] == DTW_Y) {
+            } else if (DTW_PSI (iy, ix) == DTW_Y) {
                 iy --;
-            } else if (psi [iy] [ix] == DTW_START) {
+            } else if (DTW_PSI (iy, ix) == DTW_START) {
                 break;
             }
             if (pathIndex < 2 || iy < 1) break;
@@ -1545,7 +1910,7 @@ void DTW_Polygon_findPathInside (DTW me, Polygon thee, int localSlope, autoMatri
                 my ymin, my ymax, my ny, my dy, my y1);
             for (integer i = 1; i <= my ny; i ++) {
                 for (integer j = 1; j <= my nx; j ++) {
-                    his z [i] [j] = delta [i] [j];
+                    his z [i] [j] = ( DTW_SearchCells_contains (cells, i, j) ? DTW_DELTA (i, j) : undefined );
                 }
             }
             *cumulativeDists = him.move();
@@ -1555,4 +1920,72 @@ void DTW_Polygon_findPathInside (DTW me, Polygon thee, int localSlope, autoMatri
     }
 }
 
+double DTW_findWeightedDistance (double tminp, double tmaxp, integer ntp, double dtp, double t1p,
+	double tminc, double tmaxc, integer ntc, double dtc, double t1c, double sakoeChibaBand, int localSlope,
+	void (*getDistances) (void *closure, integer ix, integer iyFirst, integer iyLast, double *distances),
+	double (*getLowerBound) (void *closure, integer ix, integer iyFirst, integer iyLast),
+	void *closure, double maximumWeightedDistance)
+{
+	double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 };
+	Melder_assert (localSlope >= 1 && localSlope <= 4);
+	autoDTW me = DTW_createWithoutDistances (tminp, tmaxp, ntp, dtp, t1p, tminc, tmaxc, ntc, dtc, t1c);
+	/*
+		As in DTW_to_Polygon, but without a message if the constraints have to be relaxed,
+		because we may be in a worker thread.
+	*/
+	double band = sakoeChibaBand;
+	int slope = localSlope;
+	if (! DTW_canMeetSlopeConstraints (me.get(), band, slope)) {
+		band = 0.0;
+		slope = 1;
+	}
+	autoPolygon thee = DTW_to_Polygon_raw (me.get(), band, slope);
+
+	DTW_SearchCells searchCells;
+	DTW_SearchCells *cells = & searchCells;
+	DTW_SearchCells_initRolling (cells, me.get(), thee.get(), getDistances, closure);
+
+	integer delta_xy = (ntc < ntp ? ntc : ntp) / 10;
+	integer rowto = delta_xy, colto = delta_xy;
+	if (localSlope != 1) {
+		rowto = colto = Melder_ifloor (slopes [localSlope]) + 1;
+	}
+	/*
+		Every path visits each column after the begin part of the first row at least once,
+		so the sum of the lower bounds of the distances in these columns is a lower bound of the cost.
+		The cumulative distances in these columns never decrease along the path.
+	*/
+	double maximumCost = maximumWeightedDistance * (ntc + ntp);
+	bool mayAbandon = maximumWeightedDistance > 0.0;
+	if (mayAbandon && getLowerBound) {
+		double lowerBound = 0.0;
+		for (integer ix = colto + 1; ix <= ntc; ix ++) {
+			lowerBound += getLowerBound (closure, ix, cells -> first [ix], cells -> last [ix]);
+			if (lowerBound > maximumCost) {
+				return undefined;
+			}
+		}
+	}
+	integer numberOfIsolatedPoints = 0;
+	for (integer j = 1; j <= ntc; j ++) {
+		DTW_SearchCells_initColumn (cells, j, localSlope, rowto, colto);
+		DTW_Polygon_setUnreachableParts (me.get(), thee.get(), cells, j);
+		if (j == 1) continue;
+		DTW_SearchCells_forward (cells, j, localSlope, & numberOfIsolatedPoints);
+		if (mayAbandon && j > colto) {
+			double minimum = DTW_BIG;
+			for (integer i = cells -> first [j]; i <= cells -> last [j]; i ++) {
+				if (DTW_ISREACHABLE (i, j) && DTW_DELTA (i, j) < minimum) {
+					minimum = DTW_DELTA (i, j);
+				}
+			}
+			if (minimum > maximumCost) {
+				return undefined;
+			}
+		}
+	}
+	double weightedDistance = DTW_SearchCells_getMinimumAtEnd (cells, nullptr) / (ntc + ntp);
+	return ( mayAbandon && weightedDistance > maximumWeightedDistance ? undefined : weightedDistance );
+}
+
 /* End of file DTW.cpp */
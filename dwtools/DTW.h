@@ -47,6 +47,54 @@ void DTW_Path_Query_init (DTW_Path_Query me, integer ny, integer nx);
 autoDTW DTW_create (double tminp, double tmaxp, integer ntp, double dtp, double t1p,
 	double tminc, double tmaxc, integer ntc, double dtc, double t1c);
 
+autoDTW DTW_createBanded (double tminp, double tmaxp, integer ntp, double dtp, double t1p,
+	double tminc, double tmaxc, integer ntc, double dtc, double t1c, double sakoeChibaBand, int slope);
+/*
+	A banded DTW only stores the distances inside the polygon of DTW_to_Polygon (me, sakoeChibaBand, slope):
+	for column ix these are the rows bandFirst [ix] .. bandLast [ix].
+	Its z is null; distances are accessed with DTW_getDistance / DTW_setDistance and the
+	path search only visits cells inside the band.
+	If sakoeChibaBand <= 0, if the slope constraint cannot be met or if the band does not exclude
+	any cell, a DTW with a full distance matrix is returned.
+*/
+
+void DTW_expandBand (DTW me);
+/*
+	Give a banded DTW a full distance matrix, with undefined distances outside the band.
+	The file format has no place for the band, so a banded DTW is not writable
+	until it has been expanded in this way.
+*/
+
+inline static bool DTW_isBanded (DTW me) {
+	return !! my bandDistances;
+}
+
+inline static bool DTW_isInBand (DTW me, integer iy, integer ix) {
+	return ! my bandDistances || (iy >= my bandFirst [ix] && iy <= my bandLast [ix]);
+}
+
+inline static double DTW_getDistance (DTW me, integer iy, integer ix) {
+	if (! my bandDistances) {
+		return my z [iy] [ix];
+	}
+	return ( iy >= my bandFirst [ix] && iy <= my bandLast [ix] ? my bandDistances [my bandOffset [ix] + iy] : undefined );
+}
+
+inline static void DTW_setDistance (DTW me, integer iy, integer ix, double distance) {
+	if (! my bandDistances) {
+		my z [iy] [ix] = distance;
+	} else {
+		Melder_assert (iy >= my bandFirst [ix] && iy <= my bandLast [ix]);
+		my bandDistances [my bandOffset [ix] + iy] = distance;
+	}
+}
+
+void DTW_getBandColumns (DTW me, integer iy, integer *ixFirst, integer *ixLast);
+/* The columns that have a distance stored in row iy; 1 .. nx for a full DTW. */
+
+void DTW_getWindowExtrema (DTW me, integer ixmin, integer ixmax, integer iymin, integer iymax, double *minimum, double *maximum);
+/* Extrema of the stored distances; a zero index means the first or last column or row. */
+
 void DTW_setWeights (DTW me, double wx, double wy, double wd);
 
 autoDTW DTW_swapAxes (DTW me);
@@ -72,12 +120,35 @@ void DTW_findPath (DTW me, bool matchStart, bool matchEnd, int slope); // deprec
 		for Spoken Word	recognition, IEEE Trans. on ASSP, vol 26, 43-49.
 */
 
+double DTW_findWeightedDistance (double tminp, double tmaxp, integer ntp, double dtp, double t1p,
+	double tminc, double tmaxc, integer ntc, double dtc, double t1c, double sakoeChibaBand, int localSlope,
+	void (*getDistances) (void *closure, integer ix, integer iyFirst, integer iyLast, double *distances),
+	double (*getLowerBound) (void *closure, integer ix, integer iyFirst, integer iyLast),
+	void *closure, double maximumWeightedDistance);
+/*
+	The weighted distance of the path that DTW_findPath_bandAndSlope would find, without a DTW object:
+	the distances are computed column by column, getDistances (closure, ix, iyFirst, iyLast, d)
+	has to fill d [iyFirst..iyLast], and only the cumulative distances of the last columns are kept.
+	If maximumWeightedDistance > 0, the search is abandoned as soon as the weighted distance is
+	certain to exceed it, and undefined is returned. getLowerBound (may be null) then has to give a
+	lower bound of the distances in rows iyFirst..iyLast of column ix, which is tried first.
+	Does not throw except when out of memory, and does not report to the user, so it can run in a worker thread.
+*/
+
 void DTW_Path_recode (DTW me);
 
 double DTW_getYTimeFromXTime (DTW me, double tx);
 
 double DTW_getXTimeFromYTime (DTW me, double ty);
 
+/*
+	The same for tx [1..numberOfTimes] and ty [1..numberOfTimes];
+	times in ascending order are mapped in a single walk along the path.
+*/
+void DTW_getYTimesFromXTimes (DTW me, const double tx [], integer numberOfTimes, double ty []);
+
+void DTW_getXTimesFromYTimes (DTW me, const double ty [], integer numberOfTimes, double tx []);
+
 double DTW_getPathY (DTW me, double tx);
 
 integer DTW_getMaximumConsecutiveSteps (DTW me, int direction);
@@ -113,9 +184,9 @@ autoMatrix DTW_to_Matrix_cumulativeDistances (DTW me, double sakoeChibaBand, int
 
 autoMatrix DTW_Polygon_to_Matrix_cumulativeDistances (DTW me, Polygon thee, int localSlope);
 
-autoDTW Matrices_to_DTW (Matrix me, Matrix thee, bool matchStart, bool matchEnd, int slope, double metric);
+autoDTW Matrices_to_DTW (Matrix me, Matrix thee, bool matchStart, bool matchEnd, int slope, double metric, double sakoeChibaBand);
 
-autoDTW Spectrograms_to_DTW (Spectrogram me, Spectrogram thee, bool matchStart, bool matchEnd, int slope, double metric);
+autoDTW Spectrograms_to_DTW (Spectrogram me, Spectrogram thee, bool matchStart, bool matchEnd, int slope, double metric, double sakoeChibaBand);
 
 autoDTW Pitches_to_DTW (Pitch me, Pitch thee, double vuv_costs, double time_weight, bool matchStart, bool matchEnd, int slope);
 
@@ -30,6 +30,51 @@ autoIntervalTier DTW_IntervalTier_to_IntervalTier_old (DTW me, IntervalTier thee
 autoTextTier DTW_TextTier_to_TextTier_old (DTW me, TextTier thee);
 // end old
 
+/*
+	Map all the times of a tier in one go: they are in ascending order, so this is a single walk along the path.
+*/
+static void DTW_TextTier_mapTimes (DTW me, TextTier thee, bool fromY) {
+	integer numberOfPoints = thy points.size;
+	if (numberOfPoints == 0) {
+		return;
+	}
+	autoNUMvector <double> times (1, numberOfPoints);
+	for (integer i = 1; i <= numberOfPoints; i ++) {
+		times [i] = thy points.at [i] -> number;
+	}
+	if (fromY) {
+		DTW_getXTimesFromYTimes (me, times.peek(), numberOfPoints, times.peek());
+	} else {
+		DTW_getYTimesFromXTimes (me, times.peek(), numberOfPoints, times.peek());
+	}
+	for (integer i = 1; i <= numberOfPoints; i ++) {
+		thy points.at [i] -> number = times [i];
+	}
+}
+
+static void DTW_IntervalTier_mapTimes (DTW me, IntervalTier thee, bool fromY) {
+	integer numberOfIntervals = thy intervals.size;
+	if (numberOfIntervals == 0) {
+		return;
+	}
+	autoNUMvector <double> times (1, 2 * numberOfIntervals);   // xmin and xmax of each interval
+	for (integer i = 1; i <= numberOfIntervals; i ++) {
+		TextInterval textinterval = thy intervals.at [i];
+		times [2 * i - 1] = textinterval -> xmin;
+		times [2 * i] = textinterval -> xmax;
+	}
+	if (fromY) {
+		DTW_getXTimesFromYTimes (me, times.peek(), 2 * numberOfIntervals, times.peek());
+	} else {
+		DTW_getYTimesFromXTimes (me, times.peek(), 2 * numberOfIntervals, times.peek());
+	}
+	for (integer i = 1; i <= numberOfIntervals; i ++) {
+		TextInterval textinterval = thy intervals.at [i];
+		textinterval -> xmin = times [2 * i - 1];
+		textinterval -> xmax = times [2 * i];
+	}
+}
+
 /* Get times from TextGrid and substitute new time form the y-times of the DTW. */
 autoTextTier DTW_TextTier_to_TextTier (DTW me, TextTier thee, double precision) {
 	try {
@@ -37,21 +82,13 @@ autoTextTier DTW_TextTier_to_TextTier (DTW me, TextTier thee, double precision)
 			autoTextTier him = Data_copy (thee);
 			his xmin = my xmin;
 			his xmax = my xmax;
-			for (integer i = 1; i <= his points.size; i ++) {
-				TextPoint textpoint = his points.at [i];
-				double time = DTW_getXTimeFromYTime (me, textpoint -> number);
-				textpoint -> number = time;
-			}
+			DTW_TextTier_mapTimes (me, him.get(), true);
 			return him;
 		} else if (fabs (my xmin - thy xmin) <= precision && fabs (my xmax - thy xmax) <= precision) { // map from X to Y
 			autoTextTier him = Data_copy (thee);
 			his xmin = my ymin;
 			his xmax = my ymax;
-			for (integer i = 1; i <= his points.size; i ++) {
-				TextPoint textpoint = his points.at [i];
-				double time = DTW_getYTimeFromXTime (me, textpoint -> number);
-				textpoint -> number = time;
-			}
+			DTW_TextTier_mapTimes (me, him.get(), false);
 			return him;
 		} else {
 			Melder_throw (U"The domain of the TextTier and one of the domains of the DTW should be equal.");
@@ -67,25 +104,13 @@ autoIntervalTier DTW_IntervalTier_to_IntervalTier (DTW me, IntervalTier thee, do
 			autoIntervalTier him = Data_copy (thee);
 			his xmin = my xmin;
 			his xmax = my xmax;
-			for (integer i = 1; i <= his intervals.size; i ++) {
-				TextInterval textinterval = his intervals.at [i];
-				double xmin = DTW_getXTimeFromYTime (me, textinterval -> xmin);
-				textinterval -> xmin = xmin;
-				double xmax = DTW_getXTimeFromYTime (me, textinterval -> xmax);
-				textinterval -> xmax = xmax;
-			}
+			DTW_IntervalTier_mapTimes (me, him.get(), true);
 			return him;
 		} else if (fabs (my xmin - thy xmin) <= precision && fabs (my xmax - thy xmax) <= precision) { // map from X to Y
 			autoIntervalTier him = Data_copy (thee);
 			his xmin = my ymin;
 			his xmax = my ymax;
-			for (integer i = 1; i <= his intervals.size; i ++) {
-				TextInterval textinterval = his intervals.at [i];
-				double xmin = DTW_getYTimeFromXTime (me, textinterval -> xmin);
-				textinterval -> xmin = xmin;
-				double xmax = DTW_getYTimeFromXTime (me, textinterval -> xmax);
-				textinterval -> xmax = xmax;
-			}
+			DTW_IntervalTier_mapTimes (me, him.get(), false);
 			return him;
 		} else {
 			Melder_throw (U"The domain of the IntervalTier and one of the domains of the DTW should be equal.");
@@ -143,7 +168,7 @@ autoTable DTW_IntervalTier_to_Table (DTW me, IntervalTier thee, double precision
 				integer numberOfFrames = Matrix_getWindowSamplesX (me, xmin, xmax, & ixmin, & ixmax);
 				double sumOfDistances = 0;
 				while (pathIndex < my pathLength && my path [pathIndex].x < ixmax) {
-					sumOfDistances += my z [my path [pathIndex].y] [my path [pathIndex].x];
+					sumOfDistances += DTW_getDistance (me, my path [pathIndex].y, my path [pathIndex].x);
 					pathIndex ++;
 				}
 				Table_setNumericValue (him.get(), i, 1, textinterval -> xmin);
@@ -161,7 +186,7 @@ autoTable DTW_IntervalTier_to_Table (DTW me, IntervalTier thee, double precision
 				integer numberOfFrames = Matrix_getWindowSamplesY (me, ymin, ymax, & iymin, & iymax);
 				double sumOfDistances = 0;
 				while (pathIndex < my pathLength && my path [pathIndex].y < iymax) {
-					sumOfDistances += my z [my path [pathIndex].y] [my path [pathIndex].x];
+					sumOfDistances += DTW_getDistance (me, my path [pathIndex].y, my path [pathIndex].x);
 					pathIndex ++;
 				}
 				Table_setNumericValue (him.get(), i, 1, textinterval -> xmin);
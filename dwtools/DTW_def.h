@@ -49,6 +49,11 @@ oo_DEFINE_CLASS (DTW, Matrix)
 		oo_DOUBLE (wy)
 		oo_DOUBLE (wd)
 		oo_STRUCT (DTW_Path_Query, pathQuery)
+		oo_INTEGER (numberOfBandCells)
+		oo_INTEGER_VECTOR (bandFirst, nx)
+		oo_INTEGER_VECTOR (bandLast, nx)
+		oo_INTEGER_VECTOR (bandOffset, nx)
+		oo_DOUBLE_VECTOR (bandDistances, numberOfBandCells)
 	#endif
 	#if oo_READING
 		DTW_Path_Query_init (& pathQuery, ny, nx);
@@ -57,6 +62,14 @@ oo_DEFINE_CLASS (DTW, Matrix)
 	#if oo_DECLARING
 		void v_info ()
 			override;
+		bool v_writable ()
+			override;
+		double v_getMatrix (integer irow, integer icol)
+			override;
+		double v_getFunction2 (double x, double y)
+			override;
+		double v_getValueAtSample (integer sampleNumber, integer level, int unit)
+			override;
 	#endif
 oo_END_CLASS (DTW)
 #undef ooSTRUCT
@@ -24,24 +24,31 @@
 #include "ICA.h"
 #include "Interpreter.h"
 #include "NUM2.h"
+#include "NUMcblas.h"
+#include "MelderThread.h"
 #include "Sound_and_PCA.h"
 #include "SVD.h"
 
+/*
+	R = op(A) op(B) + beta R, with op(A) m x k, op(B) k x n and R m x n, all as contiguous row-major NUMmatrix storage.
+	Row-major storage of a matrix is column-major storage of its transpose, so this is
+	R' := op(B)' op(A)' for NUMblas_dgemm.
+*/
+static void NUMdmatrices_multiply (bool transposeA, bool transposeB, integer m, integer n, integer k, double **a, double **b, double beta, double **r) {
+	double alpha = 1.0;
+	integer lda = transposeA ? m : k, ldb = transposeB ? k : n, ldr = n;
+	NUMblas_dgemm (transposeB ? "T" : "N", transposeA ? "T" : "N", & n, & m, & k, & alpha, & b [1] [1], & ldb, & a [1] [1], & lda, & beta, & r [1] [1], & ldr);
+}
+
 // matrix multiply R = V*C*V', V is nrv x ncv, C is ncv x ncv, R is nrv x nrv
 static void NUMdmatrices_multiply_VCVp (double **r, double **v, integer nrv, integer ncv, double **c, bool csym) {
-	for (integer i = 1; i <= nrv; i ++) {
-		integer jstart = csym ? i : 1;
-		for (integer j = jstart; j <= nrv; j ++) {
-			// V_ik C_kl V'_lj = V_ik C_kl V_jl
-			double vcv = 0.0;
-			for (integer k = 1; k <= ncv; k ++) {
-				for (integer l = 1; l <= ncv; l ++) {
-					vcv += v [i] [k] * c [k] [l] * v [j] [l];
-				}
-			}
-			r [i] [j] = vcv;
-			if (csym) {
-				r [j] [i] = vcv;
+	autoNUMmatrix<double> vc (1, nrv, 1, ncv);
+	NUMdmatrices_multiply (false, false, nrv, ncv, ncv, v, c, 0.0, vc.peek());   // V*C
+	NUMdmatrices_multiply (false, true, nrv, nrv, ncv, vc.peek(), v, 0.0, r);   // (V*C)*V'
+	if (csym) {
+		for (integer i = 1; i <= nrv; i ++) {
+			for (integer j = i + 1; j <= nrv; j ++) {
+				r [j] [i] = r [i] [j];
 			}
 		}
 	}
@@ -71,44 +78,12 @@ static void NUMdmatrices_multiply_VpCV (double **r, double **v, integer nrv, int
 
 // matrix multiply V*C, V is nrv x ncv, C is ncv x ncc, R is nrv x ncc;
 static void NUMdmatrices_multiply_VC (double **r, double **v, integer nrv, integer ncv, double **c, integer ncc) {
-	for (integer i = 1; i <= nrv; i ++) {
-		for (integer j = 1; j <= ncc; j ++) {
-			// V_ik C_kj
-			longdouble vc = 0.0;
-			for (integer k = 1; k <= ncv; k ++) {
-				vc += v [i] [k] * c [k] [j];
-			}
-			r [i] [j] = (double) vc;
-		}
-	}
+	NUMdmatrices_multiply (false, false, nrv, ncc, ncv, v, c, 0.0, r);
 }
 
 // matrix multiply V'*C, V is nrv x ncv, C is nrv x ncc, R is ncv x ncc;
 static void NUMdmatrices_multiply_VpC (double **r, double **v, integer nrv, integer ncv, double **c, integer ncc) {
-	for (integer i = 1; i <= ncv; i ++) {
-		for (integer j = 1; j <= ncc; j ++) {
-			// V'_ik C_kj
-			longdouble vc = 0.0;
-			for (integer k = 1; k <= nrv; k ++) {
-				vc += v [k] [i] * c [k] [j];
-			}
-			r [i] [j] = (double) vc;
-		}
-	}
-}
-
-// D += scalef * M * M', M = nrm x ncm, D is nrm x nrm
-static void NUMdmatrices_multiplyScaleAdd (double **r, double **m, integer nrm, integer ncm, double scalef) {
-	for (integer i = 1; i <= nrm; i ++) {
-		for (integer j = 1; j <= nrm; j ++) {
-			// M_ik M'_kj = M_ik M_jk
-			longdouble mm = 0.0;
-			for (integer k = 1; k <= ncm; k ++) {
-				mm += m [i] [k] * m [j] [k];
-			}
-			r [i] [j] += scalef * mm;
-		}
-	}
+	NUMdmatrices_multiply (true, false, ncv, ncc, nrv, v, c, 0.0, r);
 }
 
 /*
@@ -177,6 +152,163 @@ static double NUMdmatrix_diagonalityIndex (double **v, integer dimension) {
 }
 #endif
 
+/*
+	The joint diagonalizers spend almost all their time in loops over the tables. These loops are divided over
+	threads, each thread handling a contiguous range of tables. Sums over tables are accumulated per thread in
+	'sum1' and 'sum2' and added afterwards in the order of the threads.
+*/
+Thing_define (CrossCorrelationTableList_Args, Thing) { public:
+	CrossCorrelationTableList from, to;
+	integer firstTable, lastTable, dimension;
+	double **w;   // dimension x numberOfColumnsW, contiguous
+	integer numberOfColumnsW;
+	double *cweights, scalef;
+	autoNUMmatrix<double> sum1, sum2, work, products, scaledProducts;
+	bool isMainThread;
+	volatile int *cancelled;
+};
+
+Thing_implement (CrossCorrelationTableList_Args, Thing, 0);
+
+/*
+	ffdiag: for all i < j
+		sum1 [i] [j] = sum (k, C_k [i] [i] * C_k [j] [j]), sum1 [i] [i] = sum (k, C_k [i] [i]^2)
+		sum2 [i] [j] = sum (k, C_k [j] [j] * C_k [i] [j]), sum2 [j] [i] = sum (k, C_k [i] [i] * C_k [i] [j])
+*/
+static MelderThread_RETURN_TYPE CrossCorrelationTableList_ffdiagSums (CrossCorrelationTableList_Args me) {
+	integer dimension = my dimension;
+	for (integer k = my firstTable; k <= my lastTable; k ++) {
+		if (*my cancelled) MelderThread_RETURN;
+		double **c = my from -> at [k] -> data;
+		for (integer i = 1; i <= dimension; i ++) {
+			double cii = c [i] [i];
+			my sum1 [i] [i] += cii * cii;
+			for (integer j = i + 1; j <= dimension; j ++) {
+				double cjj = c [j] [j], cij = c [i] [j];
+				my sum1 [i] [j] += cii * cjj;
+				my sum2 [i] [j] += cjj * cij;
+				my sum2 [j] [i] += cii * cij;
+			}
+		}
+	}
+	MelderThread_RETURN;
+}
+
+// to [k] = W * from [k] * W'
+static MelderThread_RETURN_TYPE CrossCorrelationTableList_transform (CrossCorrelationTableList_Args me) {
+	try {
+		for (integer k = my firstTable; k <= my lastTable; k ++) {
+			if (*my cancelled) MelderThread_RETURN;
+			CrossCorrelationTable from = my from -> at [k], to = my to -> at [k];
+			if (from == to) {
+				NUMmatrix_copyElements (from -> data, my work.peek(), 1, my dimension, 1, my dimension);
+				NUMdmatrices_multiply_VCVp (to -> data, my w, my dimension, my dimension, my work.peek(), true);
+			} else {
+				NUMdmatrices_multiply_VCVp (to -> data, my w, my dimension, my dimension, from -> data, true);
+			}
+		}
+	} catch (MelderError) {
+		*my cancelled = 1;
+		if (my isMainThread) throw;
+	}
+	MelderThread_RETURN;
+}
+
+/*
+	qdiag: sum1 = sum (k, 2 * scalef * cweights [k] * (C_k W) (C_k W)').
+	The products C_k W of all the tables of the thread are collected as the columns of one matrix,
+	so that the sum becomes a single matrix product.
+*/
+static MelderThread_RETURN_TYPE CrossCorrelationTableList_accumulateProducts (CrossCorrelationTableList_Args me) {
+	integer dimension = my dimension, ncol = my numberOfColumnsW;
+	integer numberOfProducts = (my lastTable - my firstTable + 1) * ncol;
+	for (integer k = my firstTable; k <= my lastTable; k ++) {
+		if (*my cancelled) MelderThread_RETURN;
+		NUMdmatrices_multiply (false, false, dimension, ncol, dimension, my from -> at [k] -> data, my w, 0.0, my work.peek());
+		double factor = 2.0 * my scalef * my cweights [k];
+		integer offset = (k - my firstTable) * ncol;
+		for (integer i = 1; i <= dimension; i ++) {
+			for (integer j = 1; j <= ncol; j ++) {
+				my products [i] [offset + j] = my work [i] [j];
+				my scaledProducts [i] [offset + j] = factor * my work [i] [j];
+			}
+		}
+	}
+	NUMdmatrices_multiply (false, true, dimension, dimension, numberOfProducts, my scaledProducts.peek(), my products.peek(), 1.0, my sum1.peek());
+	MelderThread_RETURN;
+}
+
+/*
+	Runs the worker on the tables firstTable..from -> size and adds the per-thread sums to sum1 and sum2 (if not null).
+	Threads are only started if there is enough work per thread: an estimate of the number of
+	floating point operations per table is given by flopsPerTable.
+*/
+static void CrossCorrelationTableList_run (MelderThread_RETURN_TYPE (*worker) (CrossCorrelationTableList_Args),
+	CrossCorrelationTableList from, CrossCorrelationTableList to, integer firstTable, double **w, integer numberOfColumnsW,
+	double *cweights, double scalef, double flopsPerTable, double **sum1, double **sum2)
+{
+	integer numberOfTables = from -> size - firstTable + 1;
+	if (numberOfTables < 1) {
+		return;
+	}
+	integer dimension = from -> at [1] -> numberOfColumns;
+	int numberOfThreads = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads > numberOfTables) numberOfThreads = (int) numberOfTables;
+	if (numberOfThreads > numberOfTables * flopsPerTable / 1e6) numberOfThreads = (int) (numberOfTables * flopsPerTable / 1e6);
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	integer numberOfTablesPerThread = (numberOfTables - 1) / numberOfThreads + 1;
+	numberOfThreads = (int) ((numberOfTables - 1) / numberOfTablesPerThread + 1);
+	autoCrossCorrelationTableList_Args args [16];
+	volatile int cancelled = 0;
+	integer first = firstTable;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoCrossCorrelationTableList_Args arg = Thing_new (CrossCorrelationTableList_Args);
+		arg -> from = from;
+		arg -> to = to;
+		arg -> dimension = dimension;
+		arg -> firstTable = first;
+		arg -> lastTable = ithread == numberOfThreads ? from -> size : first + numberOfTablesPerThread - 1;
+		first = arg -> lastTable + 1;
+		arg -> w = w;
+		arg -> numberOfColumnsW = numberOfColumnsW;
+		arg -> cweights = cweights;
+		arg -> scalef = scalef;
+		if (numberOfColumnsW > 0) {
+			arg -> work.reset (1, dimension, 1, numberOfColumnsW);
+		}
+		if (sum1) {
+			arg -> sum1.reset (1, dimension, 1, dimension);
+		}
+		if (sum2) {
+			arg -> sum2.reset (1, dimension, 1, dimension);
+		}
+		if (worker == CrossCorrelationTableList_accumulateProducts) {
+			integer numberOfProducts = (arg -> lastTable - arg -> firstTable + 1) * numberOfColumnsW;
+			arg -> products.reset (1, dimension, 1, numberOfProducts);
+			arg -> scaledProducts.reset (1, dimension, 1, numberOfProducts);
+		}
+		arg -> isMainThread = ( ithread == numberOfThreads );
+		arg -> cancelled = & cancelled;
+		args [ithread - 1] = arg.move();
+	}
+	MelderThread_run (worker, args, numberOfThreads);
+	if (cancelled)
+		Melder_throw (U"Computation over CrossCorrelationTables interrupted.");
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		for (integer i = 1; i <= dimension; i ++) {
+			for (integer j = 1; j <= dimension; j ++) {
+				if (sum1) {
+					sum1 [i] [j] += args [ithread - 1] -> sum1 [i] [j];
+				}
+				if (sum2) {
+					sum2 [i] [j] += args [ithread - 1] -> sum2 [i] [j];
+				}
+			}
+		}
+	}
+}
+
 /*
 	This routine is modeled after qdiag.m from Andreas Ziehe, Pavel Laskov, Guido Nolte, Klaus-Robert Müller,
 	A Fast Algorithm for Joint Diagonalization with Non-orthogonal Transformations and its Application to
@@ -190,7 +322,8 @@ static void Diagonalizer_CrossCorrelationTableList_ffdiag (Diagonalizer me, Cros
 		autoCrossCorrelationTableList ccts = CrossCorrelationTableList_Diagonalizer_diagonalize (thee, me);
 		autoNUMmatrix<double> w (1, dimension, 1, dimension);
 		autoNUMmatrix<double> vnew (1, dimension, 1, dimension);
-		autoNUMmatrix<double> cc (1, dimension, 1, dimension);
+		autoNUMmatrix<double> z (1, dimension, 1, dimension);
+		autoNUMmatrix<double> y (1, dimension, 1, dimension);
 
 		for (integer i = 1; i <= dimension; i ++) {
 			w [i] [i] = 1.0;
@@ -202,17 +335,16 @@ static void Diagonalizer_CrossCorrelationTableList_ffdiag (Diagonalizer me, Cros
 			longdouble dm_old, theta = 1.0, dm_start = dm_new;
 			do {
 				dm_old = dm_new;
+				for (integer i = 1; i <= dimension; i ++) {
+					for (integer j = 1; j <= dimension; j ++) {
+						z [i] [j] = y [i] [j] = 0.0;
+					}
+				}
+				CrossCorrelationTableList_run (CrossCorrelationTableList_ffdiagSums, ccts.get(), ccts.get(), 1, nullptr, 0,
+					nullptr, 0.0, 2.5 * dimension * dimension, z.peek(), y.peek());
 				for (integer i = 1; i <= dimension; i ++) {
 					for (integer j = i + 1; j <= dimension; j ++) {
-						longdouble zii = 0.0, zij = 0.0, zjj = 0.0, yij = 0.0, yji = 0.0;   // zij == zji
-						for (integer k = 1; k <= ccts -> size; k ++) {
-							CrossCorrelationTable ct = ccts -> at [k];
-							zii += ct -> data [i] [i] * ct -> data [i] [i];
-							zij += ct -> data [i] [i] * ct -> data [j] [j];
-							zjj += ct -> data [j] [j] * ct -> data [j] [j];
-							yij += ct -> data [j] [j] * ct -> data [i] [j];
-							yji += ct -> data [i] [i] * ct -> data [i] [j];
-						}
+						longdouble zii = z [i] [i], zij = z [i] [j], zjj = z [j] [j], yij = y [i] [j], yji = y [j] [i];   // zij == zji
 						longdouble denom = zjj * zii - zij * zij;
 						if (denom != 0.0) {
 							w [i] [j] = (zij * yji - zii * yij) / denom;
@@ -252,11 +384,8 @@ static void Diagonalizer_CrossCorrelationTableList_ffdiag (Diagonalizer me, Cros
 				// update V
 				NUMmatrix_copyElements (v, vnew.peek(), 1, dimension, 1, dimension);
 				NUMdmatrices_multiply_VC (v, w.peek(), dimension, dimension, vnew.peek(), dimension);
-				for (integer k = 1; k <= ccts -> size; k ++) {
-					CrossCorrelationTable ct = ccts -> at [k];
-					NUMmatrix_copyElements (ct -> data, cc.peek(), 1, dimension, 1, dimension);
-					NUMdmatrices_multiply_VCVp (ct -> data, w.peek(), dimension, dimension, cc.peek(), true);
-				}
+				CrossCorrelationTableList_run (CrossCorrelationTableList_transform, ccts.get(), ccts.get(), 1, w.peek(), dimension,
+					nullptr, 0.0, 4.0 * dimension * dimension * dimension, nullptr, nullptr);
 				dm_new = CrossCorrelationTableList_getDiagonalityMeasure (ccts.get(), nullptr, 0, 0);
 				iter ++;
 				Melder_progress ((double) iter / (double) maxNumberOfIterations, U"Iteration: ", iter, U", measure: ", (double) dm_new, U"\n fractional measure: ", (double)(dm_new / dm_start));
@@ -277,6 +406,13 @@ static void Diagonalizer_CrossCorrelationTableList_ffdiag (Diagonalizer me, Cros
 static void update_one_column (CrossCorrelationTableList me, double **d, double *wp, double *wvec, double scalef, double *work) {
 	integer dimension = my at [1] -> numberOfColumns;
 
+	if ((my size - 1) * 4.0 * dimension * dimension > 1e6) {
+		// D = D +/- 2*p(t)*(m1*m1'), m1 = C * wvec, for all C except C0, in parallel
+		double *column [2] = { nullptr, wvec };   // wvec [1..dimension] as a dimension x 1 matrix
+		CrossCorrelationTableList_run (CrossCorrelationTableList_accumulateProducts, me, me, 2, column, 1,
+			wp, scalef, 4.0 * dimension * dimension, d, nullptr);
+		return;
+	}
 	for (integer ic = 2; ic <= my size; ic ++) { // exclude C0
 		SSCP cov = my at [ic];
 		double **c = cov -> data;
@@ -290,8 +426,9 @@ static void update_one_column (CrossCorrelationTableList me, double **d, double
 		}
 		// D = D +/- 2*p(t)*(m1*m1');
 		for (integer i = 1; i <= dimension; i ++) {
+			double factor = 2 * scalef * wp [ic] * work [i];
 			for (integer j = 1; j <= dimension; j ++) {
-				d [i] [j] += 2 * scalef * wp [ic] * work [i] * work [j];
+				d [i] [j] += factor * work [j];
 			}
 		}
 	}
@@ -308,7 +445,6 @@ static void Diagonalizer_CrossCorrelationTable_qdiag (Diagonalizer me, CrossCorr
 		autoNUMmatrix<double> pinv (1, dimension, 1, dimension);
 		autoNUMmatrix<double> d (1, dimension, 1, dimension);
 		autoNUMmatrix<double> p (1, dimension, 1, dimension);
-		autoNUMmatrix<double> m1 (1, dimension, 1, dimension);
 		autoNUMmatrix<double> wc (1, dimension, 1, dimension);
 		autoNUMvector<double> wvec (1, dimension);
 		autoNUMvector<double> wnew (1, dimension);
@@ -339,11 +475,8 @@ static void Diagonalizer_CrossCorrelationTable_qdiag (Diagonalizer me, CrossCorr
 
 		// P*C [i]*P'
 
-		for (integer ic = 1; ic <= thy size; ic ++) {
-			CrossCorrelationTable cov1 = thy at [ic];
-			CrossCorrelationTable cov2 = ccts -> at [ic];
-			NUMdmatrices_multiply_VCVp (cov2 -> data, p.peek(), dimension, dimension, cov1 -> data, true);
-		}
+		CrossCorrelationTableList_run (CrossCorrelationTableList_transform, thee, ccts.get(), 1, p.peek(), dimension,
+			nullptr, 0.0, 4.0 * dimension * dimension * dimension, nullptr, nullptr);
 
 		// W = P'\W == inv(P') * W
 
@@ -353,13 +486,10 @@ static void Diagonalizer_CrossCorrelationTable_qdiag (Diagonalizer me, CrossCorr
 
 		// initialisation for order KN^3
 
-		for (integer ic = 2; ic <= thy size; ic ++) {
-			CrossCorrelationTable cov = ccts -> at [ic];
-			// C * W
-			NUMdmatrices_multiply_VC (m1.peek(), cov -> data, dimension, dimension, w, dimension);
-			// D += scalef * M1*M1'
-			NUMdmatrices_multiplyScaleAdd (d.peek(), m1.peek(), dimension, dimension, 2 * cweights [ic]);
-		}
+		// D += 2 * cweights [ic] * (C * W)*(C * W)' for all C except C0
+
+		CrossCorrelationTableList_run (CrossCorrelationTableList_accumulateProducts, ccts.get(), ccts.get(), 2, w, dimension,
+			cweights, 1.0, 4.0 * dimension * dimension * dimension, d.peek(), nullptr);
 
 		integer iter = 0;
 		double delta_w;
@@ -434,11 +564,14 @@ void MixingMatrix_CrossCorrelationTableList_improveUnmixing (MixingMatrix me, Cr
 }
 
 
+#define NUMcrossCorrelate_BLOCKSIZE 1024
+
 /* Preconditions:
  * 	x [1..nrows] [1..ncols], cc [1..nrows] [1..nrows], centroid [1..nrows]
  * 	if (lag>0) {i2 + lag <= ncols} else {i1-lag >= 1}
  * 	no array boundary checks!
  * 	lag >= 0
+ * The rows of x need not be parts of one matrix.
  */
 static void NUMcrossCorrelate_rows (double **x, integer nrows, integer icol1, integer icol2, integer lag, double **cc, double *centroid, double scale) {
 	lag = labs (lag);
@@ -450,17 +583,68 @@ static void NUMcrossCorrelate_rows (double **x, integer nrows, integer icol1, in
 		}
 		centroid [i] = sum / nsamples;
 	}
+	/*
+		Blocks of at most NUMcrossCorrelate_BLOCKSIZE centred samples of all rows, without and with lag,
+		are copied to xblock and yblock and their products accumulated with dgemm.
+		A row-major nrows x blockSize block is a column-major blockSize x nrows matrix:
+		sum' := yblock xblock' (nrows x nrows), i.e. sum [i] [j] = sum (k, x [i] [k] * x [j] [k + lag]).
+	*/
+	integer blockSize = icol2 - icol1 + 1 < NUMcrossCorrelate_BLOCKSIZE ? icol2 - icol1 + 1 : NUMcrossCorrelate_BLOCKSIZE;
+	autoNUMvector<double> xblock ((integer) 0, nrows * blockSize - 1);
+	autoNUMvector<double> yblock ((integer) 0, nrows * blockSize - 1);
+	autoNUMmatrix<double> sum (1, nrows, 1, nrows);
+	double alpha = 1.0, beta = 0.0;
+	for (integer k1 = icol1; k1 <= icol2; k1 += blockSize) {
+		integer b = k1 + blockSize - 1 <= icol2 ? blockSize : icol2 - k1 + 1;
+		for (integer i = 1; i <= nrows; i ++) {
+			const double *xi = & x [i] [k1], *yi = & x [i] [k1 + lag];
+			double *xb = & xblock [(i - 1) * b], *yb = & yblock [(i - 1) * b];
+			for (integer k = 0; k < b; k ++) {
+				xb [k] = xi [k] - centroid [i];
+				yb [k] = yi [k] - centroid [i];
+			}
+		}
+		NUMblas_dgemm ("T", "N", & nrows, & nrows, & b, & alpha, & yblock [0], & b, & xblock [0], & b, & beta, & sum [1] [1], & nrows);
+		beta = 1.0;
+	}
 	for (integer i = 1; i <= nrows; i ++) {
 		for (integer j = i; j <= nrows; j ++) {
-			double ccor = 0;
-			for (integer k = icol1; k <= icol2; k ++) {
-				ccor += (x [i] [k] - centroid [i]) * (x [j] [k + lag] - centroid [j]);
-			}
-			cc [j] [i] = cc [i] [j] = ccor * scale;
+			cc [j] [i] = cc [i] [j] = sum [i] [j] * scale;
 		}
 	}
 }
 
+/*
+	Get the first and last sample (i1, i2) and the lag in samples for the CrossCorrelationTable of me.
+*/
+static void Sound_getCrossCorrelationSamples (Sound me, double startTime, double endTime, double lagStep, integer *p_i1, integer *p_i2, integer *p_lag) {
+	if (endTime <= startTime) {
+		startTime = my xmin;
+		endTime = my xmax;
+	}
+	integer lag = Melder_ifloor (lagStep / my dx);   // ppgb: voor al dit soort dingen geldt: waarom afronden naar beneden?
+	integer i1 = Sampled_xToNearestIndex (me, startTime);
+	if (i1 < 1) {
+		i1 = 1;
+	}
+	integer i2 = Sampled_xToNearestIndex (me, endTime);
+	if (i2 > my nx) {
+		i2 = my nx;
+	}
+	i2 -= lag;
+	integer nsamples = i2 - i1 + 1;
+	
+	Melder_require (nsamples > my ny, U"Not enough samples, choose a longer interval.");
+	*p_i1 = i1;
+	*p_i2 = i2;
+	*p_lag = lag;
+}
+
+static void Sound_into_CrossCorrelationTable (Sound me, CrossCorrelationTable thee, integer i1, integer i2, integer lag) {
+	NUMcrossCorrelate_rows (my z, my ny, i1, i2, lag, thy data, thy centroid, my dx);
+	thy numberOfObservations = i2 - i1 + 1;
+}
+
 /*
 	This is for multi-channel "sounds" like EEG signals.
 	The cross-correlation between channel i and channel j is defined as
@@ -470,29 +654,12 @@ autoCrossCorrelationTable Sound_to_CrossCorrelationTable (Sound me,
 	double startTime, double endTime, double lagStep)
 {
 	try {
-		if (endTime <= startTime) {
-			startTime = my xmin;
-			endTime = my xmax;
-		}
-		integer lag = Melder_ifloor (lagStep / my dx);   // ppgb: voor al dit soort dingen geldt: waarom afronden naar beneden?
-		integer i1 = Sampled_xToNearestIndex (me, startTime);
-		if (i1 < 1) {
-			i1 = 1;
-		}
-		integer i2 = Sampled_xToNearestIndex (me, endTime);
-		if (i2 > my nx) {
-			i2 = my nx;
-		}
-		i2 -= lag;
-		integer nsamples = i2 - i1 + 1;
-		
-		Melder_require (nsamples > my ny, U"Not enough samples, choose a longer interval.");
+		integer i1, i2, lag;
+		Sound_getCrossCorrelationSamples (me, startTime, endTime, lagStep, & i1, & i2, & lag);
 		
 		autoCrossCorrelationTable thee = CrossCorrelationTable_create (my ny);
 
-		NUMcrossCorrelate_rows (my z, my ny, i1, i2, lag, thy data, thy centroid, my dx);
-
-		thy numberOfObservations = nsamples;
+		Sound_into_CrossCorrelationTable (me, thee.get(), i1, i2, lag);
 
 		return thee;
 	} catch (MelderError) {
@@ -557,6 +724,34 @@ autoCovariance Sound_to_Covariance_channels (Sound me, double startTime, double
     }
 }
 
+Thing_define (Sound_into_CrossCorrelationTableList_Args, Thing) { public:
+	Sound sound;
+	CrossCorrelationTableList thee;
+	integer *i1, *i2, *lag;   // [1..thy size]
+	integer firstTable, tableStep;
+	bool isMainThread;
+	volatile int *cancelled;
+};
+
+Thing_implement (Sound_into_CrossCorrelationTableList_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE Sound_into_CrossCorrelationTableList (Sound_into_CrossCorrelationTableList_Args me) {
+	try {
+		for (integer itab = my firstTable; itab <= my thee -> size; itab += my tableStep) {
+			if (*my cancelled) MelderThread_RETURN;
+			Sound_into_CrossCorrelationTable (my sound, my thee -> at [itab], my i1 [itab], my i2 [itab], my lag [itab]);
+		}
+	} catch (MelderError) {
+		*my cancelled = 1;
+		if (my isMainThread) throw;
+	}
+	MelderThread_RETURN;
+}
+
+/*
+	The tables for the different lags are independent and about equally expensive;
+	they are computed in parallel, thread i taking the tables i, i + numberOfThreads, ...
+*/
 autoCrossCorrelationTableList Sound_to_CrossCorrelationTableList (Sound me,
 	double startTime, double endTime, integer numberOfCrossCorrelations, double lagStep)
 {
@@ -571,11 +766,37 @@ autoCrossCorrelationTableList Sound_to_CrossCorrelationTableList (Sound me,
 		Melder_require (startTime + numberOfCrossCorrelations * lagStep <= endTime, U"Lag time is too large.");
 		
 		autoCrossCorrelationTableList thee = CrossCorrelationTableList_create ();
+		autoNUMvector<integer> i1 (1, numberOfCrossCorrelations), i2 (1, numberOfCrossCorrelations), lag (1, numberOfCrossCorrelations);
 		for (integer i = 1; i <= numberOfCrossCorrelations; i ++) {
-			double lag = (i - 1) * lagStep;
-			autoCrossCorrelationTable ct = Sound_to_CrossCorrelationTable (me, startTime, endTime, lag);
+			Sound_getCrossCorrelationSamples (me, startTime, endTime, (i - 1) * lagStep, & i1 [i], & i2 [i], & lag [i]);
+			autoCrossCorrelationTable ct = CrossCorrelationTable_create (my ny);
 			thy addItem_move (ct.move());
 		}
+
+		int numberOfThreads = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads > numberOfCrossCorrelations) numberOfThreads = (int) numberOfCrossCorrelations;
+		double flopsPerTable = 2.0 * my ny * my ny * (i2 [1] - i1 [1] + 1);
+		if (numberOfThreads > numberOfCrossCorrelations * flopsPerTable / 1e6) numberOfThreads = (int) (numberOfCrossCorrelations * flopsPerTable / 1e6);
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		autoSound_into_CrossCorrelationTableList_Args args [16];
+		volatile int cancelled = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			autoSound_into_CrossCorrelationTableList_Args arg = Thing_new (Sound_into_CrossCorrelationTableList_Args);
+			arg -> sound = me;
+			arg -> thee = thee.get();
+			arg -> i1 = i1.peek();
+			arg -> i2 = i2.peek();
+			arg -> lag = lag.peek();
+			arg -> firstTable = ithread;
+			arg -> tableStep = numberOfThreads;
+			arg -> isMainThread = ( ithread == numberOfThreads );
+			arg -> cancelled = & cancelled;
+			args [ithread - 1] = arg.move();
+		}
+		MelderThread_run (Sound_into_CrossCorrelationTableList, args, numberOfThreads);
+		if (cancelled)
+			Melder_throw (U"Analysis interrupted.");
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": no CrossCorrelationTableList created.");
@@ -132,10 +132,7 @@ autoIntensity IntensityTier_to_Intensity (IntensityTier me, double dt) {
 		integer nt = Melder_ifloor ((my xmax - my xmin) / dt);
 		double t1 = 0.5 * dt;
 		autoIntensity thee = Intensity_create (my xmin, my xmax, nt, dt, t1);
-		for (integer i = 1; i <= nt; i ++) {
-			double time = t1 + (i - 1) * dt;
-			thy z [1] [i] = RealTier_getValueAtTime (me, time);
-		}
+		RealTier_getValuesAtSampleTimes (me, t1, dt, nt, thy z [1]);
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": Intensity not created.");
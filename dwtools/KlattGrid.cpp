@@ -42,6 +42,8 @@
 #include "Sound_to_Formant.h"
 #include "Sound_to_Intensity.h"
 #include "Sound_to_Pitch.h"
+#include "MelderThread.h"
+#include <mutex>
 
 #include "oo_DESTROY.h"
 #include "KlattGrid_def.h"
@@ -476,8 +478,150 @@ static void draw_oneSection (Graphics g, double xmin, double xmax, double ymin,
 // Normal dB's
 #define DB_to_A(x) (pow (10.0, x / 20.0))
 
+/************************ Sampled tier trajectories *********************************************/
+
+/*
+	Filtering a Sound with a formant means evaluating its frequency, bandwidth and amplitude tiers
+	at every sample time. Parameter sweeps synthesize many KlattGrids that share most of their tiers,
+	so we remember the sampled trajectories, keyed on the contents of the tier and on the time sampling.
+	The cache is shared by the synthesis threads. When a synthesis finishes, the trajectories
+	that it did not use are released, so that the cache holds no more than what the next synthesis
+	in a sweep is likely to need; the trajectories of the last synthesis stay behind
+	(at most TrajectoryCache_MAXIMUM_NUMBER_OF_SAMPLES samples, i.e. 32 MB).
+*/
+#define TrajectoryCache_MAXIMUM_NUMBER_OF_ENTRIES  64
+#define TrajectoryCache_MAXIMUM_NUMBER_OF_SAMPLES  4000000
+
+struct TrajectoryCacheEntry {
+	uint64 checksum;
+	integer numberOfPoints;
+	double *times, *values;   // a copy of the points of the tier
+	integer nx;
+	double x1, dx;
+	double *samples;
+	integer lastUse;
+};
+
+static struct {
+	TrajectoryCacheEntry entries [1 + TrajectoryCache_MAXIMUM_NUMBER_OF_ENTRIES];
+	integer numberOfEntries, numberOfSamples, clock;
+} theTrajectoryCache;
+
+static std::mutex theTrajectoryCacheMutex;   // statically initialized, so that any thread can be the first to use the cache
+
+static uint64 RealTier_getChecksum (RealTier me) {
+	uint64 checksum = 14695981039346656037ULL;   // FNV-1a
+	for (integer ipoint = 1; ipoint <= my points.size; ipoint ++) {
+		RealPoint point = my points.at [ipoint];
+		uint64 words [2];
+		memcpy (& words [0], & point -> number, sizeof (double));
+		memcpy (& words [1], & point -> value, sizeof (double));
+		checksum = (checksum ^ words [0]) * 1099511628211ULL;
+		checksum = (checksum ^ words [1]) * 1099511628211ULL;
+	}
+	return checksum;
+}
+
+static bool TrajectoryCacheEntry_matches (TrajectoryCacheEntry *entry, RealTier tier, uint64 checksum, Sound sound) {
+	if (entry -> checksum != checksum || entry -> numberOfPoints != tier -> points.size ||
+		entry -> nx != sound -> nx || entry -> x1 != sound -> x1 || entry -> dx != sound -> dx) return false;
+	for (integer ipoint = 1; ipoint <= tier -> points.size; ipoint ++) {
+		RealPoint point = tier -> points.at [ipoint];
+		if (entry -> times [ipoint] != point -> number || entry -> values [ipoint] != point -> value) return false;
+	}
+	return true;
+}
+
+static void TrajectoryCache_removeEntry (integer ientry) {
+	TrajectoryCacheEntry *entry = & theTrajectoryCache.entries [ientry];
+	NUMvector_free (entry -> times, 1);
+	NUMvector_free (entry -> values, 1);
+	NUMvector_free (entry -> samples, 1);
+	theTrajectoryCache.numberOfSamples -= entry -> nx;
+	theTrajectoryCache.entries [ientry] = theTrajectoryCache.entries [theTrajectoryCache.numberOfEntries];
+	theTrajectoryCache.numberOfEntries --;
+}
+
+static integer TrajectoryCache_getClock () {
+	std::lock_guard <std::mutex> lock (theTrajectoryCacheMutex);
+	return theTrajectoryCache.clock;
+}
+
+static void TrajectoryCache_removeEntriesNotUsedSince (integer clock) {
+	std::lock_guard <std::mutex> lock (theTrajectoryCacheMutex);
+	for (integer ientry = theTrajectoryCache.numberOfEntries; ientry >= 1; ientry --)
+		if (theTrajectoryCache.entries [ientry]. lastUse <= clock)
+			TrajectoryCache_removeEntry (ientry);
+}
+
+/*
+	Put the values of the tier at the sample times of the sound into samples [1..sound -> nx].
+*/
+static void RealTier_Sound_getSampledTrajectory (RealTier me, Sound sound, double *samples) {
+	uint64 checksum = RealTier_getChecksum (me);
+	bool found = false;
+	{
+		std::lock_guard <std::mutex> lock (theTrajectoryCacheMutex);
+		for (integer ientry = 1; ientry <= theTrajectoryCache.numberOfEntries; ientry ++) {
+			TrajectoryCacheEntry *entry = & theTrajectoryCache.entries [ientry];
+			if (TrajectoryCacheEntry_matches (entry, me, checksum, sound)) {
+				memcpy (& samples [1], & entry -> samples [1], sound -> nx * sizeof (double));
+				entry -> lastUse = ++ theTrajectoryCache.clock;
+				found = true;
+				break;
+			}
+		}
+	}
+	if (found) return;
+
+	RealTier_getValuesAtSampleTimes (me, sound -> x1, sound -> dx, sound -> nx, samples);
+
+	if (sound -> nx > TrajectoryCache_MAXIMUM_NUMBER_OF_SAMPLES / 4) return;   // would push out too much
+	integer numberOfPoints = my points.size;
+	autoNUMvector <double> times (1, numberOfPoints), values (1, numberOfPoints), copy (1, sound -> nx);
+	for (integer ipoint = 1; ipoint <= numberOfPoints; ipoint ++) {
+		RealPoint point = my points.at [ipoint];
+		times [ipoint] = point -> number;
+		values [ipoint] = point -> value;
+	}
+	memcpy (& copy [1], & samples [1], sound -> nx * sizeof (double));
+	{
+		std::lock_guard <std::mutex> lock (theTrajectoryCacheMutex);
+		while (theTrajectoryCache.numberOfEntries > 0 &&
+			(theTrajectoryCache.numberOfEntries >= TrajectoryCache_MAXIMUM_NUMBER_OF_ENTRIES ||
+			 theTrajectoryCache.numberOfSamples + sound -> nx > TrajectoryCache_MAXIMUM_NUMBER_OF_SAMPLES))
+		{
+			integer leastRecentlyUsed = 1;
+			for (integer ientry = 2; ientry <= theTrajectoryCache.numberOfEntries; ientry ++)
+				if (theTrajectoryCache.entries [ientry]. lastUse < theTrajectoryCache.entries [leastRecentlyUsed]. lastUse)
+					leastRecentlyUsed = ientry;
+			TrajectoryCache_removeEntry (leastRecentlyUsed);
+		}
+		TrajectoryCacheEntry *entry = & theTrajectoryCache.entries [++ theTrajectoryCache.numberOfEntries];
+		entry -> checksum = checksum;
+		entry -> numberOfPoints = numberOfPoints;
+		entry -> times = times.transfer();
+		entry -> values = values.transfer();
+		entry -> nx = sound -> nx;
+		entry -> x1 = sound -> x1;
+		entry -> dx = sound -> dx;
+		entry -> samples = copy.transfer();
+		entry -> lastUse = ++ theTrajectoryCache.clock;
+		theTrajectoryCache.numberOfSamples += sound -> nx;
+	}
+}
+
 /************************ Sound & FormantGrid *********************************************/
 
+/*
+	The filter coefficients follow the formant and bandwidth tiers, but computing them at every sample
+	is expensive. We compute them every half millisecond and interpolate in between.
+*/
+static integer KlattGrid_getCoefficientBlockSize (Sound me) {
+	integer blockSize = Melder_ifloor (0.0005 / my dx);
+	return blockSize < 1 ? 1 : blockSize;
+}
+
 static void _Sound_FormantGrid_filterWithOneFormant_inplace (Sound me, FormantGrid thee, integer iformant, int antiformant) {
 	if (iformant < 1 || iformant > thy formants.size) {
 		Melder_warning (U"Formant ", iformant, U" does not exist.");
@@ -493,23 +637,12 @@ static void _Sound_FormantGrid_filterWithOneFormant_inplace (Sound me, FormantGr
 		Melder_throw (U"Empty tier");
 	}
 
-	double nyquist = 0.5 / my dx;
-	autoFilter r;
-	if (antiformant != 0) {
-		r = AntiResonator_create (my dx);
-	} else {
-		r = Resonator_create (my dx, Resonator_NORMALISATION_H0);
-	}
-
-	for (integer is = 1; is <= my nx; is ++) {
-		double t = my x1 + (is - 1) * my dx;
-		double f = RealTier_getValueAtTime (ftier, t);
-		double b = RealTier_getValueAtTime (btier, t);
-		if (f <= nyquist && isdefined (b)) {
-			Filter_setFB (r.get(), f, b);
-		}
-		my z [1] [is] = Filter_getOutput (r.get(), my z [1] [is]);
-	}
+	autoResonatorBank r = ResonatorBank_create (antiformant != 0 ? ResonatorBank_ANTIRESONATOR : ResonatorBank_RESONATOR_H0, my dx, 1);
+	autoNUMvector <double> f (1, my nx), b (1, my nx);
+	RealTier_Sound_getSampledTrajectory (ftier, me, f.peek());
+	RealTier_Sound_getSampledTrajectory (btier, me, b.peek());
+	double *fs [2] = { nullptr, f.peek() }, *bs [2] = { nullptr, b.peek() }, *zs [2] = { nullptr, my z [1] };
+	ResonatorBank_filter (r.get(), zs, my nx, fs, bs, nullptr, KlattGrid_getCoefficientBlockSize (me));
 }
 
 void Sound_FormantGrid_filterWithOneAntiFormant_inplace (Sound me, FormantGrid thee, integer iformant) {
@@ -520,11 +653,31 @@ void Sound_FormantGrid_filterWithOneFormant_inplace (Sound me, FormantGrid thee,
 	_Sound_FormantGrid_filterWithOneFormant_inplace (me, thee, iformant, 0);
 }
 
+/*
+	Filter x [1..numberOfFormants] [1..my nx] in place, each row with its own formant from the list.
+*/
+static void Sound_FormantGrid_Intensities_filterWithFormants (Sound me, FormantGrid thee, OrderedOf<structIntensityTier>* amplitudes,
+	integer numberOfFormants, integer formants [], double **x)
+{
+	autoResonatorBank r = ResonatorBank_create (ResonatorBank_RESONATOR_HMAX, my dx, numberOfFormants);
+	autoNUMmatrix <double> f (1, numberOfFormants, 1, my nx), b (1, numberOfFormants, 1, my nx), a (1, numberOfFormants, 1, my nx);
+	for (integer lane = 1; lane <= numberOfFormants; lane ++) {
+		integer iformant = formants [lane];
+		RealTier_Sound_getSampledTrajectory (thy formants.at [iformant], me, f [lane]);
+		RealTier_Sound_getSampledTrajectory (thy bandwidths.at [iformant], me, b [lane]);
+		RealTier_Sound_getSampledTrajectory (amplitudes->at [iformant], me, a [lane]);
+		for (integer is = 1; is <= my nx; is ++) {
+			if (isdefined (a [lane] [is])) {
+				a [lane] [is] = DB_to_A (a [lane] [is]);
+			}
+		}
+	}
+	ResonatorBank_filter (r.get(), x, my nx, f.peek(), b.peek(), a.peek(), KlattGrid_getCoefficientBlockSize (me));
+}
+
 void Sound_FormantGrid_Intensities_filterWithOneFormant_inplace (Sound me, FormantGrid thee, OrderedOf<structIntensityTier>* amplitudes, integer iformant) {
 	try {
 		Melder_require (iformant > 0 && iformant <= thy formants.size, U"Formant ", iformant, U" not defined.");
-		
-		double nyquist = 0.5 / my dx;
 
 		RealTier ftier = thy formants.at [iformant];
 		RealTier btier = thy bandwidths.at [iformant];
@@ -534,22 +687,9 @@ void Sound_FormantGrid_Intensities_filterWithOneFormant_inplace (Sound me, Forma
 			return;    // nothing to do
 		}
 
-		autoResonator r = Resonator_create (my dx, Resonator_NORMALISATION_HMAX);
-
-		for (integer is = 1; is <= my nx; is ++) {
-			double t = my x1 + (is - 1) * my dx;
-			double f = RealTier_getValueAtTime (ftier, t);
-			double b = RealTier_getValueAtTime (btier, t);
-			double a;
-			if (f <= nyquist && isdefined (b)) {
-				Filter_setFB (r.get(), f, b);
-				a = RealTier_getValueAtTime (atier, t);
-				if (isdefined (a)) {
-					r -> a *= DB_to_A (a);
-				}
-			}
-			my z [1] [is] = Filter_getOutput (r.get(), my z [1] [is]);
-		}
+		integer formants [2] = { 0, iformant };
+		double *x [2] = { nullptr, my z [1] };
+		Sound_FormantGrid_Intensities_filterWithFormants (me, thee, amplitudes, 1, formants, x);
 	} catch (MelderError) {
 		Melder_throw (me, U": not filtered with one formant filter.");
 	}
@@ -566,18 +706,34 @@ autoSound Sound_FormantGrid_Intensities_filter (Sound me, FormantGrid thee, Orde
 
 		autoSound him = Sound_create (my ny, my xmin, my xmax, my nx, my dx, my x1);
 
+		/*
+			The formants are in parallel: they all filter the same input, each in its own lane of a ResonatorBank.
+		*/
+		autoNUMvector <integer> formants (1, iformante - iformantb + 1);
+		autoNUMvector <int> signs (1, iformante - iformantb + 1);
+		integer numberOfFormants = 0;
 		for (integer iformant = iformantb; iformant <= iformante; iformant ++) {
 			if (FormantGrid_Intensities_isFormantDefined (thee, amplitudes, iformant)) {
-				autoSound tmp = Data_copy (me);
-				Sound_FormantGrid_Intensities_filterWithOneFormant_inplace (tmp.get(), thee, amplitudes, iformant);
-				for (integer is = 1; is <= my nx; is ++) {
-					his z [1] [is] += ( alternatingSign >= 0 ? tmp -> z [1] [is] : - tmp -> z [1] [is] );
-				}
+				formants [++ numberOfFormants] = iformant;
+				signs [numberOfFormants] = alternatingSign;
 				if (alternatingSign != 0) {
 					alternatingSign = - alternatingSign;
 				}
 			}
 		}
+		if (numberOfFormants == 0) {
+			return him;
+		}
+		autoNUMmatrix <double> x (1, numberOfFormants, 1, my nx);
+		for (integer lane = 1; lane <= numberOfFormants; lane ++) {
+			NUMvector_copyElements (my z [1], x [lane], 1, my nx);
+		}
+		Sound_FormantGrid_Intensities_filterWithFormants (me, thee, amplitudes, numberOfFormants, formants.peek(), x.peek());
+		for (integer lane = 1; lane <= numberOfFormants; lane ++) {
+			for (integer is = 1; is <= my nx; is ++) {
+				his z [1] [is] += ( signs [lane] >= 0 ? x [lane] [is] : - x [lane] [is] );
+			}
+		}
 		return him;
 	} catch (MelderError) {
 		Melder_throw (me, U": not filtered.");
@@ -851,10 +1007,11 @@ autoSound PhonationGrid_to_Sound_aspiration (PhonationGrid me, double samplingFr
 		// the origin in the z-plane, i.e. y [n] = x [n] + (0.75 * y [n-1])
 		double lastval = 0.0;
 		if (my aspirationAmplitude -> points.size > 0) {
+			integer lowIndex = 0;
 			for (integer i = 1; i <= thy nx; i ++) {
 				double t = thy x1 + (i - 1) * thy dx;
 				double val = NUMrandomUniform (-1.0, 1.0);
-				double a = DBSPL_to_A (RealTier_getValueAtTime (my aspirationAmplitude.get(), t));
+				double a = DBSPL_to_A (RealTier_getValueAtTime_continued (my aspirationAmplitude.get(), t, & lowIndex));
 				if (isdefined (a)) {
 					thy z [1] [i] = lastval = val + 0.75 * lastval;
 					lastval = (val += 0.75 * lastval); // soft low-pass
@@ -882,9 +1039,10 @@ static void Sound_PhonationGrid_spectralTilt_inplace (Sound thee, PhonationGrid
 
 		double cosf = cos (2.0 * NUMpi * 3000.0 * thy dx), ynm1 = 0.0;  // samplingFrequency > 6000.0 !
 
+		integer lowIndex = 0;
 		for (integer i = 1; i <= thy nx; i ++) {
 			double t = thy x1 + (i - 1) * thy dx;
-			double tilt_db = RealTier_getValueAtTime (my spectralTilt.get(), t);
+			double tilt_db = RealTier_getValueAtTime_continued (my spectralTilt.get(), t, & lowIndex);
 
 			if (tilt_db > 0) {
 				double d = pow (10.0, -tilt_db / 10.0);
@@ -971,8 +1129,10 @@ autoPhonationTier PhonationGrid_to_PhonationTier (PhonationGrid me) {
 			Determine the f0 -> period T [i]
 			Determine time t [i]-T [i] the open quotient, power1, power2, collisionphase etc.
 			Generate the period.
+		The period starts increase, so the tiers are queried by walking along their points.
 		*/
 
+		integer collisionPhaseIndex = 0, power1Index = 0, power2Index = 0, openPhaseIndex = 0, doublePulsingIndex = 0;
 		for (integer it = 1; it <= point -> nt; it ++) {
 			double re = 0.0, t = point -> t [it];		// the glottis "closing" point
 			double pulseDelay = 0.0;        // For alternate pulses in case of diplophonia
@@ -988,15 +1148,15 @@ autoPhonationTier PhonationGrid_to_PhonationTier (PhonationGrid me) {
 
 			double periodStart = t - period; // point where period starts:
 
-			double collisionPhase = pp -> collisionPhase ? RealTier_getValueAtTime (my collisionPhase.get(), periodStart) : 0.0;
+			double collisionPhase = pp -> collisionPhase ? RealTier_getValueAtTime_continued (my collisionPhase.get(), periodStart, & collisionPhaseIndex) : 0.0;
 			if (isundef (collisionPhase)) {
 				collisionPhase = 0.0;
 			}
-			double power1 = pp -> flowFunction == 1 ? RealTier_getValueAtTime (my power1.get(), periodStart) : pp -> flowFunction;
+			double power1 = pp -> flowFunction == 1 ? RealTier_getValueAtTime_continued (my power1.get(), periodStart, & power1Index) : pp -> flowFunction;
 			if (isundef (power1)) {
 				power1 = KlattGrid_POWER1_DEFAULT;
 			}
-			double power2 = pp -> flowFunction == 1 ? RealTier_getValueAtTime (my power2.get(), periodStart) : pp -> flowFunction + 1;
+			double power2 = pp -> flowFunction == 1 ? RealTier_getValueAtTime_continued (my power2.get(), periodStart, & power2Index) : pp -> flowFunction + 1;
 			if (isundef (power2)) {
 				power2 = KlattGrid_POWER2_DEFAULT;
 			}
@@ -1006,7 +1166,7 @@ autoPhonationTier PhonationGrid_to_PhonationTier (PhonationGrid me) {
 				Melder_warning (U"Illegal collision point at t = ", t, U" (power1=", power1, U", power2=", power2, U"colPhase=", collisionPhase, U")");
 			}
 
-			double openPhase = RealTier_getValueAtTime (my openPhase.get(), periodStart);
+			double openPhase = RealTier_getValueAtTime_continued (my openPhase.get(), periodStart, & openPhaseIndex);
 			if (isundef (openPhase)) {
 				openPhase = KlattGrid_OPENPHASE_DEFAULT;
 			}
@@ -1018,7 +1178,7 @@ autoPhonationTier PhonationGrid_to_PhonationTier (PhonationGrid me) {
 			// This delay scales to maximally equal the closed phase of the next period.
 			// The doublePulsing scales the amplitudes as well as the delay linearly.
 
-			double doublePulsing = pp -> doublePulsing ? RealTier_getValueAtTime (my doublePulsing.get(), periodStart) : 0.0;
+			double doublePulsing = pp -> doublePulsing ? RealTier_getValueAtTime_continued (my doublePulsing.get(), periodStart, & doublePulsingIndex) : 0.0;
 			if (isundef (doublePulsing)) {
 				doublePulsing = 0.0;
 			}
@@ -1163,9 +1323,10 @@ static autoSound PhonationGrid_PhonationTier_to_Sound_voiced (PhonationGrid me,
 			Vector_scale (him.get(), extremum);
 		}
 
+		integer lowIndex = 0;
 		for (integer i = 1; i <= his nx; i ++) {
 			double t = his x1 + (i - 1) * his dx;
-			his z [1] [i] *= DBSPL_to_A (RealTier_getValueAtTime (my voicingAmplitude.get(), t));
+			his z [1] [i] *= DBSPL_to_A (RealTier_getValueAtTime_continued (my voicingAmplitude.get(), t, & lowIndex));
 			if (breathy) {
 				his z [1] [i] += breathy -> z [1] [i];
 			}
@@ -1994,18 +2155,21 @@ void FricationGrid_draw (FricationGrid me, Graphics g) {
 	Graphics_unsetInner (g);
 }
 
-autoSound FricationGrid_to_Sound (FricationGrid me, double samplingFrequency) {
+static autoSound FricationGrid_to_Sound_mt (FricationGrid me, double samplingFrequency, int threadNumber) {
 	try {
 		autoSound thee = Sound_createEmptyMono (my xmin, my xmax, samplingFrequency);
 
+		autoNUMvector <double> dba;
+		if (my fricationAmplitude -> points.size > 0) {
+			dba.reset (1, thy nx);
+			RealTier_Sound_getSampledTrajectory (my fricationAmplitude.get(), thee.get(), dba.peek());
+		}
 		double lastval = 0.0;
 		for (integer i = 1; i <= thy nx; i ++) {
-			double t = thy x1 + (i - 1) * thy dx;
-			double val = NUMrandomUniform (-1.0, 1.0);
+			double val = -1.0 + 2.0 * NUMrandomFraction_mt (threadNumber);
 			double a = 0.0;
-			if (my fricationAmplitude -> points.size > 0) {
-				double dba = RealTier_getValueAtTime (my fricationAmplitude.get(), t);
-				a = ( isdefined (dba) ? DBSPL_to_A (dba) : 0.0 );
+			if (dba.peek()) {
+				a = ( isdefined (dba [i]) ? DBSPL_to_A (dba [i]) : 0.0 );
 			}
 			lastval = (val += 0.75 * lastval); // TODO: soft low-pass coefficient should be Fs dependent!
 			thy z [1] [i] = val * a;
@@ -2018,6 +2182,10 @@ autoSound FricationGrid_to_Sound (FricationGrid me, double samplingFrequency) {
 	}
 }
 
+autoSound FricationGrid_to_Sound (FricationGrid me, double samplingFrequency) {
+	return FricationGrid_to_Sound_mt (me, samplingFrequency, 0);
+}
+
 /************************ Sound & FricationGrid *********************************************/
 
 autoSound Sound_FricationGrid_filter (Sound me, FricationGrid thee) {
@@ -2038,14 +2206,11 @@ autoSound Sound_FricationGrid_filter (Sound me, FricationGrid thee) {
 			him = Data_copy (me);
 		}
 
-		if (pf -> bypass) {
+		if (pf -> bypass && thy bypass -> points.size > 0) {
+			autoNUMvector <double> val (1, his nx);
+			RealTier_Sound_getSampledTrajectory (thy bypass.get(), him.get(), val.peek());
 			for (integer is = 1; is <= his nx; is ++) {	// Bypass
-				double t = his x1 + (is - 1) * his dx;
-				double ab = 0.0;
-				if (thy bypass -> points.size > 0) {
-					double val = RealTier_getValueAtTime (thy bypass.get(), t);
-					ab = ( isundef (val) ? 0.0 : DB_to_A (val) );
-				}
+				double ab = ( isundef (val [is]) ? 0.0 : DB_to_A (val [is]) );
 				his z [1] [is] += my z [1] [is] * ab;
 			}
 		}
@@ -2761,7 +2926,39 @@ autoSound KlattGrid_to_Sound_phonation (KlattGrid me) {
 	return PhonationGrid_to_Sound (my phonation.get(), 0, my options -> samplingFrequency);
 }
 
+/*
+	The voiced branch (phonation and vocal tract) and the frication branch are independent,
+	so they are synthesized concurrently. The voiced branch stays in the main thread, because it may issue warnings;
+	the frication branch draws its noise from its own random stream.
+*/
+Thing_define (KlattGrid_Branch_Args, Thing) { public:
+	KlattGrid klattGrid;
+	autoSound result;
+	bool isFricationBranch;
+	volatile int *cancelled;
+};
+
+Thing_implement (KlattGrid_Branch_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE KlattGrid_synthesizeBranch (KlattGrid_Branch_Args me) {
+	KlattGrid kg = my klattGrid;
+	double samplingFrequency = kg -> options -> samplingFrequency;
+	try {
+		if (my isFricationBranch) {
+			my result = FricationGrid_to_Sound_mt (kg -> frication.get(), samplingFrequency, 1);
+		} else {
+			autoSound source = PhonationGrid_to_Sound (kg -> phonation.get(), kg -> coupling.get(), samplingFrequency);
+			my result = Sound_VocalTractGrid_CouplingGrid_filter (source.get(), kg -> vocalTract.get(), kg -> coupling.get());
+		}
+	} catch (MelderError) {
+		*my cancelled = 1;
+		if (! my isFricationBranch) throw;   // the main thread
+	}
+	MelderThread_RETURN;
+}
+
 autoSound KlattGrid_to_Sound (KlattGrid me) {
+	integer startOfSynthesis = TrajectoryCache_getClock ();
 	try {
 		autoSound thee;
 		PhonationGridPlayOptions pp = my phonation -> options.get();
@@ -2772,18 +2969,29 @@ autoSound KlattGrid_to_Sound (KlattGrid me) {
 			KlattGrid_setGlottisCoupling (me);
 		}
 
-		if (pp -> aspiration || pp -> voicing) { // No vocal tract filtering if no glottal source signal present
+		bool hasVoicedBranch = pp -> aspiration || pp -> voicing; // No vocal tract filtering if no glottal source signal present
+		bool hasFricationBranch = pf -> endFricationFormant > 0 || pf -> bypass;
+
+		if (hasVoicedBranch && hasFricationBranch) {
+			autoKlattGrid_Branch_Args args [2];
+			volatile int cancelled = 0;
+			for (int ibranch = 1; ibranch <= 2; ibranch ++) {
+				autoKlattGrid_Branch_Args arg = Thing_new (KlattGrid_Branch_Args);
+				arg -> klattGrid = me;
+				arg -> isFricationBranch = ( ibranch == 1 );
+				arg -> cancelled = & cancelled;
+				args [ibranch - 1] = arg.move();
+			}
+			MelderThread_run (KlattGrid_synthesizeBranch, args, 2);   // the last one runs in the main thread
+			if (cancelled)
+				Melder_throw (U"Frication not synthesized.");
+			thee = args [1] -> result.move();
+			_Sounds_add_inplace (thee.get(), args [0] -> result.get());
+		} else if (hasVoicedBranch) {
 			autoSound source = PhonationGrid_to_Sound (my phonation.get(), my coupling.get(), samplingFrequency);
 			thee = Sound_VocalTractGrid_CouplingGrid_filter (source.get(), my vocalTract.get(), my coupling.get());
-		}
-
-		if (pf -> endFricationFormant > 0 || pf -> bypass) {
-			autoSound frication = FricationGrid_to_Sound (my frication.get(), samplingFrequency);
-			if (thee) {
-				_Sounds_add_inplace (thee.get(), frication.get());
-			} else {
-				thee = frication.move();
-			}
+		} else if (hasFricationBranch) {
+			thee = FricationGrid_to_Sound (my frication.get(), samplingFrequency);
 		}
 
 		if (thee) {
@@ -2791,8 +2999,10 @@ autoSound KlattGrid_to_Sound (KlattGrid me) {
 		} else if (my options -> scalePeak) {
 			thee = Sound_createEmptyMono (my xmin, my xmax, samplingFrequency);
 		}
+		TrajectoryCache_removeEntriesNotUsedSince (startOfSynthesis);
 		return thee;
 	} catch (MelderError) {
+		TrajectoryCache_removeEntriesNotUsedSince (startOfSynthesis);
 		Melder_throw (me, U": no Sound created.");
 	}
 }
@@ -453,6 +453,12 @@ typedef struct structKlattGlobal {
 	integer original_f0; /* original value of f0 not modified by flutter (kanweg) */
 	autoResonator rp [7], rc [9], rnpp, rnpc, rgl, rlp, rout;
 	autoAntiResonator rnz;
+	/* Signals of one frame, [1..nspfr] */
+	double *cascadeSignal; /* laryngeal source, filtered by the cascade vocal tract */
+	double *parallelVoicing; /* voicing plus aspiration, filtered by the first parallel formant */
+	double *parallelSource; /* frication plus the first difference of the voicing */
+	double **parallelSignals; /* [1..6], parallelSource filtered by the other parallel resonators */
+	double *selectedSignal; /* the waveform chosen with outsl */
 } *KlattGlobal;
 
 autoKlattTable KlattTable_readFromRawTextFile (MelderFile fs) {
@@ -490,6 +496,11 @@ static void KlattGlobal_free (KlattGlobal me) {
 	my rgl.reset();
 	my rlp.reset();
 	my rout.reset();
+	NUMvector_free (my cascadeSignal, 1);
+	NUMvector_free (my parallelVoicing, 1);
+	NUMvector_free (my parallelSource, 1);
+	NUMmatrix_free (my parallelSignals, 1, 1);
+	NUMvector_free (my selectedSignal, 1);
 	Melder_free (me);
 }
 
@@ -545,6 +556,12 @@ static void KlattGlobal_init (KlattGlobal me, int synthesisModel, int numberOfFo
 	my FLPhz = Melder_ifloor (0.0950 * my samrate); // depends on samplingFrequency ????
 	my BLPhz = Melder_ifloor (0.0630 * my samrate);
 	Filter_setFB (my rlp.get(), my FLPhz, my BLPhz);
+
+	my cascadeSignal = NUMvector <double> (1, my nspfr);
+	my parallelVoicing = NUMvector <double> (1, my nspfr);
+	my parallelSource = NUMvector <double> (1, my nspfr);
+	my parallelSignals = NUMmatrix <double> (1, 6, 1, my nspfr);
+	my selectedSignal = NUMvector <double> (1, my nspfr);
 }
 
 static KlattFrame KlattFrame_create () {
@@ -886,7 +903,7 @@ static void KlattGlobal_synthesizeFrame (KlattGlobal me, short *output) {
 
 	KlattFrame_flutter (me);
 
-	/* MAIN LOOP, for each output sample of current frame: */
+	/* MAIN LOOP, the sources for each output sample of current frame: */
 
 	for (my ns = 0; my ns < my nspfr; my ns ++) {
 
@@ -975,36 +992,8 @@ static void KlattGlobal_synthesizeFrame (KlattGlobal me, short *output) {
 
 		par_glotout += aspiration;
 
-
-		/*
-		Cascade vocal tract, excited by laryngeal sources.
-		Nasal antiresonator, then formants FNP, F5, F4, F3, F2, F1
-		*/
-
-		if (my synthesis_model != ALL_PARALLEL) {
-			out = Filter_getOutput (my rnz.get(), glotout); /* anti resonator */
-			out = Filter_getOutput (my rnpc.get(), out);
-
-			for (integer i = 8; i > 0; i--) {
-				if (my nfcascade >= i) {
-					out = Filter_getOutput (my rc [i].get(), out);
-				}
-			}
-		} else {
-			/* we are not using the cascade tract, set out to zero */
-			out = 0;
-		}
-
-		/* Excite parallel F1 and FNP by voicing waveform */
-
-		sourc = par_glotout;        /* Source is voicing plus aspiration */
-
 		/*
-		Standard parallel vocal tract Formants F6,F5,F4,F3,F2,
-		outputs added with alternating sign. Sound sourc for other
-		parallel resonators is frication plus first difference of
-		voicing waveform.
-
+		Sources of the cascade and the parallel vocal tract.
 		In Klatt80:
 			source: through r1,
 			diff(source)+frication: through filters rnp, r2, r3, r4
@@ -1016,52 +1005,109 @@ static void KlattGlobal_synthesizeFrame (KlattGlobal me, short *output) {
 		Problem: The source signal is already v' [n], and we are differentiating here again ???
 		*/
 
-		out += Filter_getOutput (my rp [1].get(), sourc);
-
+		my cascadeSignal [my ns + 1] = glotout;
+		my parallelVoicing [my ns + 1] = par_glotout; /* Source is voicing plus aspiration */
 		sourc = frics + par_glotout - glotlast; // diff
 		glotlast = par_glotout;
+		my parallelSource [my ns + 1] = sourc;
+
+		double selected = undefined;
+		switch (my outsl) {
+			case 1:
+				selected = voice;
+				break;
+			case 2:
+				selected = aspiration;
+				break;
+			case 3:
+				selected = frics;
+				break;
+			case 4:
+				selected = glotout;
+				break;
+			case 5:
+				selected = par_glotout;
+				break;
+			case 6:
+				selected = my amp_bypas * sourc;
+				break;
+			case 7:
+				selected = sourc;
+				break;
+		}
+		my selectedSignal [my ns + 1] = selected;
+	}
+
+	/*
+		The vocal tract filters only change from frame to frame,
+		so each of them can filter the whole frame in one go.
+	*/
 
-		out += Filter_getOutput (my rnpp.get(), sourc);
+	integer numberOfSamples = my nspfr;
 
-		for (integer i = 6; i >= 2; i--) {
+	/*
+	Cascade vocal tract, excited by laryngeal sources.
+	Nasal antiresonator, then formants FNP, F5, F4, F3, F2, F1
+	*/
+
+	if (my synthesis_model != ALL_PARALLEL) {
+		Filter cascade [11];
+		integer numberOfFilters = 0;
+		cascade [++ numberOfFilters] = my rnz.get(); /* anti resonator */
+		cascade [++ numberOfFilters] = my rnpc.get();
+		for (integer i = 8; i > 0; i--) {
 			if (my nfcascade >= i) {
-				out = Filter_getOutput (my rp [i].get(), sourc) - out;
+				cascade [++ numberOfFilters] = my rc [i].get();
 			}
 		}
+		Filters_filterCascade (cascade, numberOfFilters, my cascadeSignal, numberOfSamples);
+	} else {
+		/* we are not using the cascade tract, set out to zero */
+		for (integer isamp = 1; isamp <= numberOfSamples; isamp ++) {
+			my cascadeSignal [isamp] = 0;
+		}
+	}
 
-		double outbypas = my amp_bypas * sourc;
-		out = outbypas - out;
+	/*
+	Excite parallel F1 by voicing waveform.
+	Standard parallel vocal tract Formants F6,F5,F4,F3,F2,
+	outputs added with alternating sign. Sound sourc for other
+	parallel resonators is frication plus first difference of
+	voicing waveform.
+	*/
 
+	Filter_filter (my rp [1].get(), my parallelVoicing, numberOfSamples);
 
-		if (my outsl != 0) {
-			switch (my outsl) {
-				case 1:
-					out = voice;
-					break;
-				case 2:
-					out = aspiration;
-					break;
-				case 3:
-					out = frics;
-					break;
-				case 4:
-					out = glotout;
-					break;
-				case 5:
-					out = par_glotout;
-					break;
-				case 6:
-					out = outbypas;
-					break;
-				case 7:
-					out = sourc;
-					break;
-			}
+	Filter parallel [7];
+	integer numberOfParallelFilters = 0;
+	parallel [++ numberOfParallelFilters] = my rnpp.get();
+	for (integer i = 6; i >= 2; i--) {
+		if (my nfcascade >= i) {
+			parallel [++ numberOfParallelFilters] = my rp [i].get();
+		}
+	}
+	Filters_filterParallel (parallel, numberOfParallelFilters, my parallelSource, my parallelSignals, numberOfSamples);
+
+	for (integer isamp = 1; isamp <= numberOfSamples; isamp ++) {
+		out = my cascadeSignal [isamp] + my parallelVoicing [isamp];
+		out += my parallelSignals [1] [isamp];
+		for (integer k = 2; k <= numberOfParallelFilters; k ++) {
+			out = my parallelSignals [k] [isamp] - out;
 		}
 
-		out = Filter_getOutput (my rout.get(), out);
+		double outbypas = my amp_bypas * my parallelSource [isamp];
+		out = outbypas - out;
+
+		if (isdefined (my selectedSignal [isamp])) {
+			out = my selectedSignal [isamp];
+		}
+		my cascadeSignal [isamp] = out;
+	}
+
+	Filter_filter (my rout.get(), my cascadeSignal, numberOfSamples);
 
-		double temp = out * my amp_gain0;  /* Convert back to integer */
+	for (integer isamp = 1; isamp <= numberOfSamples; isamp ++) {
+		double temp = my cascadeSignal [isamp] * my amp_gain0;  /* Convert back to integer */
 
 		if (temp < -32768.0) {
 			temp = -32768.0;
@@ -36,6 +36,8 @@
 #include "MDS.h"
 #include "SSCP.h"
 #include "PCA.h"
+#include "NUMcblas.h"
+#include "MelderThread.h"
 
 #define TINY 1e-30
 
@@ -246,6 +248,21 @@ autoTransformator Transformator_create (integer numberOfPoints) {
 	}
 }
 
+void structTransformator :: v_copy (Transformator thee) {
+	thy numberOfPoints = numberOfPoints;
+	thy normalization = normalization;
+}
+
+autoTransformator Transformator_copy (Transformator me) {
+	try {
+		autoTransformator thee = Thing_newFromClass (my classInfo).static_cast_move <structTransformator> ();
+		my v_copy (thee.get());
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": not copied.");
+	}
+}
+
 autoDistance Transformator_transform (Transformator me, MDSVec vec, Distance d, Weight w) {
 	try {
 		Melder_require (my numberOfPoints == vec -> nPoints && my numberOfPoints == d -> numberOfRows &&
@@ -289,6 +306,12 @@ autoDistance structRatioTransformator :: v_transform (MDSVec vec, Distance d, We
 	return thee;
 }
 
+void structRatioTransformator :: v_copy (Transformator thee_Transformator) {
+	RatioTransformator thee = static_cast <RatioTransformator> (thee_Transformator);
+	RatioTransformator_Parent :: v_copy (thee);
+	thy ratio = ratio;
+}
+
 autoRatioTransformator RatioTransformator_create (integer numberOfPoints) {
 	try {
 		autoRatioTransformator me = Thing_new (RatioTransformator);
@@ -311,6 +334,12 @@ autoDistance structMonotoneTransformator :: v_transform (MDSVec vec, Distance d,
 	}
 }
 
+void structMonotoneTransformator :: v_copy (Transformator thee_Transformator) {
+	MonotoneTransformator thee = static_cast <MonotoneTransformator> (thee_Transformator);
+	MonotoneTransformator_Parent :: v_copy (thee);
+	thy tiesHandling = tiesHandling;
+}
+
 autoMonotoneTransformator MonotoneTransformator_create (integer numberOfPoints) {
 	try {
 		autoMonotoneTransformator me = Thing_new (MonotoneTransformator);
@@ -333,6 +362,19 @@ void structISplineTransformator :: v_destroy () noexcept {
 	ISplineTransformator_Parent :: v_destroy ();
 }
 
+void structISplineTransformator :: v_copy (Transformator thee_Transformator) {
+	ISplineTransformator thee = static_cast <ISplineTransformator> (thee_Transformator);
+	ISplineTransformator_Parent :: v_copy (thee);
+	thy numberOfInteriorKnots = numberOfInteriorKnots;
+	thy order = order;
+	thy numberOfParameters = numberOfParameters;
+	integer nData = (numberOfPoints - 1) * numberOfPoints / 2;
+	integer numberOfKnots = numberOfInteriorKnots + order + order + 2;
+	thy b = NUMvector_copy (b, 1, numberOfParameters);
+	thy knot = NUMvector_copy (knot, 1, numberOfKnots);
+	thy m = NUMmatrix_copy (m, 1, nData, 1, numberOfParameters);
+}
+
 autoDistance structISplineTransformator :: v_transform (MDSVec vec, Distance dist, Weight w) {
 	double tol = 1e-6;
 	integer itermax = 20, nx = vec -> nProximities;
@@ -1557,41 +1599,41 @@ autoDistanceList DissimilarityList_to_DistanceList (DissimilarityList me, int me
 
 /*****************  Kruskal *****************************************/
 
-static void smacof_guttmanTransform (Configuration cx, Configuration cz, Distance disp, Weight weight, double **vplus) {
+/*
+	Guttman transform: X = (V+)B(Z)Z (eq. 8.29).
+	B(Z) is never stored: with b [i] [i] = - sum (l != i, b [i] [l]), row i of B(Z)Z equals
+	sum (l != i, b [i] [l] (z [l] - z [i])), which costs O(nPoints^2 nDimensions) instead of the
+	O(nPoints^3) of forming B(Z) and multiplying. The product with V+ is a single dgemm on the contiguous
+	row-major storage: row-major nPoints x nDimensions is column-major nDimensions x nPoints, so
+	X' := (B(Z)Z)' (V+)'. The distances of Z are those the caller already has (distZ).
+*/
+static void smacof_guttmanTransform (Configuration cx, Configuration cz, Distance distZ, Distance disp, Weight weight, double **vplus, double **bz) {
 	integer nPoints = cx -> numberOfRows, nDimensions = cx -> numberOfColumns;
 	double **z = cz -> data;
 
-	autoNUMmatrix<double> b (1, nPoints, 1, nPoints);
-	autoDistance distZ = Configuration_to_Distance (cz);
-
-	// compute B(Z) (eq. 8.25)
+	// compute B(Z)Z (eq. 8.25)
 
 	for (integer i = 1; i <= nPoints; i ++) {
-		longdouble sum = 0.0;
-		for (integer j = 1; j <= nPoints; j ++) {
-			double dzij = distZ -> data [i] [j];
-			if (i == j || dzij == 0.0) {
+		const double *dzi = distZ -> data [i], *wi = weight -> data [i], *di = disp -> data [i], *zi = z [i];
+		double *bzi = bz [i];
+		for (integer j = 1; j <= nDimensions; j ++) {
+			bzi [j] = 0.0;
+		}
+		for (integer l = 1; l <= nPoints; l ++) {
+			if (l == i || dzi [l] == 0.0) {
 				continue;
 			}
-			b [i] [j] = - weight -> data [i] [j] * disp -> data [i] [j] / dzij;
-			sum += b [i] [j];
-		}
-		b [i] [i] = - (double) sum;
-	}
-
-	// Guttman transform: Xu = (V+)B(Z)Z (eq. 8.29)
-
-	for (integer i = 1; i <= nPoints; i ++) {
-		for (integer j = 1; j <= nDimensions; j ++) {
-			longdouble xij = 0.0;
-			for (integer k = 1;  k <= nPoints; k ++) {
-				for (integer l = 1; l <= nPoints; l ++) {
-					xij += vplus [i] [k] * b [k] [l] * z [l] [j];
-				}
+			double bil = - wi [l] * di [l] / dzi [l];
+			const double *zl = z [l];
+			for (integer j = 1; j <= nDimensions; j ++) {
+				bzi [j] += bil * (zl [j] - zi [j]);
 			}
-			cx -> data [i] [j] = (double) xij;
 		}
 	}
+
+	double alpha = 1.0, beta = 0.0;
+	NUMblas_dgemm ("N", "N", & nDimensions, & nPoints, & nPoints, & alpha, & bz [1] [1], & nDimensions,
+		& vplus [1] [1], & nPoints, & beta, & cx -> data [1] [1], & nDimensions);
 }
 
 double Distance_Weight_stress (Distance fit, Distance conf, Weight weight, int stressMeasure) {
@@ -1764,89 +1806,110 @@ double Distance_Weight_congruenceCoefficient (Distance x, Distance y, Weight w)
 	return xy / (sqrt (x2) * sqrt (y2));
 }
 
-autoConfiguration Dissimilarity_Configuration_Weight_Transformator_smacof (Dissimilarity me, Configuration conf, Weight weight, Transformator t, double tolerance, integer numberOfIterations, bool showProgress, double *stress) {
-	try {
-		integer nPoints = conf -> numberOfRows;
-		integer nDimensions = conf -> numberOfColumns;
-		double tol = 1e-6, stressp = 1e308, stres = 0.0;
+static void smacof_getVplus (Weight weight, double **vplus) {
+	integer nPoints = weight -> numberOfRows;
+	double **w = weight -> data;
+	autoNUMmatrix<double> v (1, nPoints, 1, nPoints);
 
-		Melder_require (my numberOfRows == nPoints && t -> numberOfPoints == nPoints ||
-			(weight && weight -> numberOfRows == nPoints), U"Dimensions should agree.");
+	// Get V (eq. 8.19).
 
-		autoWeight aw;
-		if (! weight) {
-			aw = Weight_create (nPoints);
-			weight = aw.get();
+	for (integer i = 1; i <= nPoints; i ++) {
+		longdouble wsum = 0.0;
+		for (integer j = 1; j <= nPoints; j ++) {
+			if (i == j) {
+				continue;
+			}
+			v [i] [j] = - w [i] [j];
+			wsum += w [i] [j];
 		}
-		autoNUMmatrix<double> v (1, nPoints, 1, nPoints);
-		autoNUMmatrix<double> vplus (1, nPoints, 1, nPoints);
-		autoConfiguration z = Data_copy (conf);
-		autoMDSVec vec = Dissimilarity_to_MDSVec (me);
+		v [i] [i] = (double) wsum;
+	}
 
-		double **w = weight -> data;
+	/*
+		V is row and column centered and therefore: rank(V) <= nPoints-1.
+		V^-1 does not exist -> get Moore-Penrose inverse.
+	*/
 
-		if (showProgress) {
-			Melder_progress (0.0, U"MDS analysis");
-		}
+	NUMpseudoInverse (v.peek(), nPoints, nPoints, vplus, 1e-6);
+}
 
-		// Get V (eq. 8.19).
+/*
+	The iterations proper. V+ only depends on the weights and can be shared (read-only) by several runs.
+	The MDSVec cannot: the monotone regression reorders its iPoint and jPoint within tie blocks.
+	conf is overwritten.
+*/
+static autoConfiguration smacof (MDSVec vec, Configuration conf, Weight weight, Transformator t, double **vplus, double tolerance, integer numberOfIterations, bool showProgress, double *stress) {
+	integer nPoints = conf -> numberOfRows;
+	integer nDimensions = conf -> numberOfColumns;
+	double stressp = 1e308, stres = 0.0;
 
-		for (integer i = 1; i <= nPoints; i ++) {
-			longdouble wsum = 0.0;
-			for (integer j = 1; j <= nPoints; j ++) {
-				if (i == j) {
-					continue;
-				}
-				v [i] [j] = - w [i] [j];
-				wsum += w [i] [j];
-			}
-			v [i] [i] = (double) wsum;
-		}
+	autoConfiguration z = Data_copy (conf);
+	autoNUMmatrix<double> bz (1, nPoints, 1, nDimensions);
+	autoDistance dist = Configuration_to_Distance (conf);
 
-		/*
-			V is row and column centered and therefore: rank(V) <= nPoints-1.
-			V^-1 does not exist -> get Moore-Penrose inverse.
-		*/
+	for (integer iter = 1; iter <= numberOfIterations; iter ++) {
 
-		NUMpseudoInverse (v.peek(), nPoints, nPoints, vplus.peek(), tol);
-		for (integer iter = 1; iter <= numberOfIterations; iter ++) {
-			autoDistance dist = Configuration_to_Distance (conf);
+		// transform & normalization
 
-			// transform & normalization
+		autoDistance fit = Transformator_transform (t, vec, dist.get(), weight);
 
-			autoDistance fit = Transformator_transform (t, vec.get(), dist.get(), weight);
+		// Make conf the Guttman transform of z (z and conf are equal here, so dist is also the distance of z)
 
-			// Make conf the Guttman transform of z
+		smacof_guttmanTransform (conf, z.get(), dist.get(), fit.get(), weight, vplus, bz.peek());
 
-			smacof_guttmanTransform (conf, z.get(), fit.get(), weight, vplus.peek());
+		// Compute stress
 
-			// Compute stress
+		autoDistance cdist = Configuration_to_Distance (conf);
 
-			autoDistance cdist = Configuration_to_Distance (conf);
+		stres = Distance_Weight_stress (fit.get(), cdist.get(), weight, MDS_NORMALIZED_STRESS);
 
-			stres = Distance_Weight_stress (fit.get(), cdist.get(), weight, MDS_NORMALIZED_STRESS);
+		// Check stop criterium
 
-			// Check stop criterium
+		if (fabs (stres - stressp) / stressp < tolerance) {
+			break;
+		}
 
-			if (fabs (stres - stressp) / stressp < tolerance) {
-				break;
-			}
+		// Make Z = X
+
+		NUMmatrix_copyElements (conf -> data, z -> data, 1, nPoints, 1, nDimensions);
+		dist = cdist.move();
 
-			// Make Z = X
+		stressp = stres;
+		if (showProgress) {
+			Melder_progress ((double) iter / (numberOfIterations + 1), U"kruskal: stress ", stres);
+		}
+	}
+	if (stress) {
+		*stress = stres;
+	}
+	return z;
+}
 
-			NUMmatrix_copyElements (conf -> data, z -> data, 1, nPoints, 1, nDimensions);
+autoConfiguration Dissimilarity_Configuration_Weight_Transformator_smacof (Dissimilarity me, Configuration conf, Weight weight, Transformator t, double tolerance, integer numberOfIterations, bool showProgress, double *stress) {
+	try {
+		integer nPoints = conf -> numberOfRows;
 
-			stressp = stres;
-			if (showProgress) {
-				Melder_progress ((double) iter / (numberOfIterations + 1), U"kruskal: stress ", stres);
-			}
+		Melder_require (my numberOfRows == nPoints && t -> numberOfPoints == nPoints ||
+			(weight && weight -> numberOfRows == nPoints), U"Dimensions should agree.");
+
+		autoWeight aw;
+		if (! weight) {
+			aw = Weight_create (nPoints);
+			weight = aw.get();
+		}
+		autoNUMmatrix<double> vplus (1, nPoints, 1, nPoints);
+		autoMDSVec vec = Dissimilarity_to_MDSVec (me);
+
+		if (showProgress) {
+			Melder_progress (0.0, U"MDS analysis");
 		}
+
+		smacof_getVplus (weight, vplus.peek());
+		autoConfiguration z = smacof (vec.get(), conf, weight, t, vplus.peek(), tolerance, numberOfIterations, showProgress, stress);
+
 		if (showProgress) {
 			Melder_progress (1.0);
 		}
-		if (stress) {
-			*stress = stres;
-		}
 		return z;
 	} catch (MelderError) {
 		if (showProgress) {
@@ -1856,32 +1919,132 @@ autoConfiguration Dissimilarity_Configuration_Weight_Transformator_smacof (Dissi
 	}
 }
 
+Thing_define (MDS_smacof_Args, Thing) { public:
+	Dissimilarity dissimilarity;
+	Weight weight;
+	Transformator transformator;   // each repetition works on its own copy, unless shared
+	bool shareTransformator;
+	double **vplus;
+	ConfigurationList configurations;   // the start configurations, replaced by the results
+	double *stress;
+	double tolerance;
+	integer numberOfIterations, numberOfRepetitions, firstRepetition, lastRepetition;
+	bool isMainThread, showProgress;
+	volatile int *cancelled;
+};
+
+Thing_implement (MDS_smacof_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE MDS_smacof_repetitions (MDS_smacof_Args me) {
+	try {
+		for (integer irep = my firstRepetition; irep <= my lastRepetition; irep ++) {
+			if (*my cancelled) MelderThread_RETURN;
+			autoTransformator copy;
+			Transformator t = my transformator;
+			if (! my shareTransformator) {
+				copy = Transformator_copy (my transformator);
+				t = copy.get();
+			}
+			autoMDSVec vec = Dissimilarity_to_MDSVec (my dissimilarity);
+			Configuration conf = my configurations -> at [irep];
+			autoConfiguration result = smacof (vec.get(), conf, my weight, t, my vplus,
+				my tolerance, my numberOfIterations, false, & my stress [irep]);
+			NUMmatrix_copyElements (result -> data, conf -> data, 1, conf -> numberOfRows, 1, conf -> numberOfColumns);
+			if (my isMainThread && my showProgress) {
+				Melder_progress ((double) (irep - my firstRepetition + 1) / (my lastRepetition - my firstRepetition + 2),
+					irep - my firstRepetition + 1, U" from ", my lastRepetition - my firstRepetition + 1);
+			}
+		}
+	} catch (MelderError) {
+		*my cancelled = 1;
+		if (my isMainThread) throw;
+	}
+	MelderThread_RETURN;
+}
+
+/*
+	The repetitions are independent once their start configurations are known, so these are generated
+	beforehand (the random generator is not thread-safe) and the runs are divided over the threads.
+	The winner is chosen in the order of the repetitions, so the result does not depend on the number of threads.
+	An ISplineTransformator starts each regression from the spline coefficients of the previous one,
+	so its repetitions run one after the other on the transformator itself.
+*/
 autoConfiguration Dissimilarity_Configuration_Weight_Transformator_multiSmacof (Dissimilarity me, Configuration conf,  Weight w, Transformator t, double tolerance, integer numberOfIterations, integer numberOfRepetitions, bool showProgress) {
 	int showMulti = showProgress && numberOfRepetitions > 1;
 	try {
-		bool showSingle = showProgress && numberOfRepetitions == 1;
-		double stress, stressmax = 1e308;
+		if (numberOfRepetitions == 1) {
+			autoConfiguration cstart = Data_copy (conf);
+			return Dissimilarity_Configuration_Weight_Transformator_smacof (me, cstart.get(), w, t, tolerance, numberOfIterations, showProgress, nullptr);
+		}
+		integer nPoints = conf -> numberOfRows;
+		Melder_require (my numberOfRows == nPoints && t -> numberOfPoints == nPoints ||
+			(w && w -> numberOfRows == nPoints), U"Dimensions should agree.");
 
-		autoConfiguration cstart = Data_copy (conf);
-		autoConfiguration  cbest = Data_copy (conf);
+		autoWeight aw;
+		if (! w) {
+			aw = Weight_create (nPoints);
+			w = aw.get();
+		}
+		autoNUMmatrix<double> vplus (1, nPoints, 1, nPoints);
+		smacof_getVplus (w, vplus.peek());
+
+		autoConfigurationList configurations = Thing_new (ConfigurationList);
+		autoNUMvector<double> stress (1, numberOfRepetitions);
+		for (integer irep = 1; irep <= numberOfRepetitions; irep ++) {
+			autoConfiguration cstart = Data_copy (conf);
+			if (irep > 1) {
+				Configuration_randomize (cstart.get());
+				TableOfReal_centreColumns (cstart.get());
+			}
+			configurations -> addItem_move (cstart.move());
+		}
 
 		if (showMulti) {
 			Melder_progress (0.0, U"MDS many times");
 		}
 
-		for (integer i = 1; i <= numberOfRepetitions; i ++) {
-			autoConfiguration cresult = Dissimilarity_Configuration_Weight_Transformator_smacof (me, cstart.get(), w, t, tolerance, numberOfIterations, showSingle, &stress);
-			if (stress < stressmax) {
-				stressmax = stress;
-				cbest = cresult.move();
-			}
-			Configuration_randomize (cstart.get());
-			TableOfReal_centreColumns (cstart.get());
+		bool shareTransformator = Thing_isa (t, classISplineTransformator);
+		int numberOfThreads = shareTransformator ? 1 : MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads > numberOfRepetitions) numberOfThreads = (int) numberOfRepetitions;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		integer numberOfRepetitionsPerThread = (numberOfRepetitions - 1) / numberOfThreads + 1;
+		numberOfThreads = (int) ((numberOfRepetitions - 1) / numberOfRepetitionsPerThread + 1);   // no idle threads
+		autoMDS_smacof_Args args [16];
+		volatile int cancelled = 0;
+		integer firstRepetition = 1;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			autoMDS_smacof_Args arg = Thing_new (MDS_smacof_Args);
+			arg -> dissimilarity = me;
+			arg -> weight = w;
+			arg -> transformator = t;
+			arg -> shareTransformator = shareTransformator;
+			arg -> vplus = vplus.peek();
+			arg -> configurations = configurations.get();
+			arg -> stress = stress.peek();
+			arg -> tolerance = tolerance;
+			arg -> numberOfIterations = numberOfIterations;
+			arg -> numberOfRepetitions = numberOfRepetitions;
+			arg -> firstRepetition = firstRepetition;
+			arg -> lastRepetition = ithread == numberOfThreads ? numberOfRepetitions : firstRepetition + numberOfRepetitionsPerThread - 1;
+			firstRepetition = arg -> lastRepetition + 1;
+			arg -> isMainThread = ( ithread == numberOfThreads );
+			arg -> showProgress = showMulti;
+			arg -> cancelled = & cancelled;
+			args [ithread - 1] = arg.move();
+		}
+		MelderThread_run (MDS_smacof_repetitions, args, numberOfThreads);
+
+		if (cancelled)
+			Melder_throw (U"Analysis interrupted.");
+		integer ibest = 1;
+		for (integer irep = 2; irep <= numberOfRepetitions; irep ++) {
+			if (stress [irep] < stress [ibest]) {
+				ibest = irep;
+			}
+		}
+		autoConfiguration cbest = Data_copy (configurations -> at [ibest]);
 
-			if (showMulti) {
-				Melder_progress ((double) i / (numberOfRepetitions + 1), i, U" from ", numberOfRepetitions);
-			}
-		}
 		if (showMulti) {
 			Melder_progress (1.0);
 		}
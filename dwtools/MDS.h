@@ -182,12 +182,19 @@ Thing_define (Transformator, Thing) {
 	int normalization;
 
 	virtual autoDistance v_transform (MDSVec vec, Distance dist, Weight w);
+	virtual void v_copy (Transformator thee);
 };
 
 void Transformator_init (Transformator me, integer numberOfPoints);
 
 autoTransformator Transformator_create (integer numberOfPoints);
 
+autoTransformator Transformator_copy (Transformator me);
+/*
+	A Transformator is not a Daata, but we need an independent copy of one (including the state of its
+	derived class) when several smacof runs share the same Transformator concurrently.
+*/
+
 void Transformator_setNormalization (Transformator me, int normalization);
 
 autoDistance Transformator_transform (Transformator me, MDSVec vec, Distance dist, Weight w);
@@ -200,6 +207,8 @@ Thing_define (ISplineTransformator, Transformator) {
 		override;
 	autoDistance v_transform (MDSVec vec, Distance dist, Weight w)
 		override;
+	void v_copy (Transformator thee)
+		override;
 };
 
 autoISplineTransformator ISplineTransformator_create (integer numberOfPoints, integer numberOfInteriorKnots, integer order);
@@ -209,6 +218,8 @@ Thing_define (RatioTransformator, Transformator) {
 
 	autoDistance v_transform (MDSVec vec, Distance dist, Weight w)
 		override;
+	void v_copy (Transformator thee)
+		override;
 };
 
 autoRatioTransformator RatioTransformator_create (integer numberOfPoints);
@@ -218,6 +229,8 @@ Thing_define (MonotoneTransformator, Transformator) {
 
 	autoDistance v_transform (MDSVec vec, Distance dist, Weight w)
 		override;
+	void v_copy (Transformator thee)
+		override;
 };
 
 autoMonotoneTransformator MonotoneTransformator_create (integer numberPoints);
@@ -36,6 +36,7 @@
 #include "Eigen_and_SSCP.h"
 #include "Eigen_and_TableOfReal.h"
 #include "Matrix_extensions.h"
+#include "NUMcblas.h"
 #include "NUMlapack.h"
 #include "NUM2.h"
 #include "PCA.h"
@@ -211,6 +212,161 @@ autoPCA TableOfReal_to_PCA_byRows (TableOfReal me) {
 	}
 }
 
+/*
+	Randomized subspace iteration for the first components of a large table (Halko, Martinsson & Tropp 2011).
+	The data are read in blocks of rows, each block is centred, and only p x l matrices are kept
+	(p the number of columns, l the number of components plus oversampling): neither the covariance
+	matrix nor the left singular vectors are ever formed.
+	The l vectors of a basis are the rows of an l x p matrix, which is contiguous in memory, so that
+	NUMblas_dgemm can see it as a column-major p x l matrix.
+	The textbook final step, SVD_create_d on the n x l matrix A Q', is replaced by the eigenstructure
+	of the l x l matrix Q A'A Q', which gives the same singular values and right singular vectors.
+*/
+
+#define PCA_TRUNCATED_BLOCKSIZE  1024
+
+static double NUMrow_norm (double *row, integer numberOfColumns) {
+	longdouble sumsq = 0.0;
+	for (integer k = 1; k <= numberOfColumns; k ++) {
+		sumsq += row [k] * row [k];
+	}
+	return sqrt ((double) sumsq);
+}
+
+static void NUMorthonormalizeRows (double **q, integer numberOfRows, integer numberOfColumns) {
+	/*
+		Modified Gram-Schmidt, twice. A row that is (numerically) in the span of the previous rows
+		is replaced by a random one, so that we always get a basis.
+	*/
+	for (integer i = 1; i <= numberOfRows; i ++) {
+		for (integer itry = 1; itry <= 3; itry ++) {
+			double norm0 = NUMrow_norm (q [i], numberOfColumns);
+			for (integer pass = 1; pass <= 2; pass ++) {
+				for (integer j = 1; j < i; j ++) {
+					double inprod = 0.0;
+					for (integer k = 1; k <= numberOfColumns; k ++) {
+						inprod += q [i] [k] * q [j] [k];
+					}
+					for (integer k = 1; k <= numberOfColumns; k ++) {
+						q [i] [k] -= inprod * q [j] [k];
+					}
+				}
+			}
+			double norm = NUMrow_norm (q [i], numberOfColumns);
+			if (norm > 1e-10 * norm0 && norm > 0.0) {
+				for (integer k = 1; k <= numberOfColumns; k ++) {
+					q [i] [k] /= norm;
+				}
+				break;
+			}
+			for (integer k = 1; k <= numberOfColumns; k ++) {
+				q [i] [k] = NUMrandomGauss (0.0, 1.0);
+			}
+		}
+	}
+}
+
+/*
+	For all rows x (centred) of the table: sum += (x Q') ' (x Q') if square, else sum += x' (x Q').
+	Q is l x p; sum is l x l if square, else l x p.
+*/
+static void TableOfReal_accumulateProjections (TableOfReal me, double *centroid, double **q, integer l, bool square, double **sum) {
+	integer p = my numberOfColumns;
+	integer blockSize = ( my numberOfRows < PCA_TRUNCATED_BLOCKSIZE ? my numberOfRows : PCA_TRUNCATED_BLOCKSIZE );
+	autoNUMmatrix <double> block ((integer) 1, blockSize, (integer) 1, p);
+	autoNUMmatrix <double> projection ((integer) 1, blockSize, (integer) 1, l);
+	double alpha = 1.0, beta0 = 0.0, beta1 = 1.0;
+	for (integer i = 1; i <= l; i ++) {
+		for (integer j = 1; j <= (square ? l : p); j ++) {
+			sum [i] [j] = 0.0;
+		}
+	}
+	for (integer firstRow = 1; firstRow <= my numberOfRows; firstRow += blockSize) {
+		integer b = ( firstRow + blockSize - 1 <= my numberOfRows ? blockSize : my numberOfRows - firstRow + 1 );
+		for (integer irow = 1; irow <= b; irow ++) {
+			for (integer k = 1; k <= p; k ++) {
+				block [irow] [k] = my data [firstRow + irow - 1] [k] - centroid [k];
+			}
+		}
+		/*
+			Row-major b x p is column-major p x b. projection' (l x b) := Q (l x p) block' (p x b).
+		*/
+		NUMblas_dgemm ("T", "N", & l, & b, & p, & alpha, & q [1] [1], & p, & block [1] [1], & p, & beta0, & projection [1] [1], & l);
+		if (square) {
+			NUMblas_dgemm ("N", "T", & l, & l, & b, & alpha, & projection [1] [1], & l, & projection [1] [1], & l, & beta1, & sum [1] [1], & l);
+		} else {
+			NUMblas_dgemm ("N", "T", & p, & l, & b, & alpha, & block [1] [1], & p, & projection [1] [1], & l, & beta1, & sum [1] [1], & p);
+		}
+	}
+}
+
+autoPCA TableOfReal_to_PCA_byRows_truncated (TableOfReal me, integer numberOfComponents, integer oversampling, integer numberOfPowerIterations) {
+	try {
+		integer n = my numberOfRows, p = my numberOfColumns;
+		Melder_require (n > 1,
+			U"The number of rows should be at least 2.");
+		Melder_require (numberOfComponents > 0 && numberOfComponents <= p,
+			U"The number of components should be between 1 and the number of columns (", p, U").");
+		Melder_require (oversampling >= 0 && numberOfPowerIterations >= 0,
+			U"The oversampling and the number of power iterations should not be negative.");
+		Melder_require (! NUMdmatrix_containsUndefinedElements (my data, 1, n, 1, p),
+			U"No matrix elements should be undefined.");
+		integer l = ( numberOfComponents + oversampling < p ? numberOfComponents + oversampling : p );
+
+		autoPCA thee = PCA_create (numberOfComponents, p);
+		for (integer k = 1; k <= p; k ++) {
+			longdouble sum = 0.0;
+			for (integer i = 1; i <= n; i ++) {
+				sum += my data [i] [k];
+			}
+			thy centroid [k] = (double) sum / n;
+		}
+
+		autoNUMmatrix <double> q ((integer) 1, l, (integer) 1, p);
+		for (integer i = 1; i <= l; i ++) {
+			for (integer k = 1; k <= p; k ++) {
+				q [i] [k] = NUMrandomGauss (0.0, 1.0);
+			}
+		}
+		NUMorthonormalizeRows (q.peek(), l, p);
+		/*
+			Q := orth (A'A Q), with A the centred data.
+		*/
+		autoNUMmatrix <double> z ((integer) 1, l, (integer) 1, p);
+		autoMelderProgress progress (U"Truncated PCA");
+		for (integer iter = 0; iter <= numberOfPowerIterations; iter ++) {
+			TableOfReal_accumulateProjections (me, thy centroid, q.peek(), l, false, z.peek());
+			NUMmatrix_copyElements <double> (z.peek(), q.peek(), 1, l, 1, p);
+			NUMorthonormalizeRows (q.peek(), l, p);
+			Melder_progress ((iter + 1.0) / (numberOfPowerIterations + 2), U"Power iteration ", iter, U".");
+		}
+		/*
+			The eigenstructure of the small matrix Q A'A Q' gives that of A'A in the subspace.
+		*/
+		autoNUMmatrix <double> t ((integer) 1, l, (integer) 1, l);
+		TableOfReal_accumulateProjections (me, thy centroid, q.peek(), l, true, t.peek());
+		autoEigen eigen = Thing_new (Eigen);
+		Eigen_initFromSymmetricMatrix (eigen.get(), t.peek(), l);
+
+		for (integer i = 1; i <= numberOfComponents; i ++) {
+			double eigenvalue = eigen -> eigenvalues [i] / (n - 1);
+			thy eigenvalues [i] = ( eigenvalue > 0.0 ? eigenvalue : 0.0 );
+			for (integer k = 1; k <= p; k ++) {
+				longdouble v = 0.0;
+				for (integer j = 1; j <= l; j ++) {
+					v += eigen -> eigenvectors [i] [j] * q [j] [k];
+				}
+				thy eigenvectors [i] [k] = (double) v;
+			}
+		}
+		NUMstrings_copyElements (my columnLabels, thy labels, 1, p);
+		PCA_setNumberOfObservations (thee.get(), n);
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": truncated PCA not created.");
+	}
+}
+
 autoPCA Matrix_to_PCA_byColumns (Matrix me) {
 	try {
 		autoPCA thee = NUMdmatrix_to_PCA (my z, my ny, my nx, true);
@@ -41,6 +41,13 @@ integer PCA_getNumberOfObservations (PCA me);
 
 autoPCA TableOfReal_to_PCA_byRows (TableOfReal me);
 
+autoPCA TableOfReal_to_PCA_byRows_truncated (TableOfReal me, integer numberOfComponents, integer oversampling, integer numberOfPowerIterations);
+/*
+	The first numberOfComponents components only, by randomized subspace iteration with
+	numberOfComponents + oversampling vectors and numberOfPowerIterations extra passes through the data.
+	Memory use does not grow with the number of rows.
+*/
+
 autoEigen PCA_to_Eigen (PCA me);
 
 /* Calculate PCA of M'M */
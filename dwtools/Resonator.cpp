@@ -20,6 +20,8 @@
  * djmw 20081029
  * djmw 20081124 +ConstantGainResonator
  * djmw 20110304 Thing_new
+ * ResonatorBank
+ * Block processing
  */
 
 #include "Resonator.h"
@@ -49,9 +51,16 @@ double structFilter :: v_getOutput (double input) {
 
 Thing_implement (Resonator, Filter, 0);
 
-void structResonator :: v_setFB (double f, double bw) {
+static void Resonator_computeCoefficients (double dT, int normalisation, double f, double bw, double *out_a, double *out_b, double *out_c) {
+	double b, c;
 	SETBC (f, bw)
-	a = normalisation == Resonator_NORMALISATION_H0 ? (1.0 - b - c) : (1 + c) * sin (2.0 * NUMpi * f * dT);
+	*out_a = normalisation == Resonator_NORMALISATION_H0 ? (1.0 - b - c) : (1 + c) * sin (2.0 * NUMpi * f * dT);
+	*out_b = b;
+	*out_c = c;
+}
+
+void structResonator :: v_setFB (double f, double bw) {
+	Resonator_computeCoefficients (dT, normalisation, f, bw, & a, & b, & c);
 }
 
 autoResonator Resonator_create (double dT, int normalisation) {
@@ -68,17 +77,24 @@ autoResonator Resonator_create (double dT, int normalisation) {
 
 Thing_implement (AntiResonator, Filter, 0);
 
-void structAntiResonator :: v_setFB (double f, double bw) {
+static void AntiResonator_computeCoefficients (double dT, double f, double bw, double *out_a, double *out_b, double *out_c) {
 	if (f <= 0 && bw <= 0) {
-		a = 1; b = -2; c = 1; // all-pass except dc
+		*out_a = 1; *out_b = -2; *out_c = 1; // all-pass except dc
 	} else {
+		double b, c;
 		SETBC (f, bw)
-		a = 1 / (1.0 - b - c);
+		*out_a = 1 / (1.0 - b - c);
+		*out_b = b;
+		*out_c = c;
 		// The next equations are incorporated in the getOutput function
 		//c *= - a; b *= - a;
 	}
 }
 
+void structAntiResonator :: v_setFB (double f, double bw) {
+	AntiResonator_computeCoefficients (dT, f, bw, & a, & b, & c);
+}
+
 /* y[n] = a * (x[n] - b * x[n-1] - c * x[n-2]) */
 double structAntiResonator :: v_getOutput (double input) {
 	double output = a * (input - b * p1 - c * p2);
@@ -143,4 +159,313 @@ void Filter_resetMemory (Filter me) {
 	my v_resetMemory ();
 }
 
+/********** Block processing **********/
+
+#define Filter_KIND_RESONATOR  0
+#define Filter_KIND_ANTIRESONATOR  1
+#define Filter_KIND_CONSTANTGAINRESONATOR  2
+
+/*
+	A copy of the coefficients and the memory of a Filter.
+	As a local variable it can live in registers while a block of samples is processed;
+	the memory is written back to the Filter afterwards.
+*/
+struct FilterSection {
+	int kind;
+	double a, b, c, d;
+	double p1, p2, p3, p4;
+};
+
+static void FilterSection_init (FilterSection *me, Filter filter) {
+	my kind = Thing_isa (filter, classAntiResonator) ? Filter_KIND_ANTIRESONATOR :
+		Thing_isa (filter, classConstantGainResonator) ? Filter_KIND_CONSTANTGAINRESONATOR : Filter_KIND_RESONATOR;
+	my a = filter -> a;
+	my b = filter -> b;
+	my c = filter -> c;
+	my p1 = filter -> p1;
+	my p2 = filter -> p2;
+	if (my kind == Filter_KIND_CONSTANTGAINRESONATOR) {
+		ConstantGainResonator cgr = static_cast <ConstantGainResonator> (filter);
+		my d = cgr -> d;
+		my p3 = cgr -> p3;
+		my p4 = cgr -> p4;
+	} else {
+		my d = my p3 = my p4 = 0.0;
+	}
+}
+
+static void FilterSection_saveMemory (FilterSection *me, Filter filter) {
+	filter -> p1 = my p1;
+	filter -> p2 = my p2;
+	if (my kind == Filter_KIND_CONSTANTGAINRESONATOR) {
+		ConstantGainResonator cgr = static_cast <ConstantGainResonator> (filter);
+		cgr -> p3 = my p3;
+		cgr -> p4 = my p4;
+	}
+}
+
+/*
+	The same equations as in the v_getOutput methods, with the coefficients as arguments.
+*/
+template <int kind>
+static inline double FilterSection_getOutput (FilterSection *me, double input, double a, double b, double c, double d) {
+	double output;
+	if (kind == Filter_KIND_ANTIRESONATOR) {
+		output = a * (input - b * my p1 - c * my p2);
+		my p2 = my p1;
+		my p1 = input;
+	} else if (kind == Filter_KIND_CONSTANTGAINRESONATOR) {
+		output = a * (input + d * my p4) + b * my p1 + c * my p2;
+		my p2 = my p1;
+		my p1 = output;
+		my p4 = my p3;
+		my p3 = input;
+	} else {
+		output = a * input + b * my p1 + c * my p2;
+		my p2 = my p1;
+		my p1 = output;
+	}
+	return output;
+}
+
+static inline double FilterSection_getOutput (FilterSection *me, double input) {
+	switch (my kind) {
+		case Filter_KIND_ANTIRESONATOR:
+			return FilterSection_getOutput <Filter_KIND_ANTIRESONATOR> (me, input, my a, my b, my c, my d);
+		case Filter_KIND_CONSTANTGAINRESONATOR:
+			return FilterSection_getOutput <Filter_KIND_CONSTANTGAINRESONATOR> (me, input, my a, my b, my c, my d);
+		default:
+			return FilterSection_getOutput <Filter_KIND_RESONATOR> (me, input, my a, my b, my c, my d);
+	}
+}
+
+template <int kind>
+static void Filter_filterBlock (Filter me, double *x, integer n) {
+	FilterSection section;
+	FilterSection_init (& section, me);
+	for (integer i = 1; i <= n; i ++)
+		x [i] = FilterSection_getOutput <kind> (& section, x [i], section.a, section.b, section.c, section.d);
+	FilterSection_saveMemory (& section, me);
+}
+
+void structFilter :: v_filter (double *x, integer n) {
+	Filter_filterBlock <Filter_KIND_RESONATOR> (this, x, n);
+}
+
+void structAntiResonator :: v_filter (double *x, integer n) {
+	Filter_filterBlock <Filter_KIND_ANTIRESONATOR> (this, x, n);
+}
+
+void structConstantGainResonator :: v_filter (double *x, integer n) {
+	Filter_filterBlock <Filter_KIND_CONSTANTGAINRESONATOR> (this, x, n);
+}
+
+void Filter_filter (Filter me, double *x, integer n) {
+	if (n < 1) return;
+	my v_filter (x, n);
+}
+
+void Filters_filterCascade (Filter *filters, integer numberOfFilters, double *x, integer n) {
+	if (n < 1 || numberOfFilters < 1) return;
+	autoNUMvector <FilterSection> sections (1, numberOfFilters);
+	for (integer k = 1; k <= numberOfFilters; k ++)
+		FilterSection_init (& sections [k], filters [k]);
+	for (integer i = 1; i <= n; i ++) {
+		double sample = x [i];
+		for (integer k = 1; k <= numberOfFilters; k ++)
+			sample = FilterSection_getOutput (& sections [k], sample);
+		x [i] = sample;
+	}
+	for (integer k = 1; k <= numberOfFilters; k ++)
+		FilterSection_saveMemory (& sections [k], filters [k]);
+}
+
+void Filters_filterParallel (Filter *filters, integer numberOfFilters, const double *x, double **y, integer n) {
+	if (n < 1 || numberOfFilters < 1) return;
+	autoNUMvector <FilterSection> sections (1, numberOfFilters);
+	for (integer k = 1; k <= numberOfFilters; k ++)
+		FilterSection_init (& sections [k], filters [k]);
+	for (integer i = 1; i <= n; i ++) {
+		double input = x [i];
+		for (integer k = 1; k <= numberOfFilters; k ++)
+			y [k] [i] = FilterSection_getOutput (& sections [k], input);
+	}
+	for (integer k = 1; k <= numberOfFilters; k ++)
+		FilterSection_saveMemory (& sections [k], filters [k]);
+}
+
+/********** ResonatorBank **********/
+
+Thing_implement (ResonatorBank, Thing, 0);
+
+void structResonatorBank :: v_destroy () noexcept {
+	NUMvector_free (a, 1);
+	NUMvector_free (b, 1);
+	NUMvector_free (c, 1);
+	NUMvector_free (p1, 1);
+	NUMvector_free (p2, 1);
+	ResonatorBank_Parent :: v_destroy ();
+}
+
+autoResonatorBank ResonatorBank_create (int kind, double dT, integer numberOfLanes) {
+	try {
+		autoResonatorBank me = Thing_new (ResonatorBank);
+		my kind = kind;
+		my dT = dT;
+		my numberOfLanes = numberOfLanes;
+		my a = NUMvector <double> (1, numberOfLanes);
+		my b = NUMvector <double> (1, numberOfLanes);
+		my c = NUMvector <double> (1, numberOfLanes);
+		my p1 = NUMvector <double> (1, numberOfLanes);
+		my p2 = NUMvector <double> (1, numberOfLanes);
+		for (integer lane = 1; lane <= numberOfLanes; lane ++) {
+			my a [lane] = 1.0; // all-pass
+		}
+		return me;
+	} catch (MelderError) {
+		Melder_throw (U"ResonatorBank not created.");
+	}
+}
+
+/*
+	Compute the coefficients for frequency f and bandwidth bw;
+	return false if the previous coefficients have to be kept.
+*/
+static bool ResonatorBank_computeCoefficients (ResonatorBank me, double f, double bw, double *out_a, double *out_b, double *out_c) {
+	if (my kind == ResonatorBank_ALLPOLE) {
+		if (isundef (f) || isundef (bw)) {
+			*out_a = 1.0; *out_b = 0.0; *out_c = 0.0;   // pass unfiltered
+			return true;
+		}
+		double cosomdt = cos (2 * NUMpi * f * my dT);
+		double r = exp (- NUMpi * bw * my dT);
+		*out_a = 1.0;
+		/* Formants at 0 Hz or the Nyquist are single poles, others are double poles. */
+		if (fabs (cosomdt) > 0.999999) {   // allow for round-off errors
+			*out_b = r;
+			*out_c = 0.0;
+		} else {
+			*out_b = 2 * r * cosomdt;
+			*out_c = - (r * r);
+		}
+		return true;
+	}
+	if (! (f <= 0.5 / my dT && isdefined (bw)))
+		return false;
+	if (my kind == ResonatorBank_ANTIRESONATOR)
+		AntiResonator_computeCoefficients (my dT, f, bw, out_a, out_b, out_c);
+	else
+		Resonator_computeCoefficients (my dT, my kind == ResonatorBank_RESONATOR_H0 ? Resonator_NORMALISATION_H0 : Resonator_NORMALISATION_HMAX,
+			f, bw, out_a, out_b, out_c);
+	return true;
+}
+
+void ResonatorBank_setCoefficients (ResonatorBank me, integer lane, double a, double b, double c) {
+	my a [lane] = a;
+	my b [lane] = b;
+	my c [lane] = c;
+}
+
+void ResonatorBank_resetMemory (ResonatorBank me) {
+	for (integer lane = 1; lane <= my numberOfLanes; lane ++) {
+		my p1 [lane] = my p2 [lane] = 0.0;
+	}
+}
+
+void ResonatorBank_filter (ResonatorBank me, double **x, integer n,
+	double **frequencies, double **bandwidths, double **gains, integer blockSize)
+{
+	integer numberOfLanes = my numberOfLanes;
+	if (blockSize < 1) blockSize = 1;
+	if (! frequencies || ! bandwidths) blockSize = n;   // constant coefficients
+	if (blockSize > n) blockSize = n;
+	if (n < 1 || numberOfLanes < 1) return;
+	/*
+		A single lane is filtered in place; with more lanes, the samples are interleaved per block.
+	*/
+	bool interleave = ( numberOfLanes > 1 );
+	autoNUMvector <double> buffer;   // interleaved: [(sample - 1) * numberOfLanes + (lane - 1)]
+	if (interleave)
+		buffer.reset ((integer) 0, blockSize * numberOfLanes - 1);
+	autoNUMvector <double> a0 (1, numberOfLanes), b0 (1, numberOfLanes), c0 (1, numberOfLanes);
+	autoNUMvector <double> da (1, numberOfLanes), db (1, numberOfLanes), dc (1, numberOfLanes);
+	double *a = my a, *b = my b, *c = my c, *p1 = my p1, *p2 = my p2;
+	bool anti = ( my kind == ResonatorBank_ANTIRESONATOR );
+	for (integer ifirst = 1; ifirst <= n; ifirst += blockSize) {
+		integer ilast = ifirst + blockSize - 1;
+		if (ilast > n) ilast = n;
+		integer numberOfSamples = ilast - ifirst + 1;
+		/*
+			The coefficients at the end of the block.
+		*/
+		for (integer lane = 1; lane <= numberOfLanes; lane ++) {
+			a0 [lane] = a [lane], b0 [lane] = b [lane], c0 [lane] = c [lane];
+			if (frequencies && bandwidths) {
+				double ta, tb, tc;
+				if (ResonatorBank_computeCoefficients (me, frequencies [lane] [ilast], bandwidths [lane] [ilast], & ta, & tb, & tc)) {
+					if (gains && isdefined (gains [lane] [ilast]))
+						ta *= gains [lane] [ilast];
+					a [lane] = ta, b [lane] = tb, c [lane] = tc;
+				}
+			}
+			da [lane] = (a [lane] - a0 [lane]) / numberOfSamples;
+			db [lane] = (b [lane] - b0 [lane]) / numberOfSamples;
+			dc [lane] = (c [lane] - c0 [lane]) / numberOfSamples;
+		}
+		if (interleave) {
+			for (integer lane = 1; lane <= numberOfLanes; lane ++) {
+				const double *from = & x [lane] [ifirst];
+				for (integer isamp = 0; isamp < numberOfSamples; isamp ++)
+					buffer [isamp * numberOfLanes + lane - 1] = from [isamp];
+			}
+		}
+		for (integer isamp = 1; isamp <= numberOfSamples; isamp ++) {
+			double *sample = ( interleave ? & buffer [(isamp - 1) * numberOfLanes] : & x [1] [ifirst + isamp - 1] ) - 1;   // base 1
+			if (isamp == numberOfSamples) {
+				/*
+					Exactly the target coefficients, so that a blockSize of 1 is exact.
+				*/
+				if (anti) {
+					for (integer lane = 1; lane <= numberOfLanes; lane ++) {
+						double input = sample [lane];
+						sample [lane] = a [lane] * (input - b [lane] * p1 [lane] - c [lane] * p2 [lane]);
+						p2 [lane] = p1 [lane];
+						p1 [lane] = input;
+					}
+				} else {
+					for (integer lane = 1; lane <= numberOfLanes; lane ++) {
+						double output = a [lane] * sample [lane] + b [lane] * p1 [lane] + c [lane] * p2 [lane];
+						p2 [lane] = p1 [lane];
+						p1 [lane] = sample [lane] = output;
+					}
+				}
+			} else {
+				if (anti) {
+					for (integer lane = 1; lane <= numberOfLanes; lane ++) {
+						double input = sample [lane];
+						double ai = a0 [lane] + isamp * da [lane], bi = b0 [lane] + isamp * db [lane], ci = c0 [lane] + isamp * dc [lane];
+						sample [lane] = ai * (input - bi * p1 [lane] - ci * p2 [lane]);
+						p2 [lane] = p1 [lane];
+						p1 [lane] = input;
+					}
+				} else {
+					for (integer lane = 1; lane <= numberOfLanes; lane ++) {
+						double ai = a0 [lane] + isamp * da [lane], bi = b0 [lane] + isamp * db [lane], ci = c0 [lane] + isamp * dc [lane];
+						double output = ai * sample [lane] + bi * p1 [lane] + ci * p2 [lane];
+						p2 [lane] = p1 [lane];
+						p1 [lane] = sample [lane] = output;
+					}
+				}
+			}
+		}
+		if (interleave) {
+			for (integer lane = 1; lane <= numberOfLanes; lane ++) {
+				double *to = & x [lane] [ifirst];
+				for (integer isamp = 0; isamp < numberOfSamples; isamp ++)
+					to [isamp] = buffer [isamp * numberOfLanes + lane - 1];
+			}
+		}
+	}
+}
+
 /* End of file Resonator.cpp */
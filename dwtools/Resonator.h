@@ -33,6 +33,7 @@ Thing_define (Filter, Daata) {
 	virtual double v_getOutput (double input);
 	virtual void v_setFB (double f, double b);
 	virtual void v_resetMemory ();
+	virtual void v_filter (double *x, integer n);
 };
 
 Thing_define (Resonator, Filter) {
@@ -47,6 +48,8 @@ Thing_define (AntiResonator, Resonator) {
 		override;
 	void v_setFB (double f, double b)
 		override;
+	void v_filter (double *x, integer n)
+		override;
 };
 
 Thing_define (ConstantGainResonator, Filter) {
@@ -59,6 +62,8 @@ Thing_define (ConstantGainResonator, Filter) {
 		override;
 	void v_resetMemory ()
 		override;
+	void v_filter (double *x, integer n)
+		override;
 };
 
 #define Resonator_NORMALISATION_H0 0
@@ -82,5 +87,81 @@ double Filter_getOutput (Filter me, double input);
 
 void Filter_resetMemory (Filter me);
 
+/*
+	Block processing: the results are identical to those of calling Filter_getOutput for every sample,
+	but there is only one virtual call per block and the memory of the filter stays in registers.
+*/
+
+/*
+	Filter x [1..n] in place.
+*/
+void Filter_filter (Filter me, double *x, integer n);
+
+/*
+	Filter x [1..n] in place through filters [1..numberOfFilters], one after the other.
+	The filters are run in lockstep, sample by sample, so that their recursions overlap.
+*/
+void Filters_filterCascade (Filter *filters, integer numberOfFilters, double *x, integer n);
+
+/*
+	Filter x [1..n] through each of filters [1..numberOfFilters]; the output of filter k goes to y [k] [1..n].
+*/
+void Filters_filterParallel (Filter *filters, integer numberOfFilters, const double *x, double **y, integer n);
+
+/*
+	A ResonatorBank runs a number of independent second-order filters ("lanes") in lockstep.
+	The lanes can be the channels of a Sound that all go through the same formant,
+	or the formants of a parallel synthesizer that all receive the same source.
+	Because the lanes are interleaved per block of samples, the inner loop runs over the lanes
+	and can be vectorized by the compiler; a bank with a single lane filters in place.
+
+	The coefficients can follow frequency and bandwidth trajectories. They are computed at the end of every
+	block of blockSize samples and are interpolated linearly within the block; a blockSize of 1 gives
+	the exact per-sample behaviour of a Resonator or AntiResonator.
+*/
+
+#define ResonatorBank_RESONATOR_H0  0
+#define ResonatorBank_RESONATOR_HMAX  1
+#define ResonatorBank_ANTIRESONATOR  2
+#define ResonatorBank_ALLPOLE  3
+	/*
+		The resonator and antiresonator kinds behave like Resonator_create (dT, Resonator_NORMALISATION_H0),
+		Resonator_create (dT, Resonator_NORMALISATION_HMAX) and AntiResonator_create (dT):
+		where the frequency is above the Nyquist frequency or the bandwidth is undefined,
+		the previous coefficients are kept.
+		The all-pole kind is the section y [n] = x [n] + b * y [n-1] + c * y [n-2] of formant filtering,
+		with a single pole at 0 Hz and the Nyquist frequency;
+		where the formant or the bandwidth is undefined, the signal passes unfiltered.
+	*/
+
+Thing_define (ResonatorBank, Thing) {
+	int kind;
+	double dT;
+	integer numberOfLanes;
+	double *a, *b, *c, *p1, *p2;   // [1..numberOfLanes]
+
+	void v_destroy () noexcept
+		override;
+};
+
+autoResonatorBank ResonatorBank_create (int kind, double dT, integer numberOfLanes);
+
+/*
+	Set the coefficients of the lane directly:
+	y [n] = a * x [n] + b * y [n-1] + c * y [n-2] for the resonator and all-pole kinds,
+	y [n] = a * (x [n] - b * x [n-1] - c * x [n-2]) for the antiresonator kind.
+*/
+void ResonatorBank_setCoefficients (ResonatorBank me, integer lane, double a, double b, double c);
+
+void ResonatorBank_resetMemory (ResonatorBank me);
+
+/*
+	Filter x [lane] [1..n] in place, for all lanes.
+	frequencies, bandwidths: [lane] [1..n], or null if the coefficients are to stay as they are.
+	gains: [lane] [1..n], multiplying the input wherever the coefficients are updated and the gain is defined; may be null.
+*/
+void ResonatorBank_filter (ResonatorBank me, double **x, integer n,
+	double **frequencies, double **bandwidths, double **gains, integer blockSize);
+
 #endif /* _Resonator_h_ */
 
@@ -31,6 +31,7 @@
 #include "Sound_to_Pitch.h"
 #include "Vector.h"
 #include "NUM2.h"
+#include "MelderThread.h"
 
 #define MIN(m,n) ((m) < (n) ? (m) : (n))
 // prototypes
@@ -87,8 +88,46 @@ static autoSpectrum Sound_to_Spectrum_power (Sound me) {
 	}
 }
 
-static void Sound_into_BarkSpectrogram_frame (Sound me, BarkSpectrogram thee, integer frame) {
-	autoSpectrum him = Sound_to_Spectrum_power (me);
+/*
+	The weights of a bank of band filters applied to a power spectrum.
+	Filter i only looks at the frequency bins first [i] .. last [i], so the product is sparse for triangular filters.
+	The weights depend only on the frequency sampling of the spectrum and on the filter positions,
+	so we can compute them once for all frames of an analysis; they are freed when the analysis finishes.
+*/
+Thing_define (BandFilterWeights, Thing) {
+	integer numberOfFilters;
+	integer *first, *last;   // [1..numberOfFilters]
+	double **weights;   // [1..numberOfFilters] [first..last]
+
+	void v_destroy () noexcept
+		override;
+};
+
+Thing_implement (BandFilterWeights, Thing, 0);
+
+void structBandFilterWeights :: v_destroy () noexcept {
+	if (weights) {
+		for (integer ifilter = 1; ifilter <= numberOfFilters; ifilter ++) {
+			NUMvector_free (weights [ifilter], first [ifilter]);
+		}
+	}
+	NUMvector_free (weights, 1);
+	NUMvector_free (first, 1);
+	NUMvector_free (last, 1);
+	BandFilterWeights_Parent :: v_destroy ();
+}
+
+static autoBandFilterWeights BandFilterWeights_create (integer numberOfFilters) {
+	autoBandFilterWeights me = Thing_new (BandFilterWeights);
+	my numberOfFilters = numberOfFilters;
+	my first = NUMvector <integer> (1, my numberOfFilters);
+	my last = NUMvector <integer> (1, my numberOfFilters);
+	my weights = NUMvector <double *> (1, my numberOfFilters);
+	return me;
+}
+
+static autoBandFilterWeights BarkSpectrogram_Spectrum_to_BandFilterWeights (BarkSpectrogram thee, Spectrum him) {
+	autoBandFilterWeights me = BandFilterWeights_create (thy ny);
 	integer numberOfFrequencies = his nx;
 	autoNUMvector<double> z (1, numberOfFrequencies);
 
@@ -98,19 +137,201 @@ static void Sound_into_BarkSpectrogram_frame (Sound me, BarkSpectrogram thee, in
 	}
 
 	for (integer i = 1; i <= thy ny; i ++) {
-		double p = 0;
 		double z0 = thy y1 + (i - 1) * thy dy;
-		double *pow = his z [1]; // TODO ??
+		my first [i] = 1;
+		my last [i] = numberOfFrequencies;
+		my weights [i] = NUMvector <double> (1, numberOfFrequencies);
 		for (integer ifreq = 1; ifreq <= numberOfFrequencies; ifreq ++) {
 			// Sekey & Hanson filter is defined in the power domain.
 			// We therefore multiply the power with a (and not a^2).
 			// integral (F(z),z=0..25) = 1.58/9
 
-			double a = NUMsekeyhansonfilter_amplitude (z0, z [ifreq]);
-			p += a * pow [ifreq] ;
+			my weights [i] [ifreq] = NUMsekeyhansonfilter_amplitude (z0, z [ifreq]);
+		}
+	}
+	return me;
+}
+
+static autoBandFilterWeights MelSpectrogram_Spectrum_to_BandFilterWeights (MelSpectrogram thee, Spectrum him) {
+	autoBandFilterWeights me = BandFilterWeights_create (thy ny);
+	for (integer ifilter = 1; ifilter <= thy ny; ifilter ++) {
+		double fc_mel = thy y1 + (ifilter - 1) * thy dy;
+		double fc_hz = thy v_frequencyToHertz (fc_mel);
+		double fl_hz = thy v_frequencyToHertz (fc_mel - thy dy);
+		double fh_hz =  thy v_frequencyToHertz (fc_mel + thy dy);
+		integer ifrom, ito;
+		Sampled_getWindowSamples (him, fl_hz, fh_hz, & ifrom, & ito);
+		if (ito < ifrom) {   // no bins: a single bin with zero weight
+			my first [ifilter] = my last [ifilter] = 1;
+			my weights [ifilter] = NUMvector <double> (1, 1);
+			continue;
+		}
+		my first [ifilter] = ifrom;
+		my last [ifilter] = ito;
+		my weights [ifilter] = NUMvector <double> (ifrom, ito);
+		for (integer i = ifrom; i <= ito; i ++) {
+			// Bin with a triangular filter the power (= amplitude-squared)
+
+			double f = his x1 + (i - 1) * his dx;
+			my weights [ifilter] [i] = NUMtriangularfilter_amplitude (fl_hz, fc_hz, fh_hz, f);
 		}
-		thy z [i] [frame] = p;
 	}
+	return me;
+}
+
+/*
+	Put the power spectrum of the frame into power [1..numberOfFrequencies],
+	with the same scaling as Sound_to_Spectrum_power (), but with a Fourier table that is reused for all frames.
+	data [1..fourierTable -> n] is a work array.
+*/
+static void Sound_into_powerSpectrum (Sound me, NUMfft_Table fourierTable, double *data, double *power) {
+	integer numberOfSamples = fourierTable -> n, numberOfFrequencies = numberOfSamples / 2 + 1;
+	Melder_assert (my ny == 1 && numberOfSamples >= my nx && numberOfSamples % 2 == 0);
+	for (integer i = 1; i <= my nx; i ++) {
+		data [i] = my z [1] [i];
+	}
+	for (integer i = my nx + 1; i <= numberOfSamples; i ++) {
+		data [i] = 0.0;
+	}
+	NUMfft_forward (fourierTable, data);
+	double scaling = my dx;
+	double scale = 2.0 * (1.0 / (my dx * numberOfSamples)) / (my xmax - my xmin);
+	double re = data [1] * scaling;
+	power [1] = scale * (re * re + 0.0 * 0.0);
+	for (integer i = 2; i < numberOfFrequencies; i ++) {
+		re = data [i + i - 2] * scaling;
+		double im = data [i + i - 1] * scaling;
+		power [i] = scale * (re * re + im * im);
+	}
+	re = data [numberOfSamples] * scaling;
+	power [numberOfFrequencies] = scale * (re * re + 0.0 * 0.0);
+
+	// Correction of frequency bins at 0 Hz and nyquist: don't count for two.
+
+	power [1] *= 0.5; power [numberOfFrequencies] *= 0.5;
+}
+
+/*
+	The frames of a filter-bank analysis are independent, so we distribute them over threads.
+	Each thread has its own frame, Fourier table and work arrays.
+*/
+Thing_define (Sound_into_BandFilters_Args, Thing) { public:
+	Sound sound, window;
+	Matrix thee;   // the filter bank output, [filter] [frame]
+	BandFilterWeights filterWeights;   // or null, if the filters depend on the frame
+	double *bandwidths;   // [1..numberOfFrames], for formant filters without filterWeights
+	double windowDuration;
+	integer firstFrame, lastFrame;
+	autoSound sframe;
+	autoNUMfft_Table fourierTable;
+	double *data, *power;
+	bool isMainThread;
+	volatile int *cancelled;
+
+	void v_destroy () noexcept
+		override;
+};
+
+Thing_implement (Sound_into_BandFilters_Args, Thing, 0);
+
+void structSound_into_BandFilters_Args :: v_destroy () noexcept {
+	NUMvector_free (data, 1);
+	NUMvector_free (power, 1);
+	Sound_into_BandFilters_Args_Parent :: v_destroy ();
+}
+
+static MelderThread_RETURN_TYPE Sound_into_BandFilters (Sound_into_BandFilters_Args me) {
+	try {
+		Matrix thee = my thee;
+		integer numberOfFrequencies = my fourierTable.n / 2 + 1;
+		double df = 1.0 / (my sframe -> dx * my fourierTable.n);
+		for (integer iframe = my firstFrame; iframe <= my lastFrame; iframe ++) {
+			if (*my cancelled) MelderThread_RETURN;
+			double t = Sampled_indexToX (thee, iframe);
+			Sound_into_Sound (my sound, my sframe.get(), t - my windowDuration / 2.0);
+			Sounds_multiply (my sframe.get(), my window);
+			Sound_into_powerSpectrum (my sframe.get(), & my fourierTable, my data, my power);
+			if (my filterWeights) {
+				BandFilterWeights weights = my filterWeights;
+				for (integer ifilter = 1; ifilter <= thy ny; ifilter ++) {
+					double p = 0.0;
+					const double *w = weights -> weights [ifilter];
+					for (integer ifreq = weights -> first [ifilter]; ifreq <= weights -> last [ifilter]; ifreq ++) {
+						p += w [ifreq] * my power [ifreq];
+					}
+					thy z [ifilter] [iframe] = p;
+				}
+			} else {
+				/*
+					Analog formant filter response :
+					H(f) = i f B / (f1^2 - f^2 + i f B)
+				*/
+				double bw = my bandwidths [iframe];
+				Melder_assert (bw > 0);
+				for (integer ifilter = 1; ifilter <= thy ny; ifilter ++) {
+					double p = 0;
+					double fc = thy y1 + (ifilter - 1) * thy dy;
+					for (integer ifreq = 1; ifreq <= numberOfFrequencies; ifreq ++) {
+						/*
+							H(f) = ifB / (fc^2 - f^2 + ifB)
+							H(f)| = fB / sqrt ((fc^2 - f^2)^2 + f^2B^2)
+							|H(f)|^2 = f^2B^2 / ((fc^2 - f^2) /fB)^2 + 1)
+						*/
+						double f = (ifreq - 1) * df;
+						double a = NUMformantfilter_amplitude (fc, bw, f);
+						p += a * my power [ifreq];
+					}
+					thy z [ifilter] [iframe] = p;
+				}
+			}
+			if (my isMainThread && (iframe - my firstFrame) % 10 == 0) {
+				Melder_progress ((double) (iframe - my firstFrame + 1) / (my lastFrame - my firstFrame + 1),
+					U"Frame ", iframe - my firstFrame + 1, U" out of ", my lastFrame - my firstFrame + 1, U".");
+			}
+		}
+	} catch (MelderError) {
+		*my cancelled = 1;
+		if (my isMainThread) throw;
+	}
+	MelderThread_RETURN;
+}
+
+static void Sound_into_BandFilters_threaded (Sound me, Matrix thee, integer numberOfFrames, double windowDuration,
+	BandFilterWeights filterWeights, double *bandwidths, Sound window)
+{
+	double samplingFrequency = 1.0 / my dx;
+	int numberOfThreads = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads > numberOfFrames / 20) numberOfThreads = (int) (numberOfFrames / 20);
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	integer numberOfFramesPerThread = (numberOfFrames - 1) / numberOfThreads + 1;
+	autoSound_into_BandFilters_Args args [16];
+	volatile int cancelled = 0;
+	integer firstFrame = 1;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoSound_into_BandFilters_Args arg = Thing_new (Sound_into_BandFilters_Args);
+		arg -> sound = me;
+		arg -> window = window;
+		arg -> thee = thee;
+		arg -> filterWeights = filterWeights;
+		arg -> bandwidths = bandwidths;
+		arg -> windowDuration = windowDuration;
+		arg -> firstFrame = firstFrame;
+		arg -> lastFrame = ithread == numberOfThreads ? numberOfFrames : firstFrame + numberOfFramesPerThread - 1;
+		firstFrame = arg -> lastFrame + 1;
+		arg -> sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
+		integer numberOfSamples = 2;
+		while (numberOfSamples < arg -> sframe -> nx) numberOfSamples *= 2;
+		NUMfft_Table_init (& arg -> fourierTable, numberOfSamples);
+		arg -> data = NUMvector <double> (1, numberOfSamples);
+		arg -> power = NUMvector <double> (1, numberOfSamples / 2 + 1);
+		arg -> isMainThread = ( ithread == numberOfThreads );
+		arg -> cancelled = & cancelled;
+		args [ithread - 1] = arg.move();
+	}
+	MelderThread_run (Sound_into_BandFilters, args, numberOfThreads);
+	if (cancelled)
+		Melder_throw (U"Analysis interrupted.");
 }
 
 autoBarkSpectrogram Sound_to_BarkSpectrogram (Sound me, double analysisWidth, double dt, double f1_bark, double fmax_bark, double df_bark) {
@@ -144,21 +365,12 @@ autoBarkSpectrogram Sound_to_BarkSpectrogram (Sound me, double analysisWidth, do
 		autoSound sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
 		autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
 		autoBarkSpectrogram thee = BarkSpectrogram_create (my xmin, my xmax, numberOfFrames, dt, t1, fmin_bark, fmax_bark, numberOfFilters, df_bark, f1_bark);
+		autoSpectrum spectrum = Sound_to_Spectrum_power (sframe.get());
+		autoBandFilterWeights filterWeights = BarkSpectrogram_Spectrum_to_BandFilterWeights (thee.get(), spectrum.get());
 
 		autoMelderProgress progess (U"BarkSpectrogram analysis");
 
-		for (integer iframe = 1; iframe <= numberOfFrames; iframe ++) {
-			double t = Sampled_indexToX (thee.get(), iframe);
-
-			Sound_into_Sound (me, sframe.get(), t - windowDuration / 2.0);
-			Sounds_multiply (sframe.get(), window.get());
-			Sound_into_BarkSpectrogram_frame (sframe.get(), thee.get(), iframe);
-
-			if (iframe % 10 == 1) {
-				Melder_progress ( (double) iframe / numberOfFrames,  U"BarkSpectrogram analysis: frame ",
-					iframe, U" from ", numberOfFrames, U".");
-			}
-		}
+		Sound_into_BandFilters_threaded (me, thee.get(), numberOfFrames, windowDuration, filterWeights.get(), nullptr, window.get());
 		
 		_Spectrogram_windowCorrection ((Spectrogram) thee.get(), window -> nx);
 
@@ -168,28 +380,6 @@ autoBarkSpectrogram Sound_to_BarkSpectrogram (Sound me, double analysisWidth, do
 	}
 }
 
-static void Sound_into_MelSpectrogram_frame (Sound me, MelSpectrogram thee, integer frame) {
-	autoSpectrum him = Sound_to_Spectrum_power (me);
-
-	for (integer ifilter = 1; ifilter <= thy ny; ifilter ++) {
-		double power = 0;
-		double fc_mel = thy y1 + (ifilter - 1) * thy dy;
-		double fc_hz = thy v_frequencyToHertz (fc_mel);
-		double fl_hz = thy v_frequencyToHertz (fc_mel - thy dy);
-		double fh_hz =  thy v_frequencyToHertz (fc_mel + thy dy);
-		integer ifrom, ito;
-		Sampled_getWindowSamples (him.get(), fl_hz, fh_hz, & ifrom, & ito);
-		for (integer i = ifrom; i <= ito; i ++) {
-			// Bin with a triangular filter the power (= amplitude-squared)
-
-			double f = his x1 + (i - 1) * his dx;
-			double a = NUMtriangularfilter_amplitude (fl_hz, fc_hz, fh_hz, f);
-			power += a * his z [1] [i];
-		}
-		thy z [ifilter] [frame] = power;
-	}
-}
-
 autoMelSpectrogram Sound_to_MelSpectrogram (Sound me, double analysisWidth, double dt, double f1_mel, double fmax_mel, double df_mel) {
 	try {
 		double samplingFrequency = 1.0 / my dx, nyquist = 0.5 * samplingFrequency;
@@ -223,19 +413,12 @@ autoMelSpectrogram Sound_to_MelSpectrogram (Sound me, double analysisWidth, doub
 		autoSound sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
 		autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
 		autoMelSpectrogram thee = MelSpectrogram_create (my xmin, my xmax, numberOfFrames, dt, t1, fmin_mel, fmax_mel, numberOfFilters, df_mel, f1_mel);
+		autoSpectrum spectrum = Sound_to_Spectrum_power (sframe.get());
+		autoBandFilterWeights filterWeights = MelSpectrogram_Spectrum_to_BandFilterWeights (thee.get(), spectrum.get());
 
 		autoMelderProgress progress (U"MelSpectrograms analysis");
 
-		for (integer iframe = 1; iframe <= numberOfFrames; iframe ++) {
-			double t = Sampled_indexToX (thee.get(), iframe);
-			Sound_into_Sound (me, sframe.get(), t - windowDuration / 2.0);
-			Sounds_multiply (sframe.get(), window.get());
-			Sound_into_MelSpectrogram_frame (sframe.get(), thee.get(), iframe);
-			
-			if (iframe % 10 == 1) {
-				Melder_progress ((double) iframe / numberOfFrames, U"Frame ", iframe, U" out of ", numberOfFrames, U".");
-			}
-		}
+		Sound_into_BandFilters_threaded (me, thee.get(), numberOfFrames, windowDuration, filterWeights.get(), nullptr, window.get());
 		
 		_Spectrogram_windowCorrection ((Spectrogram) thee.get(), window -> nx);
 
@@ -245,34 +428,6 @@ autoMelSpectrogram Sound_to_MelSpectrogram (Sound me, double analysisWidth, doub
 	}
 }
 
-/*
-	Analog formant filter response :
-	H(f) = i f B / (f1^2 - f^2 + i f B)
-*/
-static int Sound_into_Spectrogram_frame (Sound me, Spectrogram thee, integer frame, double bw) {
-	Melder_assert (bw > 0);
-	autoSpectrum him = Sound_to_Spectrum_power (me);
-
-	for (integer ifilter = 1; ifilter <= thy ny; ifilter ++) {
-		double p = 0;
-		double fc = thy y1 + (ifilter - 1) * thy dy;
-		double *pow = his z [1];
-		for (integer ifreq = 1; ifreq <= his nx; ifreq ++) {
-			/*
-				H(f) = ifB / (fc^2 - f^2 + ifB)
-				H(f)| = fB / sqrt ((fc^2 - f^2)^2 + f^2B^2)
-				|H(f)|^2 = f^2B^2 / ((fc^2 - f^2)^2 + f^2B^2)
-						 = 1 / (((fc^2 - f^2) /fB)^2 + 1)
-			*/
-			double f = his x1 + (ifreq - 1) * his dx;
-			double a = NUMformantfilter_amplitude (fc, bw, f);
-			p += a * pow [ifreq];
-		}
-		thy z [ifilter] [frame] = p;
-	}
-	return 1;
-}
-
 autoSpectrogram Sound_to_Spectrogram_pitchDependent (Sound me, double analysisWidth, double dt, double f1_hz, double fmax_hz, double df_hz, double relative_bw, double minimumPitch, double maximumPitch) {
 	try {
 		double floor = 80.0, ceiling = 600.0;
@@ -332,28 +487,20 @@ autoSpectrogram Sound_Pitch_to_Spectrogram (Sound me, Pitch thee, double analysi
 
 		// Temporary objects
 
-		autoSound sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
 		autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
-		autoMelderProgress progress (U"Sound & Pitch: To FormantFilter");
+		autoNUMvector <double> bandwidths (1, numberOfFrames);
 		for (integer iframe = 1; iframe <= numberOfFrames; iframe ++) {
 			double t = Sampled_indexToX (him.get(), iframe);
-			double b, f0 = Pitch_getValueAtTime (thee, t, kPitch_unit::HERTZ, 0);
+			double f0 = Pitch_getValueAtTime (thee, t, kPitch_unit::HERTZ, 0);
 
 			if (isundef (f0) || f0 == 0.0) {
 				numberOfUndefinedPitchFrames ++;
 				f0 = f0_median;
 			}
-			b = relative_bw * f0;
-			Sound_into_Sound (me, sframe.get(), t - windowDuration / 2.0);
-			Sounds_multiply (sframe.get(), window.get());
-
-			Sound_into_Spectrogram_frame (sframe.get(), him.get(), iframe, b);
-
-			if (iframe % 10 == 1) {
-				Melder_progress ((double) iframe / numberOfFrames, U"Frame ", iframe, U" out of ",
-					numberOfFrames, U".");
-			}
+			bandwidths [iframe] = relative_bw * f0;
 		}
+		autoMelderProgress progress (U"Sound & Pitch: To FormantFilter");
+		Sound_into_BandFilters_threaded (me, him.get(), numberOfFrames, windowDuration, nullptr, bandwidths.peek(), window.get());
 		
 		_Spectrogram_windowCorrection (him.get(), window -> nx);
 
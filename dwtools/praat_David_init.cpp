@@ -459,11 +459,50 @@ FORM (NEW1_CCs_to_DTW, U"CC: To DTW", U"CC: To DTW...") {
 	OK
 DO
 	CONVERT_COUPLE (CC)
-		autoDTW result = CCs_to_DTW (me, you, cepstralWeight, logEnergyWeight, regressionWeight, regressionLogEnergyWeight, regressionWindowLength);
+		autoDTW result = CCs_to_DTW (me, you, cepstralWeight, logEnergyWeight, regressionWeight, regressionLogEnergyWeight, regressionWindowLength, 0.0, slopeConstraint);
 		DTW_findPath (result.get(), matchStart, matchEnd, slopeConstraint);
 	CONVERT_COUPLE_END (my name, U"_", your name);
 }
 
+FORM (NEW1_CCs_to_DTW_band, U"CC: To DTW (band)", U"CC: To DTW...") {
+	LABEL (U"Distance  between cepstral coefficients")
+	REAL (cepstralWeight, U"Cepstral weight", U"1.0")
+	REAL (logEnergyWeight, U"Log energy weight", U"0.0")
+	REAL (regressionWeight, U"Regression weight", U"0.0")
+	REAL (regressionLogEnergyWeight, U"Regression log energy weight", U"0.0")
+	REAL (regressionWindowLength, U"Regression window length (s)", U"0.056")
+	REAL (sakoeChibaBand, U"Sakoe-Chiba band (s)", U"0.1")
+	DTW_constraints_addCommonFields (matchStart, matchEnd, slopeConstraint)
+	OK
+DO
+	CONVERT_COUPLE (CC)
+		autoDTW result = CCs_to_DTW (me, you, cepstralWeight, logEnergyWeight, regressionWeight, regressionLogEnergyWeight, regressionWindowLength, sakoeChibaBand, slopeConstraint);
+		DTW_findPath (result.get(), matchStart, matchEnd, slopeConstraint);
+	CONVERT_COUPLE_END (my name, U"_", your name);
+}
+
+FORM (NEW1_CCs_to_Distance_dtw, U"CCs: To Distance (dtw)", U"CC: To DTW...") {
+	LABEL (U"Distance  between cepstral coefficients")
+	REAL (cepstralWeight, U"Cepstral weight", U"1.0")
+	REAL (logEnergyWeight, U"Log energy weight", U"0.0")
+	REAL (regressionWeight, U"Regression weight", U"0.0")
+	REAL (regressionLogEnergyWeight, U"Regression log energy weight", U"0.0")
+	REAL (regressionWindowLength, U"Regression window length (s)", U"0.056")
+	REAL (sakoeChibaBand, U"Sakoe-Chiba band (s)", U"0.1")
+	RADIO (slopeConstraint, U"Slope constraint", 1)
+		RADIOBUTTON (U"no restriction")
+		RADIOBUTTON (U"1/3 < slope < 3")
+		RADIOBUTTON (U"1/2 < slope < 2")
+		RADIOBUTTON (U"2/3 < slope < 3/2")
+	REAL (maximumDistance, U"Maximum distance (0 = no limit)", U"0.0")
+	OK
+DO
+	Melder_require (maximumDistance >= 0.0, U"The maximum distance should not be negative.");
+	CONVERT_LIST (CC)
+		autoDistance result = CCs_to_Distance_dtw (& list, cepstralWeight, logEnergyWeight, regressionWeight, regressionLogEnergyWeight, regressionWindowLength, sakoeChibaBand, slopeConstraint, maximumDistance);
+	CONVERT_LIST_END (U"dtw")
+}
+
 DIRECT (NEW_CC_to_Matrix) {
 	CONVERT_EACH (CC)
 		autoMatrix result = CC_to_Matrix (me);
@@ -1796,7 +1835,7 @@ DO
 		if ((xTime >= my xmin && xTime <= my xmax) && (yTime >= my ymin && yTime <= my ymax)) {
 			integer irow = Matrix_yToNearestRow (me, yTime);
 			integer icol = Matrix_xToNearestColumn (me, xTime);
-			result = my z[irow][icol];
+			result = DTW_getDistance (me, irow, icol);
 		}
 	NUMBER_ONE_END (U" (= distance at (", xTime, U", ", yTime, U"))")
 }
@@ -1804,14 +1843,14 @@ DO
 DIRECT (REAL_DTW_getMinimumDistance) {
 	NUMBER_ONE (DTW)
 		double result, maximum;
-		Matrix_getWindowExtrema (me, 0, 0, 0, 0, & result, & maximum);
+		DTW_getWindowExtrema (me, 0, 0, 0, 0, & result, & maximum);
 	NUMBER_ONE_END (U" (minimum)")
 }
 
 DIRECT (REAL_DTW_getMaximumDistance) {
 	NUMBER_ONE (DTW)
 		double minimum, result;
-		Matrix_getWindowExtrema (me, 0, 0, 0, 0, & minimum, & result);
+		DTW_getWindowExtrema (me, 0, 0, 0, 0, & minimum, & result);
 	NUMBER_ONE_END (U" (maximum)")
 }
 
@@ -1823,6 +1862,7 @@ FORM (MODIFY_DTW_formula_distances, U"DTW: Formula (distances)", nullptr) {
 DO
 	LOOP {
 		iam (DTW);
+		Melder_require (! DTW_isBanded (me), U"A formula cannot be applied to the distances of a banded DTW.");
 		autoMatrix cp = DTW_to_Matrix_distances (me);
 		try {
 			Matrix_formula (me, formula, interpreter, 0);
@@ -1858,7 +1898,8 @@ DO
 		}
 		integer irow = Matrix_yToNearestRow (me, yTime);
 		integer icol = Matrix_xToNearestColumn (me, xTime);
-		my z[irow][icol] = newDistance;
+		Melder_require (DTW_isInBand (me, irow, icol), U"The distance at these times is outside the Sakoe-Chiba band.");
+		DTW_setDistance (me, irow, icol, newDistance);
 	MODIFY_EACH_END
 }
 
@@ -1925,6 +1966,12 @@ DIRECT (NEW_DTW_swapAxes) {
 	CONVERT_EACH_END (my name, U"_axesSwapped")
 }
 
+DIRECT (MODIFY_DTW_expandBand) {
+	MODIFY_EACH (DTW)
+		DTW_expandBand (me);
+	MODIFY_EACH_END
+}
+
 DIRECT (MODIFY_DTW_Matrix_replace) {
 	MODIFY_FIRST_OF_TWO (DTW, Matrix)
 		DTW_Matrix_replace (me, you);
@@ -3558,7 +3605,19 @@ FORM (NEW1_Matrices_to_DTW, U"Matrices: To DTW", U"Matrix: To DTW...") {
 	OK
 DO
 	CONVERT_COUPLE (Matrix)
-		autoDTW result = Matrices_to_DTW (me, you, matchStart, matchEnd, slopeConstraint, distanceMetric);
+		autoDTW result = Matrices_to_DTW (me, you, matchStart, matchEnd, slopeConstraint, distanceMetric, 0.0);
+	CONVERT_COUPLE_END (my name, U"_", your name)
+}
+
+FORM (NEW1_Matrices_to_DTW_band, U"Matrices: To DTW (band)", U"Matrix: To DTW...") {
+	LABEL (U"Distance  between cepstral coefficients")
+	REAL (distanceMetric, U"Distance metric", U"2.0")
+	REAL (sakoeChibaBand, U"Sakoe-Chiba band (s)", U"0.1")
+	DTW_constraints_addCommonFields (matchStart, matchEnd, slopeConstraint)
+	OK
+DO
+	CONVERT_COUPLE (Matrix)
+		autoDTW result = Matrices_to_DTW (me, you, matchStart, matchEnd, slopeConstraint, distanceMetric, sakoeChibaBand);
 	CONVERT_COUPLE_END (my name, U"_", your name)
 }
 
@@ -5571,7 +5630,17 @@ FORM (NEW1_Spectrograms_to_DTW, U"Spectrograms: To DTW", nullptr) {
 	OK
 DO
 	CONVERT_COUPLE (Spectrogram)
-		autoDTW result = Spectrograms_to_DTW (me, you, matchStart, matchEnd, slopeConstraint, 1.0);
+		autoDTW result = Spectrograms_to_DTW (me, you, matchStart, matchEnd, slopeConstraint, 1.0, 0.0);
+	CONVERT_COUPLE_END (my name, U"_", your name)
+}
+
+FORM (NEW1_Spectrograms_to_DTW_band, U"Spectrograms: To DTW (band)", nullptr) {
+	REAL (sakoeChibaBand, U"Sakoe-Chiba band (s)", U"0.1")
+	DTW_constraints_addCommonFields (matchStart, matchEnd, slopeConstraint)
+	OK
+DO
+	CONVERT_COUPLE (Spectrogram)
+		autoDTW result = Spectrograms_to_DTW (me, you, matchStart, matchEnd, slopeConstraint, 1.0, sakoeChibaBand);
 	CONVERT_COUPLE_END (my name, U"_", your name)
 }
 
@@ -7018,6 +7087,17 @@ DIRECT (NEW_TableOfReal_to_PCA_byRows) {
 	CONVERT_EACH_END (my name)
 }
 
+FORM (NEW_TableOfReal_to_PCA_byRows_truncated, U"TableOfReal: To PCA (truncated)", U"TableOfReal: To PCA...") {
+	NATURAL (numberOfComponents, U"Number of components", U"20")
+	INTEGER (oversampling, U"Oversampling", U"10")
+	INTEGER (numberOfPowerIterations, U"Number of power iterations", U"2")
+	OK
+DO
+	CONVERT_EACH (TableOfReal)
+		autoPCA result = TableOfReal_to_PCA_byRows_truncated (me, numberOfComponents, oversampling, numberOfPowerIterations);
+	CONVERT_EACH_END (my name)
+}
+
 FORM (NEW_TableOfReal_to_SSCP, U"TableOfReal: To SSCP", U"TableOfReal: To SSCP...") {
 	INTEGER (fromRow, U"Begin row", U"0")
 	INTEGER (toRow, U"End row", U"0")
@@ -7296,6 +7376,8 @@ void praat_CC_init (ClassInfo klas) {
 	praat_addAction1 (klas, 1, U"Get value...", nullptr, praat_HIDDEN + praat_DEPTH_1, REAL_CC_getValue);
 	praat_addAction1 (klas, 0, U"To Matrix", nullptr, 0, NEW_CC_to_Matrix);
 	praat_addAction1 (klas, 2, U"To DTW...", nullptr, 0, NEW1_CCs_to_DTW);
+	praat_addAction1 (klas, 2, U"To DTW (band)...", nullptr, 0, NEW1_CCs_to_DTW_band);
+	praat_addAction1 (klas, 0, U"To Distance (dtw)...", nullptr, 0, NEW1_CCs_to_Distance_dtw);
 }
 
 static void praat_Eigen_Matrix_project (ClassInfo klase, ClassInfo klasm); // deprecated 2014
@@ -7832,6 +7914,7 @@ void praat_uvafon_David_init () {
 	praat_addAction1 (classDTW, 0, MODIFY_BUTTON, nullptr, 0, 0);
 	praat_addAction1 (classDTW, 0, U"Formula (distances)...", nullptr, 1, MODIFY_DTW_formula_distances);
 	praat_addAction1 (classDTW, 0, U"Set distance value...", nullptr, 1, MODIFY_DTW_setDistanceValue);
+	praat_addAction1 (classDTW, 0, U"Expand Sakoe-Chiba band", nullptr, 1, MODIFY_DTW_expandBand);
 
 	praat_addAction1 (classDTW, 0, U"Analyse", nullptr, 0, 0);
     praat_addAction1 (classDTW, 0, U"Find path...", nullptr, praat_HIDDEN, MODIFY_DTW_findPath);
@@ -8000,6 +8083,7 @@ void praat_uvafon_David_init () {
 	praat_addAction1 (classMatrix, 0, U"To ActivationList", U"To PatternList...", 1, NEW_Matrix_to_ActivationList);
 	praat_addAction1 (classMatrix, 0, U"To Activation", U"*To ActivationList", praat_DEPRECATED_2016, NEW_Matrix_to_ActivationList);
 	praat_addAction1 (classMatrix, 2, U"To DTW...", U"To ParamCurve", 1, NEW1_Matrices_to_DTW);
+	praat_addAction1 (classMatrix, 2, U"To DTW (band)...", U"To DTW...", 1, NEW1_Matrices_to_DTW_band);
 
 	praat_addAction2 (classMatrix, 1, classCategories, 1, U"To TableOfReal", nullptr, 0, NEW1_Matrix_Categories_to_TableOfReal);
 
@@ -8222,6 +8306,7 @@ void praat_uvafon_David_init () {
 	praat_addAction2 (classSound, 1, classIntervalTier, 1, U"Cut parts matching label...", nullptr, 0, NEW1_Sound_IntervalTier_cutPartsMatchingLabel);
 
 	praat_addAction1 (classSpectrogram, 2, U"To DTW...", U"To Spectrum (slice)...", 1, NEW1_Spectrograms_to_DTW);
+	praat_addAction1 (classSpectrogram, 2, U"To DTW (band)...", U"To DTW...", 1, NEW1_Spectrograms_to_DTW_band);
 
 	praat_addAction1 (classSpectrum, 0, U"Draw phases...", U"Draw (log freq)...", praat_DEPTH_1 | praat_HIDDEN, GRAPHICS_Spectrum_drawPhases);
 	praat_addAction1 (classSpectrum, 0, U"Set real value in bin...", U"Formula...", praat_HIDDEN | praat_DEPTH_1, MODIFY_Spectrum_setRealValueInBin);
@@ -8333,6 +8418,7 @@ void praat_uvafon_David_init () {
 	praat_addAction1 (classTableOfReal, 0, U"Multivariate statistics -", nullptr, 0, 0);
 	praat_addAction1 (classTableOfReal, 0, U"To Discriminant", nullptr, 1, NEW_TableOfReal_to_Discriminant);
 	praat_addAction1 (classTableOfReal, 0, U"To PCA", nullptr, 1, NEW_TableOfReal_to_PCA_byRows);
+	praat_addAction1 (classTableOfReal, 0, U"To PCA (truncated)...", nullptr, 1, NEW_TableOfReal_to_PCA_byRows_truncated);
 	praat_addAction1 (classTableOfReal, 0, U"To SSCP...", nullptr, 1, NEW_TableOfReal_to_SSCP);
 	praat_addAction1 (classTableOfReal, 0, U"To Covariance", nullptr, 1, NEW_TableOfReal_to_Covariance);
 	praat_addAction1 (classTableOfReal, 0, U"To Correlation", nullptr, 1, NEW_TableOfReal_to_Correlation);
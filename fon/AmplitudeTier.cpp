@@ -81,9 +81,10 @@ autoTableOfReal AmplitudeTier_downto_TableOfReal (AmplitudeTier me) {
 
 void Sound_AmplitudeTier_multiply_inplace (Sound me, AmplitudeTier amplitude) {
 	if (amplitude -> points.size == 0) return;
+	integer lowIndex = 0;
 	for (integer isamp = 1; isamp <= my nx; isamp ++) {
 		double t = my x1 + (isamp - 1) * my dx;
-		double factor = RealTier_getValueAtTime (amplitude, t);
+		double factor = RealTier_getValueAtTime_continued (amplitude, t, & lowIndex);
 		for (integer channel = 1; channel <= my ny; channel ++) {
 			my z [channel] [isamp] *= factor;
 		}
@@ -19,6 +19,7 @@
 #include "FormantGrid.h"
 #include "PitchTier_to_Sound.h"
 #include "Formula.h"
+#include "Resonator.h"
 
 #include "oo_DESTROY.h"
 #include "FormantGrid_def.h"
@@ -157,39 +158,24 @@ void FormantGrid_removeBandwidthPointsBetween (FormantGrid me, integer iformant,
 }
 
 void Sound_FormantGrid_filter_inplace (Sound me, FormantGrid formantGrid) {
-	double dt = my dx;
 	if (formantGrid -> formants.size > 0 && formantGrid -> bandwidths.size > 0) {
+		/*
+			All channels go through the same formants, so they can be filtered in lockstep.
+		*/
+		autoResonatorBank bank = ResonatorBank_create (ResonatorBank_ALLPOLE, my dx, my ny);
+		autoNUMvector <double> formant (1, my nx), bandwidth (1, my nx);
+		autoNUMvector <double *> formants (1, my ny), bandwidths (1, my ny);
+		for (integer channel = 1; channel <= my ny; channel ++) {
+			formants [channel] = formant.peek();
+			bandwidths [channel] = bandwidth.peek();
+		}
 		for (integer iformant = 1; iformant <= formantGrid -> formants.size; iformant ++) {
 			RealTier formantTier = formantGrid -> formants.at [iformant];
 			RealTier bandwidthTier = formantGrid -> bandwidths.at [iformant];
-			for (integer isamp = 1; isamp <= my nx; isamp ++) {
-				double t = my x1 + (isamp - 1) * my dx;
-				/*
-				 * Compute LP coefficients.
-				 */
-				double formant, bandwidth;
-				formant = RealTier_getValueAtTime (formantTier, t);
-				bandwidth = RealTier_getValueAtTime (bandwidthTier, t);
-				if (isdefined (formant) && isdefined (bandwidth)) {
-					double cosomdt = cos (2 * NUMpi * formant * dt);
-					double r = exp (- NUMpi * bandwidth * dt);
-					/* Formants at 0 Hz or the Nyquist are single poles, others are double poles. */
-					if (fabs (cosomdt) > 0.999999) {   /* Allow for round-off errors. */
-						/* single pole: D(z) = 1 - r z^-1 */
-						for (integer channel = 1; channel <= my ny; channel ++) {
-							if (isamp > 1) my z [channel] [isamp] += r * my z [channel] [isamp - 1];
-						}
-					} else {
-						/* double pole: D(z) = 1 + p z^-1 + q z^-2 */
-						double p = - 2 * r * cosomdt;
-						double q = r * r;
-						for (integer channel = 1; channel <= my ny; channel ++) {
-							if (isamp > 1) my z [channel] [isamp] -= p * my z [channel] [isamp - 1];
-							if (isamp > 2) my z [channel] [isamp] -= q * my z [channel] [isamp - 2];
-						}
-					}
-				}
-			}
+			RealTier_getValuesAtSampleTimes (formantTier, my x1, my dx, my nx, formant.peek());
+			RealTier_getValuesAtSampleTimes (bandwidthTier, my x1, my dx, my nx, bandwidth.peek());
+			ResonatorBank_resetMemory (bank.get());
+			ResonatorBank_filter (bank.get(), my z, my nx, formants.peek(), bandwidths.peek(), nullptr, 1);
 		}
 	}
 }
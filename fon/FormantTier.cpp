@@ -28,6 +28,7 @@
 
 #include "FormantTier.h"
 #include "AnyTier.h"
+#include "Resonator.h"
 
 #include "oo_DESTROY.h"
 #include "FormantTier_def.h"
@@ -253,35 +254,25 @@ autoTableOfReal FormantTier_downto_TableOfReal (FormantTier me, int includeForma
 }
 
 void Sound_FormantTier_filter_inplace (Sound me, FormantTier formantTier) {
-	double dt = my dx;
-	if (formantTier -> points.size) for (integer iformant = 1; iformant <= 10; iformant ++) {
-		for (integer isamp = 1; isamp <= my nx; isamp ++) {
-			double t = my x1 + (isamp - 1) * my dx;
-			/*
-			 * Compute LP coefficients.
-			 */
-			double formant, bandwidth;
-			formant = FormantTier_getValueAtTime (formantTier, iformant, t);
-			bandwidth = FormantTier_getBandwidthAtTime (formantTier, iformant, t);
-			if (isdefined (formant) && isdefined (bandwidth)) {
-				double cosomdt = cos (2 * NUMpi * formant * dt);
-				double r = exp (- NUMpi * bandwidth * dt);
-				/* Formants at 0 Hz or the Nyquist are single poles, others are double poles. */
-				if (fabs (cosomdt) > 0.999999) {   // allow for round-off errors
-					/* single pole: D(z) = 1 - r z^-1 */
-					for (integer channel = 1; channel <= my ny; channel ++) {
-						if (isamp > 1) my z [channel] [isamp] += r * my z [channel] [isamp - 1];
-					}
-				} else {
-					/* double pole: D(z) = 1 + p z^-1 + q z^-2 */
-					double p = - 2 * r * cosomdt;
-					double q = r * r;
-					for (integer channel = 1; channel <= my ny; channel ++) {
-						if (isamp > 1) my z [channel] [isamp] -= p * my z [channel] [isamp - 1];
-						if (isamp > 2) my z [channel] [isamp] -= q * my z [channel] [isamp - 2];
-					}
-				}
+	if (formantTier -> points.size) {
+		/*
+			All channels go through the same formants, so they can be filtered in lockstep.
+		*/
+		autoResonatorBank bank = ResonatorBank_create (ResonatorBank_ALLPOLE, my dx, my ny);
+		autoNUMvector <double> formant (1, my nx), bandwidth (1, my nx);
+		autoNUMvector <double *> formants (1, my ny), bandwidths (1, my ny);
+		for (integer channel = 1; channel <= my ny; channel ++) {
+			formants [channel] = formant.peek();
+			bandwidths [channel] = bandwidth.peek();
+		}
+		for (integer iformant = 1; iformant <= 10; iformant ++) {
+			for (integer isamp = 1; isamp <= my nx; isamp ++) {
+				double t = my x1 + (isamp - 1) * my dx;
+				formant [isamp] = FormantTier_getValueAtTime (formantTier, iformant, t);
+				bandwidth [isamp] = FormantTier_getBandwidthAtTime (formantTier, iformant, t);
 			}
+			ResonatorBank_resetMemory (bank.get());
+			ResonatorBank_filter (bank.get(), my z, my nx, formants.peek(), bandwidths.peek(), nullptr, 1);
 		}
 	}
 }
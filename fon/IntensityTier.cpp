@@ -86,10 +86,10 @@ autoIntensityTier IntensityTier_PointProcess_to_IntensityTier (IntensityTier me,
 	try {
 		if (my points.size == 0) Melder_throw (U"No intensity points.");
 		autoIntensityTier thee = IntensityTier_create (pp -> xmin, pp -> xmax);
+		autoNUMvector <double> values (1, pp -> nt);
+		RealTier_getValuesAtTimes (me, pp -> t, pp -> nt, values.peek());
 		for (integer i = 1; i <= pp -> nt; i ++) {
-			double time = pp -> t [i];
-			double value = RealTier_getValueAtTime (me, time);
-			RealTier_addPoint (thee.get(), time, value);
+			RealTier_addPoint (thee.get(), pp -> t [i], values [i]);
 		}
 		return thee;
 	} catch (MelderError) {
@@ -103,9 +103,10 @@ autoTableOfReal IntensityTier_downto_TableOfReal (IntensityTier me) {
 
 void Sound_IntensityTier_multiply_inplace (Sound me, IntensityTier intensity) {
 	if (intensity -> points.size == 0) return;
+	integer lowIndex = 0;
 	for (integer isamp = 1; isamp <= my nx; isamp ++) {
 		double t = my x1 + (isamp - 1) * my dx;
-		double factor = pow (10, RealTier_getValueAtTime (intensity, t) / 20);
+		double factor = pow (10, RealTier_getValueAtTime_continued (intensity, t, & lowIndex) / 20);
 		for (integer channel = 1; channel <= my ny; channel ++) {
 			my z [channel] [isamp] *= factor;
 		}
@@ -24,6 +24,8 @@
 #include "Pitch_to_PointProcess.h"
 #include "PointProcess_and_Sound.h"
 #include "Sound_and_LPC.h"
+#include "TextGrid_Sound.h"
+#include "MelderThread.h"
 
 #define MAX_T  0.02000000001   /* Maximum interval between two voice pulses (otherwise voiceless). */
 
@@ -200,44 +202,96 @@ static integer PointProcess_getFirstVoicedPoint (PointProcess me, double maxT) {
 	return 0;
 }
 
-static void copyRise (Sound me, double tmin, double tmax, Sound thee, double tmaxTarget) {
+/*
+	Overlap-add is done in two passes.
+	The first pass decides, in order, which windowed stretches of the source go where in the target;
+	this pass has to be sequential, because it draws random numbers and integrates the duration tier.
+	The second pass performs the copies. It divides the target into time blocks that do not influence each other,
+	so that these blocks can be handled by separate threads;
+	within each block, the copies are performed in the order of the first pass,
+	so that the result does not depend on the number of threads.
+*/
+
+#define OverlapAdd_RISE  1
+#define OverlapAdd_FALL  2
+#define OverlapAdd_FLAT  3
+
+struct OverlapAddCopy {
+	integer isourceMin, isourceMax;   // the stretch of source samples
+	integer distance;   // the target index minus the source index
+	int shape;   // OverlapAdd_RISE, OverlapAdd_FALL or OverlapAdd_FLAT
+};
+
+/*
+	Several overlap-adds can run simultaneously (see Sounds_PitchTiers_DurationTiers_to_Sounds_overlapAdd),
+	so memory allocation in the plan and window tables is protected by a mutex, as in Sound_to_Pitch.
+*/
+MelderThread_MUTEX (overlapAddMutex);
+static bool overlapAddMutex_inited;
+
+struct OverlapAddPlan {
+	OverlapAddCopy *copies;
+	integer numberOfCopies, capacity;
+	integer maximumLength;   // of the windowed (rise and fall) copies only
+	OverlapAddPlan () : copies (nullptr), numberOfCopies (0), capacity (0), maximumLength (0) { }
+	~OverlapAddPlan () {
+		if (copies) {
+			MelderThread_LOCK (overlapAddMutex);
+			NUMvector_free (copies, 1);
+			MelderThread_UNLOCK (overlapAddMutex);
+		}
+	}
+	void append (integer isourceMin, integer isourceMax, integer distance, int shape) {
+		if (numberOfCopies == capacity) {
+			integer newCapacity = 2 * capacity + 1000;
+			MelderThread_LOCK (overlapAddMutex);
+			OverlapAddCopy *newCopies = NUMvector <OverlapAddCopy> (1, newCapacity, false);
+			if (copies) {
+				NUMvector_copyElements (copies, newCopies, 1, numberOfCopies);
+				NUMvector_free (copies, 1);
+			}
+			MelderThread_UNLOCK (overlapAddMutex);
+			copies = newCopies;
+			capacity = newCapacity;
+		}
+		OverlapAddCopy *copy = & copies [++ numberOfCopies];
+		copy -> isourceMin = isourceMin;
+		copy -> isourceMax = isourceMax;
+		copy -> distance = distance;
+		copy -> shape = shape;
+		if (shape != OverlapAdd_FLAT) {   // flat copies need no window, and can be as long as a voiceless stretch
+			integer length = isourceMax - isourceMin + 1;
+			if (length > maximumLength) maximumLength = length;
+		}
+	}
+};
+
+static void copyRise (OverlapAddPlan *plan, Sound me, double tmin, double tmax, Sound thee, double tmaxTarget) {
 	integer imin = Sampled_xToHighIndex (me, tmin);
 	if (imin < 1) imin = 1;
 	integer imax = Sampled_xToHighIndex (me, tmax) - 1;   // not xToLowIndex: ensure separation of subsequent calls
 	if (imax > my nx) imax = my nx;
 	if (imax < imin) return;
 	integer imaxTarget = Sampled_xToHighIndex (thee, tmaxTarget) - 1;
-	integer distance = imaxTarget - imax;
-	double dphase = NUMpi / (imax - imin + 1);
-	for (integer i = imin; i <= imax; i ++) {
-		integer iTarget = i + distance;
-		if (iTarget >= 1 && iTarget <= thy nx)
-			thy z [1] [iTarget] += my z [1] [i] * 0.5 * (1.0 - cos (dphase * (i - imin + 0.5)));
-	}
+	plan -> append (imin, imax, imaxTarget - imax, OverlapAdd_RISE);
 }
 
-static void copyFall (Sound me, double tmin, double tmax, Sound thee, double tminTarget) {
+static void copyFall (OverlapAddPlan *plan, Sound me, double tmin, double tmax, Sound thee, double tminTarget) {
 	integer imin = Sampled_xToHighIndex (me, tmin);
 	if (imin < 1) imin = 1;
 	integer imax = Sampled_xToHighIndex (me, tmax) - 1;   // not xToLowIndex: ensure separation of subsequent calls
 	if (imax > my nx) imax = my nx;
 	if (imax < imin) return;
 	integer iminTarget = Sampled_xToHighIndex (thee, tminTarget);
-	integer distance = iminTarget - imin;
-	double dphase = NUMpi / (imax - imin + 1);
-	for (integer i = imin; i <= imax; i ++) {
-		integer iTarget = i + distance;
-		if (iTarget >= 1 && iTarget <= thy nx)
-			thy z [1] [iTarget] += my z [1] [i] * 0.5 * (1.0 + cos (dphase * (i - imin + 0.5)));
-	}
+	plan -> append (imin, imax, iminTarget - imin, OverlapAdd_FALL);
 }
 
-static void copyBell (Sound me, double tmid, double leftWidth, double rightWidth, Sound thee, double tmidTarget) {
-	copyRise (me, tmid - leftWidth, tmid, thee, tmidTarget);
-	copyFall (me, tmid, tmid + rightWidth, thee, tmidTarget);
+static void copyBell (OverlapAddPlan *plan, Sound me, double tmid, double leftWidth, double rightWidth, Sound thee, double tmidTarget) {
+	copyRise (plan, me, tmid - leftWidth, tmid, thee, tmidTarget);
+	copyFall (plan, me, tmid, tmid + rightWidth, thee, tmidTarget);
 }
 
-static void copyBell2 (Sound me, PointProcess source, integer isource, double leftWidth, double rightWidth,
+static void copyBell2 (OverlapAddPlan *plan, Sound me, PointProcess source, integer isource, double leftWidth, double rightWidth,
 	Sound thee, double tmidTarget, double maxT)
 {
 	/*
@@ -253,10 +307,10 @@ static void copyBell2 (Sound me, PointProcess source, integer isource, double le
 		double sourceRightWidth = source -> t [isource + 1] - tmid;
 		if (sourceRightWidth < rightWidth) rightWidth = sourceRightWidth;
 	}
-	copyBell (me, tmid, leftWidth, rightWidth, thee, tmidTarget);
+	copyBell (plan, me, tmid, leftWidth, rightWidth, thee, tmidTarget);
 }
 
-static void copyFlat (Sound me, double tmin, double tmax, Sound thee, double tminTarget) {
+static void copyFlat (OverlapAddPlan *plan, Sound me, double tmin, double tmax, Sound thee, double tminTarget) {
 	integer imin = Sampled_xToHighIndex (me, tmin);
 	if (imin < 1) imin = 1;
 	integer imax = Sampled_xToHighIndex (me, tmax) - 1;   // not xToLowIndex: ensure separation of subsequent calls
@@ -266,7 +320,132 @@ static void copyFlat (Sound me, double tmin, double tmax, Sound thee, double tmi
 	if (iminTarget < 1) iminTarget = 1;
 	trace (tmin, U" ", tmax, U" ", tminTarget, U" ", imin, U" ", imax, U" ", iminTarget);
 	Melder_assert (iminTarget + imax - imin <= thy nx);
-	NUMvector_copyElements (my z [1] + imin, thy z [1] + iminTarget, 0, imax - imin);
+	plan -> append (imin, imax, iminTarget - imin, OverlapAdd_FLAT);
+}
+
+static void OverlapAddPlan_performBlock (OverlapAddPlan *me, const double *source, double *target,
+	double **riseWindows, double **fallWindows, integer ifirstTarget, integer ilastTarget)
+{
+	for (integer icopy = 1; icopy <= my numberOfCopies; icopy ++) {
+		const OverlapAddCopy *copy = & my copies [icopy];
+		integer itargetMin = copy -> isourceMin + copy -> distance, itargetMax = copy -> isourceMax + copy -> distance;
+		if (itargetMin < ifirstTarget) itargetMin = ifirstTarget;
+		if (itargetMax > ilastTarget) itargetMax = ilastTarget;
+		integer n = itargetMax - itargetMin + 1;
+		if (n <= 0) continue;
+		const double *from = & source [itargetMin - copy -> distance];
+		double *to = & target [itargetMin];
+		if (copy -> shape == OverlapAdd_FLAT) {
+			for (integer i = 0; i < n; i ++)
+				to [i] = from [i];
+		} else {
+			integer length = copy -> isourceMax - copy -> isourceMin + 1;
+			const double *window = ( copy -> shape == OverlapAdd_RISE ? riseWindows [length] : fallWindows [length] ) +
+				(itargetMin - copy -> distance - copy -> isourceMin);
+			for (integer i = 0; i < n; i ++)   // a loop without dependencies, so that the compiler can vectorize it
+				to [i] += from [i] * window [i];
+		}
+	}
+}
+
+Thing_define (OverlapAdd_Args, Thing) { public:
+	OverlapAddPlan *plan;
+	double *source, *target;
+	double **riseWindows, **fallWindows;
+	integer ifirstTarget, ilastTarget;   // the time block handled by this thread
+};
+
+Thing_implement (OverlapAdd_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE OverlapAdd_performBlock (OverlapAdd_Args me) {
+	OverlapAddPlan_performBlock (my plan, my source, my target, my riseWindows, my fallWindows, my ifirstTarget, my ilastTarget);
+	MelderThread_RETURN;
+}
+
+/*
+	If 'useThreads' is false, the caller is itself one of several threads.
+*/
+static void OverlapAddPlan_perform (OverlapAddPlan *me, Sound source, Sound target, bool useThreads) {
+	if (my numberOfCopies == 0) return;
+	/*
+		Precompute the raised-cosine windows for all lengths that occur,
+		so that the threads share read-only tables instead of computing a cosine per sample.
+	*/
+	autoNUMvector <bool> lengthOccurs;
+	autoNUMvector <double *> riseWindows, fallWindows;   // element i points to the window for length i, if that length occurs
+	autoNUMvector <double> windowStorage;   // the windows for all occurring lengths, one after another
+	integer numberOfWindowSamples = 0;
+	{// scope
+		MelderThread_LOCK (overlapAddMutex);
+		try {
+			lengthOccurs.reset (0, my maximumLength);
+			riseWindows.reset (0, my maximumLength);
+			fallWindows.reset (0, my maximumLength);
+		} catch (MelderError) {
+			MelderThread_UNLOCK (overlapAddMutex);
+			throw;
+		}
+		MelderThread_UNLOCK (overlapAddMutex);
+	}
+	for (integer icopy = 1; icopy <= my numberOfCopies; icopy ++) {
+		if (my copies [icopy]. shape == OverlapAdd_FLAT) continue;
+		integer length = my copies [icopy]. isourceMax - my copies [icopy]. isourceMin + 1;
+		if (! lengthOccurs [length]) {
+			lengthOccurs [length] = true;
+			numberOfWindowSamples += 2 * length;
+		}
+	}
+	if (numberOfWindowSamples > 0) {
+		MelderThread_LOCK (overlapAddMutex);
+		try {
+			windowStorage.reset (0, numberOfWindowSamples - 1);
+		} catch (MelderError) {
+			MelderThread_UNLOCK (overlapAddMutex);
+			throw;
+		}
+		MelderThread_UNLOCK (overlapAddMutex);
+	}
+	double *nextWindow = windowStorage.peek();
+	for (integer length = 1; length <= my maximumLength; length ++) {
+		if (! lengthOccurs [length]) continue;
+		double *rise = riseWindows [length] = nextWindow;
+		double *fall = fallWindows [length] = nextWindow + length;
+		nextWindow += 2 * length;
+		double dphase = NUMpi / length;
+		for (integer i = 0; i < length; i ++) {
+			rise [i] = 0.5 * (1.0 - cos (dphase * (i + 0.5)));
+			fall [i] = 0.5 * (1.0 + cos (dphase * (i + 0.5)));
+		}
+	}
+
+	integer numberOfSamples = target -> nx;
+	if (! useThreads) {
+		OverlapAddPlan_performBlock (me, source -> z [1], target -> z [1], riseWindows.peek(), fallWindows.peek(), 1, numberOfSamples);
+		return;
+	}
+	integer numberOfSamplesPerThread = 50000;
+	int numberOfThreads = (numberOfSamples - 1) / numberOfSamplesPerThread + 1;
+	const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
+	if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
+	if (numberOfThreads > 16) numberOfThreads = 16;
+	if (numberOfThreads < 1) numberOfThreads = 1;
+	numberOfSamplesPerThread = (numberOfSamples - 1) / numberOfThreads + 1;
+
+	autoOverlapAdd_Args args [16];
+	integer ifirstTarget = 1;
+	for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		autoOverlapAdd_Args arg = Thing_new (OverlapAdd_Args);
+		arg -> plan = me;
+		arg -> source = source -> z [1];
+		arg -> target = target -> z [1];
+		arg -> riseWindows = riseWindows.peek();
+		arg -> fallWindows = fallWindows.peek();
+		arg -> ifirstTarget = ifirstTarget;
+		arg -> ilastTarget = ( ithread == numberOfThreads ? numberOfSamples : ifirstTarget + numberOfSamplesPerThread - 1 );
+		ifirstTarget = arg -> ilastTarget + 1;
+		args [ithread - 1] = arg.move();
+	}
+	MelderThread_run (OverlapAdd_performBlock, args, numberOfThreads);
 }
 
 autoSound Sound_Point_Point_to_Sound (Sound me, PointProcess source, PointProcess target, double maxT) {
@@ -276,6 +455,8 @@ autoSound Sound_Point_Point_to_Sound (Sound me, PointProcess source, PointProces
 			NUMvector_copyElements (my z [1], thy z [1], 1, my nx);
 			return thee;
 		}
+		if (! overlapAddMutex_inited) { MelderThread_MUTEX_INIT (overlapAddMutex); overlapAddMutex_inited = true; }
+		OverlapAddPlan plan;
 		for (integer i = 1; i <= target -> nt; i ++) {
 			double tmid = target -> t [i];
 			double tleft = i > 1 ? target -> t [i - 1] : my xmin;
@@ -287,180 +468,330 @@ autoSound Sound_Point_Point_to_Sound (Sound me, PointProcess source, PointProces
 			if (! leftVoiced) leftWidth = rightWidth;   // symmetric bell
 			if (! rightVoiced) rightWidth = leftWidth;   // symmetric bell
 			if (leftVoiced || rightVoiced) {
-				copyBell2 (me, source, isource, leftWidth, rightWidth, thee.get(), tmid, maxT);
+				copyBell2 (& plan, me, source, isource, leftWidth, rightWidth, thee.get(), tmid, maxT);
 				if (! leftVoiced) {
 					double startOfFlat = ( i == 1 ? tleft : (tleft + tmid) / 2.0 );
 					double endOfFlat = tmid - leftWidth;
-					copyFlat (me, startOfFlat, endOfFlat, thee.get(), startOfFlat);
-					copyFall (me, endOfFlat, tmid, thee.get(), endOfFlat);
+					copyFlat (& plan, me, startOfFlat, endOfFlat, thee.get(), startOfFlat);
+					copyFall (& plan, me, endOfFlat, tmid, thee.get(), endOfFlat);
 				} else if (! rightVoiced) {
 					double startOfFlat = tmid + rightWidth;
 					double endOfFlat = ( i == target -> nt ? tright : (tmid + tright) / 2.0 );
-					copyRise (me, tmid, startOfFlat, thee.get(), startOfFlat);
-					copyFlat (me, startOfFlat, endOfFlat, thee.get(), startOfFlat);
+					copyRise (& plan, me, tmid, startOfFlat, thee.get(), startOfFlat);
+					copyFlat (& plan, me, startOfFlat, endOfFlat, thee.get(), startOfFlat);
 				}
 			} else {
 				double startOfFlat = ( i == 1 ? tleft : (tleft + tmid) / 2.0 );
 				double endOfFlat = ( i == target -> nt ? tright : (tmid + tright) / 2.0 );
-				copyFlat (me, startOfFlat, endOfFlat, thee.get(), startOfFlat);
+				copyFlat (& plan, me, startOfFlat, endOfFlat, thee.get(), startOfFlat);
 			}
 		}
+		OverlapAddPlan_perform (& plan, me, thee.get(), true);
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": not manipulated.");
 	}
 }
 
-autoSound Sound_Point_Pitch_Duration_to_Sound (Sound me, PointProcess pulses,
-	PitchTier pitch, DurationTier duration, double maxT)
-{
-	try {
-		integer ipointleft, ipointright;
-		double deltat = 0, handledTime = my xmin;
-		double startOfSourceNoise, endOfSourceNoise, startOfTargetNoise, endOfTargetNoise;
-		double durationOfSourceNoise, durationOfTargetNoise;
-		double startOfSourceVoice, endOfSourceVoice, startOfTargetVoice, endOfTargetVoice;
-		double durationOfSourceVoice, durationOfTargetVoice;
-		double startingPeriod, finishingPeriod, ttarget, voicelessPeriod;
-		if (duration -> points.size == 0)
-			Melder_throw (U"No duration points.");
+static double randomVoicelessPeriod (int threadNumber) {
+	const double lowest = 0.008, highest = 0.012;
+	return lowest + (highest - lowest) * NUMrandomFraction_mt (threadNumber);   // as NUMrandomUniform, but thread-safe
+}
 
-		/*
-		 * Create a Sound long enough to hold the longest possible duration-manipulated sound.
-		 */
-		autoSound thee = Sound_create (1, my xmin, my xmin + 3 * (my xmax - my xmin), 3 * my nx, my dx, my x1);
+/*
+	Decide where the voiced and voiceless stretches of 'me' go in 'thee',
+	which has to be long enough to hold the longest possible duration-manipulated sound.
+	The voiceless periods are drawn from random-number stream 'threadNumber'.
+*/
+static void Sound_Point_Pitch_Duration_planOverlapAdd (Sound me, PointProcess pulses,
+	PitchTier pitch, DurationTier duration, double maxT, Sound thee, OverlapAddPlan *plan, int threadNumber)
+{
+	integer ipointleft, ipointright;
+	double deltat = 0, handledTime = my xmin;
+	double startOfSourceNoise, endOfSourceNoise, startOfTargetNoise, endOfTargetNoise;
+	double durationOfSourceNoise, durationOfTargetNoise;
+	double startOfSourceVoice, endOfSourceVoice, startOfTargetVoice, endOfTargetVoice;
+	double durationOfSourceVoice, durationOfTargetVoice;
+	double startingPeriod, finishingPeriod, ttarget, voicelessPeriod;
+	integer voiceEdgeIndex = 0, voicedPeriodIndex = 0;   // the pitch is queried at increasing times
 
+	/*
+	 * Below, I'll abbreviate the voiced interval as "voice" and the voiceless interval as "noise".
+	 */
+	if (pitch && pitch -> points.size) for (ipointleft = 1; ipointleft <= pulses -> nt; ipointleft = ipointright + 1) {
 		/*
-		 * Below, I'll abbreviate the voiced interval as "voice" and the voiceless interval as "noise".
+		 * Find the beginning of the voice.
 		 */
-		if (pitch && pitch -> points.size) for (ipointleft = 1; ipointleft <= pulses -> nt; ipointleft = ipointright + 1) {
-			/*
-			 * Find the beginning of the voice.
-			 */
-			startOfSourceVoice = pulses -> t [ipointleft];   // the first pulse of the voice
-			startingPeriod = 1.0 / RealTier_getValueAtTime (pitch, startOfSourceVoice);
-			startOfSourceVoice -= 0.5 * startingPeriod;   // the first pulse is in the middle of a period
-
-			/*
-			 * Measure one noise.
-			 */
-			startOfSourceNoise = handledTime;
-			endOfSourceNoise = startOfSourceVoice;
-			durationOfSourceNoise = endOfSourceNoise - startOfSourceNoise;
-			startOfTargetNoise = startOfSourceNoise + deltat;
-			endOfTargetNoise = startOfTargetNoise + RealTier_getArea (duration, startOfSourceNoise, endOfSourceNoise);
-			durationOfTargetNoise = endOfTargetNoise - startOfTargetNoise;
-
-			/*
-			 * Copy the noise.
-			 */
-			voicelessPeriod = NUMrandomUniform (0.008, 0.012);
-			ttarget = startOfTargetNoise + 0.5 * voicelessPeriod;
-			while (ttarget < endOfTargetNoise) {
-				double tsource;
-				double tleft = startOfSourceNoise, tright = endOfSourceNoise;
-				int i;
-				for (i = 1; i <= 15; i ++) {
-					double tsourcemid = 0.5 * (tleft + tright);
-					double ttargetmid = startOfTargetNoise + RealTier_getArea (duration,
-						startOfSourceNoise, tsourcemid);
-					if (ttargetmid < ttarget) tleft = tsourcemid; else tright = tsourcemid;
-				}
-				tsource = 0.5 * (tleft + tright);
-				copyBell (me, tsource, voicelessPeriod, voicelessPeriod, thee.get(), ttarget);
-				voicelessPeriod = NUMrandomUniform (0.008, 0.012);
-				ttarget += voicelessPeriod;
-			}
-			deltat += durationOfTargetNoise - durationOfSourceNoise;
-
-			/*
-			 * Find the end of the voice.
-			 */
-			for (ipointright = ipointleft + 1; ipointright <= pulses -> nt; ipointright ++)
-				if (pulses -> t [ipointright] - pulses -> t [ipointright - 1] > maxT)
-					break;
-			ipointright --;
-			endOfSourceVoice = pulses -> t [ipointright];   // the last pulse of the voice
-			finishingPeriod = 1.0 / RealTier_getValueAtTime (pitch, endOfSourceVoice);
-			endOfSourceVoice += 0.5 * finishingPeriod;   // the last pulse is in the middle of a period
-			/*
-			 * Measure one voice.
-			 */
-			durationOfSourceVoice = endOfSourceVoice - startOfSourceVoice;
-
-			/*
-			 * This will be copied to an interval with a different location and duration.
-			 */
-			startOfTargetVoice = startOfSourceVoice + deltat;
-			endOfTargetVoice = startOfTargetVoice +
-				RealTier_getArea (duration, startOfSourceVoice, endOfSourceVoice);
-			durationOfTargetVoice = endOfTargetVoice - startOfTargetVoice;
-
-			/*
-			 * Copy the voiced part.
-			 */
-			ttarget = startOfTargetVoice + 0.5 * startingPeriod;
-			while (ttarget < endOfTargetVoice) {
-				double tsource, period;
-				integer isourcepulse;
-				double tleft = startOfSourceVoice, tright = endOfSourceVoice;
-				int i;
-				for (i = 1; i <= 15; i ++) {
-					double tsourcemid = 0.5 * (tleft + tright);
-					double ttargetmid = startOfTargetVoice + RealTier_getArea (duration,
-						startOfSourceVoice, tsourcemid);
-					if (ttargetmid < ttarget) tleft = tsourcemid; else tright = tsourcemid;
-				}
-				tsource = 0.5 * (tleft + tright);
-				period = 1.0 / RealTier_getValueAtTime (pitch, tsource);
-				isourcepulse = PointProcess_getNearestIndex (pulses, tsource);
-				copyBell2 (me, pulses, isourcepulse, period, period, thee.get(), ttarget, maxT);
-				ttarget += period;
-			}
-			deltat += durationOfTargetVoice - durationOfSourceVoice;
-			handledTime = endOfSourceVoice;
-		}
+		startOfSourceVoice = pulses -> t [ipointleft];   // the first pulse of the voice
+		startingPeriod = 1.0 / RealTier_getValueAtTime_continued (pitch, startOfSourceVoice, & voiceEdgeIndex);
+		startOfSourceVoice -= 0.5 * startingPeriod;   // the first pulse is in the middle of a period
 
 		/*
-		 * Copy the remaining unvoiced part, if we are at the end.
+		 * Measure one noise.
 		 */
 		startOfSourceNoise = handledTime;
-		endOfSourceNoise = my xmax;
+		endOfSourceNoise = startOfSourceVoice;
 		durationOfSourceNoise = endOfSourceNoise - startOfSourceNoise;
 		startOfTargetNoise = startOfSourceNoise + deltat;
 		endOfTargetNoise = startOfTargetNoise + RealTier_getArea (duration, startOfSourceNoise, endOfSourceNoise);
 		durationOfTargetNoise = endOfTargetNoise - startOfTargetNoise;
-		voicelessPeriod = NUMrandomUniform (0.008, 0.012);
+
+		/*
+		 * Copy the noise.
+		 */
+		voicelessPeriod = randomVoicelessPeriod (threadNumber);
 		ttarget = startOfTargetNoise + 0.5 * voicelessPeriod;
 		while (ttarget < endOfTargetNoise) {
 			double tsource;
 			double tleft = startOfSourceNoise, tright = endOfSourceNoise;
-			for (int i = 1; i <= 15; i ++) {
+			int i;
+			for (i = 1; i <= 15; i ++) {
 				double tsourcemid = 0.5 * (tleft + tright);
 				double ttargetmid = startOfTargetNoise + RealTier_getArea (duration,
 					startOfSourceNoise, tsourcemid);
 				if (ttargetmid < ttarget) tleft = tsourcemid; else tright = tsourcemid;
 			}
 			tsource = 0.5 * (tleft + tright);
-			copyBell (me, tsource, voicelessPeriod, voicelessPeriod, thee.get(), ttarget);
-			voicelessPeriod = NUMrandomUniform (0.008, 0.012);
+			copyBell (plan, me, tsource, voicelessPeriod, voicelessPeriod, thee, ttarget);
+			voicelessPeriod = randomVoicelessPeriod (threadNumber);
 			ttarget += voicelessPeriod;
 		}
+		deltat += durationOfTargetNoise - durationOfSourceNoise;
+
+		/*
+		 * Find the end of the voice.
+		 */
+		for (ipointright = ipointleft + 1; ipointright <= pulses -> nt; ipointright ++)
+			if (pulses -> t [ipointright] - pulses -> t [ipointright - 1] > maxT)
+				break;
+		ipointright --;
+		endOfSourceVoice = pulses -> t [ipointright];   // the last pulse of the voice
+		finishingPeriod = 1.0 / RealTier_getValueAtTime_continued (pitch, endOfSourceVoice, & voiceEdgeIndex);
+		endOfSourceVoice += 0.5 * finishingPeriod;   // the last pulse is in the middle of a period
+		/*
+		 * Measure one voice.
+		 */
+		durationOfSourceVoice = endOfSourceVoice - startOfSourceVoice;
+
+		/*
+		 * This will be copied to an interval with a different location and duration.
+		 */
+		startOfTargetVoice = startOfSourceVoice + deltat;
+		endOfTargetVoice = startOfTargetVoice +
+			RealTier_getArea (duration, startOfSourceVoice, endOfSourceVoice);
+		durationOfTargetVoice = endOfTargetVoice - startOfTargetVoice;
 
 		/*
-		 * Find the number of trailing zeroes and hack the sound's time domain.
+		 * Copy the voiced part.
 		 */
-		thy xmax = thy xmin + RealTier_getArea (duration, my xmin, my xmax);
-		if (fabs (thy xmax - my xmax) < 1e-12) thy xmax = my xmax;   // common situation
-		thy nx = Sampled_xToLowIndex (thee.get(), thy xmax);
-		if (thy nx > 3 * my nx) thy nx = 3 * my nx;
+		ttarget = startOfTargetVoice + 0.5 * startingPeriod;
+		while (ttarget < endOfTargetVoice) {
+			double tsource, period;
+			integer isourcepulse;
+			double tleft = startOfSourceVoice, tright = endOfSourceVoice;
+			int i;
+			for (i = 1; i <= 15; i ++) {
+				double tsourcemid = 0.5 * (tleft + tright);
+				double ttargetmid = startOfTargetVoice + RealTier_getArea (duration,
+					startOfSourceVoice, tsourcemid);
+				if (ttargetmid < ttarget) tleft = tsourcemid; else tright = tsourcemid;
+			}
+			tsource = 0.5 * (tleft + tright);
+			period = 1.0 / RealTier_getValueAtTime_continued (pitch, tsource, & voicedPeriodIndex);
+			isourcepulse = PointProcess_getNearestIndex (pulses, tsource);
+			copyBell2 (plan, me, pulses, isourcepulse, period, period, thee, ttarget, maxT);
+			ttarget += period;
+		}
+		deltat += durationOfTargetVoice - durationOfSourceVoice;
+		handledTime = endOfSourceVoice;
+	}
+
+	/*
+	 * Copy the remaining unvoiced part, if we are at the end.
+	 */
+	startOfSourceNoise = handledTime;
+	endOfSourceNoise = my xmax;
+	durationOfSourceNoise = endOfSourceNoise - startOfSourceNoise;
+	startOfTargetNoise = startOfSourceNoise + deltat;
+	endOfTargetNoise = startOfTargetNoise + RealTier_getArea (duration, startOfSourceNoise, endOfSourceNoise);
+	durationOfTargetNoise = endOfTargetNoise - startOfTargetNoise;
+	voicelessPeriod = randomVoicelessPeriod (threadNumber);
+	ttarget = startOfTargetNoise + 0.5 * voicelessPeriod;
+	while (ttarget < endOfTargetNoise) {
+		double tsource;
+		double tleft = startOfSourceNoise, tright = endOfSourceNoise;
+		for (int i = 1; i <= 15; i ++) {
+			double tsourcemid = 0.5 * (tleft + tright);
+			double ttargetmid = startOfTargetNoise + RealTier_getArea (duration,
+				startOfSourceNoise, tsourcemid);
+			if (ttargetmid < ttarget) tleft = tsourcemid; else tright = tsourcemid;
+		}
+		tsource = 0.5 * (tleft + tright);
+		copyBell (plan, me, tsource, voicelessPeriod, voicelessPeriod, thee, ttarget);
+		voicelessPeriod = randomVoicelessPeriod (threadNumber);
+		ttarget += voicelessPeriod;
+	}
+}
+
+/*
+	Find the number of trailing zeroes and hack the sound's time domain.
+*/
+static void Sound_Point_Pitch_Duration_trim (Sound me, DurationTier duration, Sound thee) {
+	thy xmax = thy xmin + RealTier_getArea (duration, my xmin, my xmax);
+	if (fabs (thy xmax - my xmax) < 1e-12) thy xmax = my xmax;   // common situation
+	thy nx = Sampled_xToLowIndex (thee, thy xmax);
+	if (thy nx > 3 * my nx) thy nx = 3 * my nx;
+}
 
+autoSound Sound_Point_Pitch_Duration_to_Sound (Sound me, PointProcess pulses,
+	PitchTier pitch, DurationTier duration, double maxT)
+{
+	try {
+		if (duration -> points.size == 0)
+			Melder_throw (U"No duration points.");
+		if (! overlapAddMutex_inited) { MelderThread_MUTEX_INIT (overlapAddMutex); overlapAddMutex_inited = true; }
+		autoSound thee = Sound_create (1, my xmin, my xmin + 3 * (my xmax - my xmin), 3 * my nx, my dx, my x1);
+		OverlapAddPlan plan;
+		Sound_Point_Pitch_Duration_planOverlapAdd (me, pulses, pitch, duration, maxT, thee.get(), & plan, 0);
+		OverlapAddPlan_perform (& plan, me, thee.get(), true);
+		Sound_Point_Pitch_Duration_trim (me, duration, thee.get());
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": not manipulated.");
 	}
 }
 
+Thing_define (Manipulation_Batch_Args, Thing) { public:
+	OrderedOf<structSound> *sounds;   // mono and mean-subtracted, one per stimulus
+	OrderedOf<structPointProcess> *pulses;
+	OrderedOf<structPitchTier> *pitchTiers;
+	OrderedOf<structDurationTier> *durationTiers;
+	SoundList results;
+	integer firstStimulus, stimulusStep;
+	int threadNumber;
+	bool isMainThread;
+	volatile int *cancelled;
+};
+
+Thing_implement (Manipulation_Batch_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE Manipulation_Batch_resynthesize (Manipulation_Batch_Args me) {
+	try {
+		for (integer istim = my firstStimulus; istim <= my results -> size; istim += my stimulusStep) {
+			if (*my cancelled) MelderThread_RETURN;
+			Sound sound = my sounds -> at [istim];
+			DurationTier duration = my durationTiers -> at [istim];
+			Sound thee = my results -> at [istim];
+			OverlapAddPlan plan;
+			Sound_Point_Pitch_Duration_planOverlapAdd (sound, my pulses -> at [istim], my pitchTiers -> at [istim], duration,
+				MAX_T, thee, & plan, my threadNumber);
+			OverlapAddPlan_perform (& plan, sound, thee, false);
+			Sound_Point_Pitch_Duration_trim (sound, duration, thee);
+			if (my isMainThread)
+				Melder_progress (0.5 + 0.5 * istim / my results -> size, U"Resynthesized ", istim, U" out of ", my results -> size, U" sounds.");
+		}
+	} catch (MelderError) {
+		*my cancelled = 1;
+		if (my isMainThread) throw;
+	}
+	MelderThread_RETURN;
+}
+
+autoSoundList Sounds_PitchTiers_DurationTiers_to_Sounds_overlapAdd (OrderedOf<structSound> *sounds,
+	OrderedOf<structPitchTier> *pitchTiers, OrderedOf<structDurationTier> *durationTiers,
+	double timeStep, double minimumPitch, double maximumPitch)
+{
+	try {
+		integer numberOfStimuli = sounds -> size;
+		if (pitchTiers -> size > numberOfStimuli) numberOfStimuli = pitchTiers -> size;
+		if (durationTiers -> size > numberOfStimuli) numberOfStimuli = durationTiers -> size;
+		if (numberOfStimuli == 0)
+			Melder_throw (U"No sounds to resynthesize.");
+		if (sounds -> size != 1 && sounds -> size != numberOfStimuli ||
+			pitchTiers -> size != 1 && pitchTiers -> size != numberOfStimuli ||
+			durationTiers -> size != 1 && durationTiers -> size != numberOfStimuli)
+		{
+			Melder_throw (U"The numbers of sounds, pitch tiers and duration tiers should be equal (or 1).");
+		}
+		for (integer itier = 1; itier <= durationTiers -> size; itier ++)
+			if (durationTiers -> at [itier] -> points.size == 0)
+				Melder_throw (durationTiers -> at [itier], U": no duration points.");
+		if (! overlapAddMutex_inited) { MelderThread_MUTEX_INIT (overlapAddMutex); overlapAddMutex_inited = true; }
+
+		autoMelderProgress progress (U"Resynthesizing sounds...");
+
+		/*
+			Analyse each distinct sound only once, even if it is used for several stimuli.
+		*/
+		OrderedOf<structSound> analysedSounds, stimulusSounds;
+		OrderedOf<structPointProcess> analysedPulses, stimulusPulses;
+		OrderedOf<structPitchTier> stimulusPitchTiers;
+		OrderedOf<structDurationTier> stimulusDurationTiers;
+		autoNUMvector <integer> analysisNumber (1, sounds -> size);
+		for (integer isound = 1; isound <= sounds -> size; isound ++) {
+			Sound original = sounds -> at [isound];
+			integer iprevious = 1;
+			while (iprevious < isound && sounds -> at [iprevious] != original) iprevious ++;
+			if (iprevious < isound) {
+				analysisNumber [isound] = analysisNumber [iprevious];
+				continue;
+			}
+			Melder_progress (0.5 * (isound - 1) / sounds -> size, U"Analysing sound ", isound, U" out of ", sounds -> size, U".");
+			autoSound mono = Sound_convertToMono (original);
+			Vector_subtractMean (mono.get());
+			autoPitch pitch = Sound_to_Pitch (mono.get(), timeStep, minimumPitch, maximumPitch);
+			analysedPulses. addItem_move (Sound_Pitch_to_PointProcess_cc (mono.get(), pitch.get()));
+			analysedSounds. addItem_move (mono.move());
+			analysisNumber [isound] = analysedSounds.size;
+		}
+		autoSoundList results = SoundList_create ();
+		for (integer istim = 1; istim <= numberOfStimuli; istim ++) {
+			integer ianalysis = analysisNumber [sounds -> size == 1 ? 1 : istim];
+			Sound sound = analysedSounds.at [ianalysis];
+			stimulusSounds. addItem_ref (sound);
+			stimulusPulses. addItem_ref (analysedPulses.at [ianalysis]);
+			PitchTier pitch = pitchTiers -> at [pitchTiers -> size == 1 ? 1 : istim];
+			stimulusPitchTiers. addItem_ref (pitch);
+			stimulusDurationTiers. addItem_ref (durationTiers -> at [durationTiers -> size == 1 ? 1 : istim]);
+			autoSound result = Sound_create (1, sound -> xmin, sound -> xmin + 3 * (sound -> xmax - sound -> xmin),
+				3 * sound -> nx, sound -> dx, sound -> x1);
+			Thing_setName (result.get(), pitch -> name ? pitch -> name : U"manip");
+			results -> addItem_move (result.move());
+		}
+
+		/*
+			The stimuli are independent, so they are divided over the threads,
+			each thread drawing its voiceless periods from its own random-number stream.
+		*/
+		int numberOfThreads = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > numberOfStimuli) numberOfThreads = numberOfStimuli;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		autoManipulation_Batch_Args args [16];
+		volatile int cancelled = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			autoManipulation_Batch_Args arg = Thing_new (Manipulation_Batch_Args);
+			arg -> sounds = & stimulusSounds;
+			arg -> pulses = & stimulusPulses;
+			arg -> pitchTiers = & stimulusPitchTiers;
+			arg -> durationTiers = & stimulusDurationTiers;
+			arg -> results = results.get();
+			arg -> firstStimulus = ithread;
+			arg -> stimulusStep = numberOfThreads;
+			arg -> threadNumber = ithread;
+			arg -> isMainThread = ( ithread == numberOfThreads );
+			arg -> cancelled = & cancelled;
+			args [ithread - 1] = arg.move();
+		}
+		MelderThread_run (Manipulation_Batch_resynthesize, args, numberOfThreads);
+		if (cancelled)
+			Melder_throw (U"Resynthesis interrupted.");
+		return results;
+	} catch (MelderError) {
+		Melder_throw (U"Sounds not resynthesized.");
+	}
+}
+
 static autoSound synthesize_overlapAdd_nodur (Manipulation me) {
 	try {
 		if (! my sound)  Melder_throw (U"Missing original sound.");
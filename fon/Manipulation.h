@@ -79,5 +79,16 @@ void Manipulation_writeToBinaryFileWithoutSound (Manipulation me, MelderFile fil
 autoSound Sound_Point_Pitch_Duration_to_Sound (Sound me, PointProcess pulses,
 	PitchTier pitch, DurationTier duration, double maxT);
 
+Thing_declare (SoundList);   // see TextGrid_Sound.h
+autoSoundList Sounds_PitchTiers_DurationTiers_to_Sounds_overlapAdd (OrderedOf<structSound> *sounds,
+	OrderedOf<structPitchTier> *pitchTiers, OrderedOf<structDurationTier> *durationTiers,
+	double timeStep, double minimumPitch, double maximumPitch);
+/*
+	Overlap-add resynthesis of many stimuli at once, as if by
+	Sound_to_Manipulation + Manipulation_replacePitchTier + Manipulation_replaceDurationTier + Manipulation_to_Sound.
+	Each of the three lists contains either one element (which is used for all stimuli) or one element per stimulus.
+	A sound that occurs more than once is analysed only once; the resyntheses run in parallel.
+*/
+
 /* End of file Manipulation.h */
 #endif
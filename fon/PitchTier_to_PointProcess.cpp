@@ -128,10 +128,10 @@ autoPitchTier PitchTier_PointProcess_to_PitchTier (PitchTier me, PointProcess pp
 	try {
 		if (my points.size == 0) Melder_throw (U"No pitch points.");
 		autoPitchTier thee = PitchTier_create (pp -> xmin, pp -> xmax);
+		autoNUMvector <double> values (1, pp -> nt);
+		RealTier_getValuesAtTimes (me, pp -> t, pp -> nt, values.peek());
 		for (integer i = 1; i <= pp -> nt; i ++) {
-			double time = pp -> t [i];
-			double value = RealTier_getValueAtTime (me, time);
-			RealTier_addPoint (thee.get(), time, value);
+			RealTier_addPoint (thee.get(), pp -> t [i], values [i]);
 		}
 		return thee;
 	} catch (MelderError) {
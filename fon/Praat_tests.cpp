@@ -29,6 +29,16 @@
 #include "praat.h"
 #include "NUM2.h"
 #include "Sound.h"
+#include "Sound_to_Pitch.h"
+#include "Sound_to_Formant.h"
+#include "Sound_and_Spectrogram.h"
+#include "Sound_to_Intensity.h"
+#include "Sound_to_MFCC.h"
+#include "KlattGrid.h"
+#include "Table.h"
+#include "MelderThread.h"
+#include "praat_script.h"
+#include "praat_version.h"
 
 #include "enums_getText.h"
 #include "Praat_tests_enums.h"
@@ -550,6 +560,196 @@ int Praat_tests (kPraatTests itest, char32 *arg1, char32 *arg2, char32 *arg3, ch
 	return 1;
 }
 
+/*
+	Analysis benchmarks.
+
+	Every benchmark gets deterministic input whose size is given as a duration in seconds
+	(for the Table benchmarks 10,000 rows per second, for the script benchmark 100,000 loop iterations per second),
+	and reports the best of three runs as a line of tab-separated values,
+	so that the output of several sizes, numbers of threads and releases can be read and compared as one Table.
+*/
+
+static double benchmarkNoise (uint64 *state) {
+	*state ^= *state >> 12;   // xorshift64*, so that the input does not depend on the random generator's seed
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+	return (double) ((*state * 2685821657736338717ULL) >> 11) / 9007199254740992.0 * 2.0 - 1.0;
+}
+
+static autoSound benchmarkSound (double duration) {
+	/*
+		A vowel-like signal: ten harmonics of a glide from 100 to 200 Hz, plus weak noise.
+	*/
+	autoSound me = Sound_createSimple (1, duration, 22050.0);
+	uint64 state = 88172645463325252ULL;
+	double phase = 0.0;
+	for (integer isamp = 1; isamp <= my nx; isamp ++) {
+		const double f0 = 100.0 + 100.0 * (isamp - 1) * my dx / duration;
+		phase += 2.0 * NUMpi * f0 * my dx;
+		double value = 0.0;
+		for (int iharmonic = 1; iharmonic <= 10; iharmonic ++)
+			value += sin (iharmonic * phase) / iharmonic;
+		my z [1] [isamp] = 0.1 * value + 0.01 * benchmarkNoise (& state);
+	}
+	return me;
+}
+
+static autoKlattGrid benchmarkKlattGrid (double duration) {
+	autoKlattGrid me = KlattGrid_create (0.0, duration, 5, 0, 0, 0, 0, 0, 0);
+	for (double t = 0.0; t <= duration; t += 0.1) {
+		KlattGrid_addPitchPoint (me.get(), t, 100.0 + 50.0 * sin (t));
+		KlattGrid_addVoicingAmplitudePoint (me.get(), t, 90.0);
+		for (integer iformant = 1; iformant <= 5; iformant ++) {
+			KlattGrid_addFormantPoint (me.get(), KlattGrid_ORAL_FORMANTS, iformant, t, 1000.0 * iformant - 500.0 + 100.0 * cos (t));
+			KlattGrid_addBandwidthPoint (me.get(), KlattGrid_ORAL_FORMANTS, iformant, t, 50.0 * iformant);
+		}
+	}
+	return me;
+}
+
+static autoTable benchmarkTable (integer numberOfRows) {
+	autoTable me = Table_createWithColumnNames (numberOfRows, U"speaker vowel F1 F2");
+	uint64 state = 88172645463325252ULL;
+	static const char32 *vowels [] = { U"a", U"e", U"i", U"o", U"u" };
+	for (integer irow = 1; irow <= numberOfRows; irow ++) {
+		Table_setStringValue (me.get(), irow, 1, Melder_cat (U"s", 1 + (integer) (50.0 * (0.5 + 0.5 * benchmarkNoise (& state)))));
+		Table_setStringValue (me.get(), irow, 2, vowels [irow % 5]);
+		Table_setNumericValue (me.get(), irow, 3, 500.0 + 200.0 * benchmarkNoise (& state));
+		Table_setNumericValue (me.get(), irow, 4, 1500.0 + 500.0 * benchmarkNoise (& state));
+	}
+	return me;
+}
+
+template <typename Prepare, typename Run>
+static double benchmark_bestOfThree (Prepare prepare, Run run) {
+	double best = undefined;
+	for (int irun = 1; irun <= 3; irun ++) {
+		prepare ();
+		Melder_stopwatch ();
+		run ();
+		const double time = Melder_stopwatch ();
+		if (isundef (best) || time < best)
+			best = time;
+	}
+	return best;
+}
+
+static void benchmark_report (const char32 *name, const char32 *unit, double size, int numberOfThreads, integer numberOfUnits, double time) {
+	MelderInfo_writeLine (name, U"\t", unit, U"\t", size, U"\t", numberOfThreads, U"\t", numberOfUnits, U"\t",
+		Melder_fixed (time, 6), U"\t", Melder_fixed (numberOfUnits / time, 1), U"\t", PRAAT_VERSION_NUM);
+}
+
+static void benchmark_sound (const char32 *name, const char32 *unit, double duration, int numberOfThreads,
+	autoSampled (*analyse) (Sound sound))
+{
+	autoSound sound = benchmarkSound (duration);
+	integer numberOfUnits = 0;
+	const double time = benchmark_bestOfThree ([] () { }, [&] () {
+		autoSampled result = analyse (sound.get());
+		numberOfUnits = ( str32equ (unit, U"samples") ? sound -> nx : result -> nx );
+	});
+	benchmark_report (name, unit, duration, numberOfThreads, numberOfUnits, time);
+}
+
+void Praat_benchmarks (const char32 *durations_string, const char32 *numbersOfThreads_string, const char32 *benchmarks) {
+	integer numberOfDurations, numberOfNumbersOfThreads;
+	autoNUMvector <double> durations (NUMstring_to_numbers (durations_string, & numberOfDurations), 1);
+	autoNUMvector <double> numbersOfThreads (NUMstring_to_numbers (numbersOfThreads_string, & numberOfNumbersOfThreads), 1);
+	Melder_require (numberOfDurations > 0, U"Give at least one duration.");
+	Melder_require (numberOfNumbersOfThreads > 0, U"Give at least one number of threads.");
+	for (integer i = 1; i <= numberOfDurations; i ++)
+		Melder_require (durations [i] > 0.0, U"The durations should be positive.");
+	for (integer i = 1; i <= numberOfNumbersOfThreads; i ++)
+		Melder_require (numbersOfThreads [i] >= 1.0 && numbersOfThreads [i] <= 64.0,
+			U"The numbers of threads should be between 1 and 64.");
+	auto wanted = [benchmarks] (const char32 *name) {
+		return ! benchmarks || benchmarks [0] == U'\0' || str32equ (benchmarks, U"all") ||
+			Melder_stringMatchesCriterion (benchmarks, kMelder_string::CONTAINS_WORD, name, true);
+	};
+	struct autoForcedNumberOfProcessors {
+		~autoForcedNumberOfProcessors () { MelderThread_forcedNumberOfProcessors = 0; }
+	} restoreTheNumberOfProcessors;
+	MelderInfo_open ();
+	MelderInfo_writeLine (U"benchmark\tunit\tsize\tthreads\tunits\tseconds\tunitsPerSecond\tversion");
+	for (integer ithreads = 1; ithreads <= numberOfNumbersOfThreads; ithreads ++) {
+		const int numberOfThreads = (int) numbersOfThreads [ithreads];
+		MelderThread_forcedNumberOfProcessors = numberOfThreads;
+		for (integer iduration = 1; iduration <= numberOfDurations; iduration ++) {
+			const double duration = durations [iduration];
+			if (wanted (U"pitch_ac")) benchmark_sound (U"pitch_ac", U"frames", duration, numberOfThreads, [] (Sound sound) -> autoSampled {
+				return Sound_to_Pitch_ac (sound, 0.0, 75.0, 3.0, 15, false, 0.03, 0.45, 0.01, 0.35, 0.14, 600.0);
+			});
+			if (wanted (U"pitch_cc")) benchmark_sound (U"pitch_cc", U"frames", duration, numberOfThreads, [] (Sound sound) -> autoSampled {
+				return Sound_to_Pitch_cc (sound, 0.0, 75.0, 1.0, 15, false, 0.03, 0.45, 0.01, 0.35, 0.14, 600.0);
+			});
+			if (wanted (U"formant_burg")) benchmark_sound (U"formant_burg", U"frames", duration, numberOfThreads, [] (Sound sound) -> autoSampled {
+				return Sound_to_Formant_burg (sound, 0.0, 5.0, 5500.0, 0.025, 50.0);
+			});
+			if (wanted (U"spectrogram")) benchmark_sound (U"spectrogram", U"frames", duration, numberOfThreads, [] (Sound sound) -> autoSampled {
+				return Sound_to_Spectrogram (sound, 0.005, 5000.0, 0.002, 20.0, kSound_to_Spectrogram_windowShape::GAUSSIAN, 8.0, 8.0);
+			});
+			if (wanted (U"intensity")) benchmark_sound (U"intensity", U"frames", duration, numberOfThreads, [] (Sound sound) -> autoSampled {
+				return Sound_to_Intensity (sound, 100.0, 0.0, true);
+			});
+			if (wanted (U"mfcc")) benchmark_sound (U"mfcc", U"frames", duration, numberOfThreads, [] (Sound sound) -> autoSampled {
+				return Sound_to_MFCC (sound, 12, 0.015, 0.005, 100.0, 100.0, 0.0);
+			});
+			if (wanted (U"resample")) benchmark_sound (U"resample", U"samples", duration, numberOfThreads, [] (Sound sound) -> autoSampled {
+				return Sound_resample (sound, 16000.0, 50);
+			});
+			if (wanted (U"klattgrid")) {
+				autoKlattGrid grid = benchmarkKlattGrid (duration);
+				integer numberOfSamples = 0;
+				const double time = benchmark_bestOfThree ([] () { }, [&] () {
+					autoSound sound = KlattGrid_to_Sound (grid.get());
+					numberOfSamples = sound -> nx;
+				});
+				benchmark_report (U"klattgrid", U"samples", duration, numberOfThreads, numberOfSamples, time);
+			}
+			const integer numberOfRows = Melder_iround (10000.0 * duration);
+			if (wanted (U"table_read") && numberOfRows > 0) {
+				structMelderDir tempDir { };
+				Melder_getTempDir (& tempDir);
+				structMelderFile file { };
+				MelderDir_getFile (& tempDir, U"praat_benchmark_table.txt", & file);
+				Table_writeToTabSeparatedFile (benchmarkTable (numberOfRows).get(), & file);
+				try {
+					const double time = benchmark_bestOfThree ([] () { }, [&] () {
+						autoTable table = Table_readFromCharacterSeparatedTextFile (& file, U'\t', false);
+					});
+					MelderFile_delete (& file);
+					benchmark_report (U"table_read", U"rows", duration, numberOfThreads, numberOfRows, time);
+				} catch (MelderError) {
+					MelderFile_delete (& file);
+					throw;
+				}
+			}
+			if (wanted (U"table_sort") && numberOfRows > 0) {
+				autoTable original = benchmarkTable (numberOfRows), table;
+				const double time = benchmark_bestOfThree ([&] () { table = Data_copy (original.get()); }, [&] () {
+					Table_sortRows_string (table.get(), U"vowel speaker F1");
+				});
+				benchmark_report (U"table_sort", U"rows", duration, numberOfThreads, numberOfRows, time);
+			}
+			if (wanted (U"script")) {
+				const integer numberOfIterations = Melder_iround (100000.0 * duration);
+				autostring32 script = Melder_dup (Melder_cat (
+					U"x = 0\n"
+					U"s$ = \"\"\n"
+					U"for i to ", numberOfIterations, U"\n"
+					U"\tx += sqrt (i) * (i mod 7)\n"
+					U"\ts$ = left$ (s$ + \"ab\", 10)\n"
+					U"endfor\n"));
+				const double time = benchmark_bestOfThree ([] () { }, [&] () {
+					praat_executeScriptFromText (script.peek());
+				});
+				benchmark_report (U"script", U"lines", duration, numberOfThreads, 4 * numberOfIterations, time);
+			}
+		}
+	}
+	MelderInfo_close ();
+}
+
 /* More compiler stuff */
 #if 1
 /*
@@ -24,5 +24,12 @@
 
 int Praat_tests (kPraatTests itest, char32 *arg1, char32 *arg2, char32 *arg3, char32 *arg4);
 
+void Praat_benchmarks (const char32 *durations, const char32 *numbersOfThreads, const char32 *benchmarks);
+/*
+	Writes a tab-separated table of the throughput of Pitch, Formant, Spectrogram, Intensity and MFCC analysis,
+	resampling, KlattGrid synthesis, Table reading and sorting, and script interpretation,
+	for each combination of input size and number of threads.
+*/
+
 #endif
 /* End of file Praat_tests.h */
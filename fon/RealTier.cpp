@@ -128,6 +128,49 @@ double RealTier_getValueAtTime (RealTier me, double t) {
 		: fleft + (t - tleft) * (fright - fleft) / (tright - tleft);   // linear interpolation
 }
 
+double RealTier_getValueAtTime_continued (RealTier me, double t, integer *inout_lowIndex) {
+	integer n = my points.size;
+	if (n == 0) return undefined;
+	RealPoint pointRight = my points.at [1];
+	if (t <= pointRight -> number) return pointRight -> value;   // constant extrapolation
+	RealPoint pointLeft = my points.at [n];
+	if (t >= pointLeft -> number) return pointLeft -> value;   // constant extrapolation
+	Melder_assert (n >= 2);
+	/*
+		Walk forward from the previous position; jump with a binary search if the time went back.
+		The result is the same low index as AnyTier_timeToLowIndex would give.
+	*/
+	integer ileft = *inout_lowIndex;
+	if (ileft < 1 || ileft >= n || t < my points.at [ileft] -> number) {
+		ileft = AnyTier_timeToLowIndex (me->asAnyTier(), t);
+	} else {
+		while (t >= my points.at [ileft + 1] -> number)
+			ileft ++;   // stops before n, because t < the time of the last point
+	}
+	*inout_lowIndex = ileft;
+	integer iright = ileft + 1;
+	Melder_assert (ileft >= 1 && iright <= n);
+	pointLeft = my points.at [ileft];
+	pointRight = my points.at [iright];
+	double tleft = pointLeft -> number, fleft = pointLeft -> value;
+	double tright = pointRight -> number, fright = pointRight -> value;
+	return t == tright ? fright   // be very accurate
+		: tleft == tright ? 0.5 * (fleft + fright)   // unusual, but possible; no preference
+		: fleft + (t - tleft) * (fright - fleft) / (tright - tleft);   // linear interpolation
+}
+
+void RealTier_getValuesAtTimes (RealTier me, const double times [], integer numberOfTimes, double values []) {
+	integer lowIndex = 0;
+	for (integer i = 1; i <= numberOfTimes; i ++)
+		values [i] = RealTier_getValueAtTime_continued (me, times [i], & lowIndex);
+}
+
+void RealTier_getValuesAtSampleTimes (RealTier me, double x1, double dx, integer numberOfSamples, double values []) {
+	integer lowIndex = 0;
+	for (integer i = 1; i <= numberOfSamples; i ++)
+		values [i] = RealTier_getValueAtTime_continued (me, x1 + (i - 1) * dx, & lowIndex);
+}
+
 double RealTier_getMaximumValue (RealTier me) {
 	double result = undefined;
 	integer n = my points.size;
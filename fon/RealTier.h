@@ -55,6 +55,25 @@ double RealTier_getValueAtTime (RealTier me, double t);
 /* Outside points: constant extrapolation. */
 /* No points: undefined. */
 
+double RealTier_getValueAtTime_continued (RealTier me, double t, integer *inout_lowIndex);
+/*
+	As RealTier_getValueAtTime, for a sequence of (mostly) increasing times:
+	the search for the surrounding points starts at *inout_lowIndex, which is updated.
+	Start with *inout_lowIndex = 0.
+*/
+
+void RealTier_getValuesAtTimes (RealTier me, const double times [], integer numberOfTimes, double values []);
+/*
+	values [i] = RealTier_getValueAtTime (me, times [i]), for i = 1 .. numberOfTimes.
+	If the times are in ascending order, this is a single walk through the points.
+	'times' and 'values' may be the same array.
+*/
+
+void RealTier_getValuesAtSampleTimes (RealTier me, double x1, double dx, integer numberOfSamples, double values []);
+/*
+	values [i] = RealTier_getValueAtTime (me, x1 + (i - 1) * dx), for i = 1 .. numberOfSamples.
+*/
+
 double RealTier_getMinimumValue (RealTier me);
 double RealTier_getMaximumValue (RealTier me);
 double RealTier_getArea (RealTier me, double tmin, double tmax);
@@ -25,6 +25,7 @@
 #include "Sound.h"
 #include "Sound_extensions.h"
 #include "NUM2.h"
+#include "Resonator.h"
 #include "tensor.h"
 
 #include "enums_getText.h"
@@ -1149,22 +1150,40 @@ autoSound Sound_extractPartForOverlap (Sound me, double t1, double t2, double ov
 	}
 }
 
+/*
+	Filter x [1..numberOfChannels] [1..n] in place through a cascade of constant formants;
+	the channels run in lockstep.
+*/
+static void filterChannelsWithFormants (double **x, integer numberOfChannels, integer n, double dt,
+	int numberOfFormants, double formant [], double bandwidth [])
+{
+	autoResonatorBank bank = ResonatorBank_create (ResonatorBank_ALLPOLE, dt, numberOfChannels);
+	for (int iformant = 1; iformant <= numberOfFormants; iformant ++) {
+		double a1, a2;
+		NUMfbtoa (formant [iformant], bandwidth [iformant], dt, & a1, & a2);
+		for (integer channel = 1; channel <= numberOfChannels; channel ++) {
+			ResonatorBank_setCoefficients (bank.get(), channel, 1.0, a1, - a2);
+		}
+		ResonatorBank_resetMemory (bank.get());
+		ResonatorBank_filter (bank.get(), x, n, nullptr, nullptr, nullptr, 0);
+	}
+}
+
 void Sound_filterWithFormants (Sound me, double tmin, double tmax,
 	int numberOfFormants, double formant [], double bandwidth [])
 {
 	try {
+		if (tmax <= tmin) { tmin = my xmin; tmax = my xmax; }   // autowindowing
+		integer itmin, itmax;
+		integer n = Sampled_getWindowSamples (me, tmin, tmax, & itmin, & itmax);
+		if (n <= 2)
+			Melder_throw (U"Sound too short.");
+		autoNUMvector <double *> amplitudes (1, my ny);
 		for (integer channel = 1; channel <= my ny; channel ++) {
-			if (tmax <= tmin) { tmin = my xmin; tmax = my xmax; }   // autowindowing
-			integer itmin, itmax;
-			integer n = Sampled_getWindowSamples (me, tmin, tmax, & itmin, & itmax);
-			if (n <= 2)
-				Melder_throw (U"Sound too short.");
-			double *amplitude = my z [channel] + itmin - 1;   // base 1
-			NUMdeemphasize_f (amplitude, n, my dx, 50.0);
-			for (int iformant = 1; iformant <= numberOfFormants; iformant ++) {
-				NUMfilterSecondOrderSection_fb (amplitude, n, my dx, formant [iformant], bandwidth [iformant]);
-			}
+			amplitudes [channel] = my z [channel] + itmin - 1;   // base 1
+			NUMdeemphasize_f (amplitudes [channel], n, my dx, 50.0);
 		}
+		filterChannelsWithFormants (amplitudes.peek(), my ny, n, my dx, numberOfFormants, formant, bandwidth);
 		Matrix_scaleAbsoluteExtremum (me, 0.99);
 	} catch (MelderError) {
 		Melder_throw (me, U": not filtered.");
@@ -1182,9 +1201,8 @@ autoSound Sound_filter_oneFormant (Sound me, double frequency, double bandwidth)
 }
 
 void Sound_filterWithOneFormantInplace (Sound me, double frequency, double bandwidth) {
-	for (integer channel = 1; channel <= my ny; channel ++) {
-		NUMfilterSecondOrderSection_fb (my z [channel], my nx, my dx, frequency, bandwidth);
-	}
+	double formant [2] = { 0.0, frequency }, bandwidths [2] = { 0.0, bandwidth };
+	filterChannelsWithFormants (my z, my ny, my nx, my dx, 1, formant, bandwidths);
 	Matrix_scaleAbsoluteExtremum (me, 0.99);
 }
 
@@ -44,6 +44,7 @@ autoSpectrogram Sound_to_Spectrogram (Sound me, double effectiveAnalysisWidth, d
 	double minimumTimeStep1, double minimumFreqStep1, kSound_to_Spectrogram_windowShape windowType,
 	double maximumTimeOversampling, double maximumFreqOversampling)
 {
+	autoMelderProfileScope profile (U"analysis", U"Sound_to_Spectrogram");
 	try {
 		double nyquist = 0.5 / my dx;
 		double physicalAnalysisWidth =
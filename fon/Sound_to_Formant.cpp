@@ -342,6 +342,7 @@ static autoFormant Sound_to_Formant_any_inplace (Sound me, double dt_in, int num
 autoFormant Sound_to_Formant_any (Sound me, double dt, int numberOfPoles, double maximumFrequency,
 	double halfdt_window, int which, double preemphasisFrequency, double safetyMargin)
 {
+	autoMelderProfileScope profile (U"analysis", U"Sound_to_Formant_any");
 	double nyquist = 0.5 / my dx;
 	autoSound sound;
 	if (maximumFrequency <= 0.0 || fabs (maximumFrequency / nyquist - 1) < 1.0e-12) {
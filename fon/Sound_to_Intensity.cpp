@@ -108,6 +108,7 @@ static autoIntensity Sound_to_Intensity_ (Sound me, double minimumPitch, double
 }
 
 autoIntensity Sound_to_Intensity (Sound me, double minimumPitch, double timeStep, bool subtractMeanPressure) {
+	autoMelderProfileScope profile (U"analysis", U"Sound_to_Intensity");
 	const bool veryAccurate = false;
 	if (veryAccurate) {
 		autoSound up = Sound_upsample (me);   // because squaring doubles the frequency content, i.e. you get super-Nyquist components
@@ -349,6 +349,7 @@ autoPitch Sound_to_Pitch_any (Sound me,
 	double silenceThreshold, double voicingThreshold,
 	double octaveCost, double octaveJumpCost, double voicedUnvoicedCost, double ceiling)
 {
+	autoMelderProfileScope profile (U"analysis", U"Sound_to_Pitch_any");
 	try {
 		autoNUMfft_Table fftTable;
 		double t1;
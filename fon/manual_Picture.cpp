@@ -672,12 +672,13 @@ DEFINITION (U"you can specify a red-green-blue value as three values between 0 a
 	"and separated by commas, e.g. {0.8,0.1,0.2} is something reddish.")
 MAN_END
 
-MAN_BEGIN (U"Picture window", U"ppgb", 20140325)
+MAN_BEGIN (U"Picture window", U"ppgb", 20180514)
 INTRO (U"One of the two main windows in Praat.")
 TAG (U"File menu")
 LIST_ITEM (U"\\bu @@Save as PDF file...")
 LIST_ITEM (U"\\bu @@Save as PNG file...")
 LIST_ITEM (U"\\bu @@Save as EPS file...")
+LIST_ITEM (U"\\bu @@Start saving in background...@, ##Finish saving in background#")
 LIST_ITEM (U"\\bu @@Save as Windows metafile...@")
 LIST_ITEM (U"\\bu @@Read from Praat picture file...@, @@Save as Praat picture file...")
 LIST_ITEM (U"\\bu @@PostScript settings...")
@@ -960,6 +961,31 @@ ENTRY (U"Settings")
 NORMAL (U"The EPS picture is saved with the grey resolution and fonts that you specified with @@PostScript settings...@.")
 MAN_END
 
+MAN_BEGIN (U"Start saving in background...", U"ppgb", 20180514)
+INTRO (U"A command in the File menu of the @@Picture window@, for scripts that save many pictures.")
+NORMAL (U"After this command, @@Save as EPS file...@ no longer waits until the file has been written: "
+	"it opens the file and makes a copy of the picture, "
+	"and the file is then written by one of a number of background threads, "
+	"while your script goes on drawing the next picture.")
+ENTRY (U"Setting")
+TAG (U"##Number of threads")
+DEFINITION (U"the number of EPS files that can be written at the same time. "
+	"It makes sense to take the number of processors of your computer.")
+ENTRY (U"Usage")
+CODE (U"Start saving in background: 4")
+CODE (U"for i to numberOfSounds")
+	CODE1 (U"Erase all")
+	CODE1 (U"selectObject: spectrogram [i]")
+	CODE1 (U"Paint: 0, 0, 0, 0, 100, \"yes\", 50, 6, 0, \"yes\"")
+	CODE1 (U"Save as EPS file: \"figure\" + string$ (i) + \".eps\"")
+CODE (U"endfor")
+CODE (U"Finish saving in background")
+NORMAL (U"##Finish saving in background# waits until all the files have been written, "
+	"so that your script can use them; Praat also waits for them when it quits. "
+	"A file name that cannot be written is reported immediately by ##Save as EPS file...#.")
+NORMAL (U"PDF and PNG files are still written in the foreground.")
+MAN_END
+
 MAN_BEGIN (U"Save as PDF file...", U"ppgb", 20140325)
 INTRO (U"A command in the File menu of the @@Picture window@, on Macintosh and Linux.")
 NORMAL (U"It saves the picture to a PDF file, "
@@ -3463,7 +3463,7 @@ CODE (U"nocheck Remove")
 NORMAL (U"This would cause the script to continue even if there is nothing to remove.")
 MAN_END
 
-MAN_BEGIN (U"Scripting 6.9. Calling from the command line", U"ppgb", 20151031)
+MAN_BEGIN (U"Scripting 6.9. Calling from the command line", U"ppgb", 20180511)
 INTRO (U"Previous sections of this tutorial have shown you how to run a Praat script from the Script window. "
 	"However, you can also call a Praat script from the command line (text console) instead. "
 	"Information that would normally show up in the Info window, then goes to %stdout, "
@@ -3609,7 +3609,19 @@ NORMAL (U"If you call Praat from a web server, you typically do not want to read
 	"To achieve this, you use the ##--no-pref-files# command line option before the script name:")
 CODE (U"system ('/users/apache/praat --run --no-pref-files /user/apache/scripts/computeAnalysis.praat 1234 blibla')")
 
-ENTRY (U"10. All command line options")
+ENTRY (U"10. Running Praat as a script server")
+NORMAL (U"If you have to run very many short scripts, for instance one for each of a hundred thousand sound files, "
+	"starting Praat anew for each script may take more time than the scripts themselves. "
+	"On the Mac and Linux, you can instead start Praat once as a server that listens on a Unix-domain socket:")
+CODE (U"praat --server=/tmp/praat.socket")
+NORMAL (U"Each connection to the socket sends a single line with a script file name and its arguments, "
+	"just as they would follow ##--run# on the command line, and then receives either $$OK$ on a line of its own, "
+	"followed by the contents of the Info window when the script has finished, "
+	"or $$ERROR$ on a line of its own, followed by the error message. "
+	"Every script starts with an empty object list and an empty Info window, and scripts cannot see each other's objects; "
+	"as many scripts run at the same time as your computer has processors, and further connections wait their turn.")
+
+ENTRY (U"11. All command line options")
 TAG (U"##--open")
 DEFINITION (U"Interpret the command line arguments as files to be opened in the GUI.")
 TAG (U"##--run")
@@ -3621,6 +3633,13 @@ DEFINITION (U"Don't activate the plugins at start-up.")
 TAG (U"##--pref-dir=#/var/www/praat_plugins")
 DEFINITION (U"Set the preferences directory to /var/www/praat_plugins (for instance). "
 	"This can come in handy if you require access to preference files and/or plugins that are not in your home directory.")
+TAG (U"##--profile=#profile.json")
+DEFINITION (U"Record the time and the allocations of every script line, command and major analysis, "
+	"and write them to profile.json (a Chrome trace) when Praat quits; with a file name that does not end in .json, "
+	"you get a table sorted by time instead. Within a script, you can do the same with ##Start profiling#, "
+	"##Stop profiling#, ##Report profile# and ##Save profile as Chrome trace file...# from the Technical menu.")
+TAG (U"##--server=#/tmp/praat.socket")
+DEFINITION (U"Run the scripts that come in on the socket /tmp/praat.socket (see above).")
 TAG (U"##--version")
 DEFINITION (U"Print the Praat version.")
 TAG (U"##--help")
@@ -63,6 +63,7 @@
 #include "StringsEditor.h"
 #include "TableEditor.h"
 #include "TextGrid.h"
+#include "TextGrid_Sound.h"
 #include "VocalTract.h"
 #include "VoiceAnalysis.h"
 #include "WordList.h"
@@ -2132,6 +2133,28 @@ DO
 	CONVERT_FOUR_END (U"manip");
 }
 
+FORM (NEW1_Sounds_PitchTiers_DurationTiers_to_Sounds_overlapAdd, U"Resynthesize (overlap-add)", nullptr) {
+	POSITIVE (timeStep, U"Time step (s)", U"0.01")
+	POSITIVE (minimumPitch, U"Minimum pitch (Hz)", U"75.0")
+	POSITIVE (maximumPitch, U"Maximum pitch (Hz)", U"600.0")
+	OK
+DO
+	if (maximumPitch <= minimumPitch) Melder_throw (U"The maximum pitch should be greater than the minimum pitch.");
+	OrderedOf<structSound> sounds;
+	OrderedOf<structPitchTier> pitchTiers;
+	OrderedOf<structDurationTier> durationTiers;
+	LOOP {
+		if (CLASS == classSound) sounds. addItem_ref ((Sound) OBJECT);
+		else if (CLASS == classPitchTier) pitchTiers. addItem_ref ((PitchTier) OBJECT);
+		else if (CLASS == classDurationTier) durationTiers. addItem_ref ((DurationTier) OBJECT);
+	}
+	autoSoundList result = Sounds_PitchTiers_DurationTiers_to_Sounds_overlapAdd (& sounds, & pitchTiers, & durationTiers,
+		timeStep, minimumPitch, maximumPitch);
+	result -> classInfo = classCollection;   // YUCK, in order to force automatic unpacking
+	praat_new (result.move(), U"dummy");
+	END
+}
+
 // MARK: - SPECTROGRAM
 
 FORM (GRAPHICS_Spectrogram_paint, U"Spectrogram: Paint", U"Spectrogram: Paint...") {
@@ -2848,6 +2871,17 @@ DO
 	INFO_NONE_END
 }
 
+FORM (INFO_Praat_benchmarks, U"Praat benchmarks", 0) {
+	SENTENCE (durations, U"Durations (s)", U"1 10")
+	SENTENCE (numbersOfThreads, U"Numbers of threads", U"1 2 4 8")
+	SENTENCE (benchmarks, U"Benchmarks", U"all")
+	OK
+DO
+	INFO_NONE
+		Praat_benchmarks (durations, numbersOfThreads, benchmarks);
+	INFO_NONE_END
+}
+
 // MARK: - Help menu
 
 DIRECT (HELP_ObjectWindow) { HELP (U"Object window") }
@@ -2919,6 +2953,7 @@ void praat_uvafon_init () {
 	structFormantGridEditor  :: f_preferences ();
 
 	praat_addMenuCommand (U"Objects", U"Technical", U"Praat test...", nullptr, 0, INFO_Praat_test);
+	praat_addMenuCommand (U"Objects", U"Technical", U"Praat benchmarks...", nullptr, 0, INFO_Praat_benchmarks);
 
 	/*
 		The user interfaces for the classes are included in the order
@@ -3373,6 +3408,7 @@ praat_addAction1 (classTransition, 0, U"Cast", nullptr, 0, nullptr);
 	praat_addAction2 (classPitch, 1, classSound, 1, U"To Manipulation", nullptr, 0, NEW1_Sound_Pitch_to_Manipulation);
 
 	praat_addAction4 (classDurationTier, 1, classPitchTier, 1, classPointProcess, 1, classSound, 1, U"To Sound...", nullptr, 0, NEW1_Sound_Point_Pitch_Duration_to_Sound);
+	praat_addAction3 (classDurationTier, 0, classPitchTier, 0, classSound, 0, U"Resynthesize (overlap-add)...", nullptr, 0, NEW1_Sounds_PitchTiers_DurationTiers_to_Sounds_overlapAdd);
 
 	INCLUDE_MANPAGES (manual_Manual_init)
 	INCLUDE_MANPAGES (manual_Script_init)
@@ -73,6 +73,7 @@
  */
 
 #include "OTGrammar.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "OTGrammar_def.h"
@@ -298,11 +299,7 @@ Thing_implement (OTGrammar, Daata, 2);
 
 Thing_implement (OTHistory, TableOfReal, 0);
 
-static OTGrammar constraintCompare_grammar;
-
-static int constraintCompare (const void *first, const void *second) {
-	OTGrammar me = constraintCompare_grammar;
-	integer icons = * (integer *) first, jcons = * (integer *) second;
+static int constraintCompare (OTGrammar me, integer icons, integer jcons) {
 	OTGrammarConstraint ci = & my constraints [icons], cj = & my constraints [jcons];
 	/*
 	 * Sort primarily by disharmony.
@@ -316,8 +313,21 @@ static int constraintCompare (const void *first, const void *second) {
 }
 
 void OTGrammar_sort (OTGrammar me) {
-	constraintCompare_grammar = me;
-	qsort (& my index [1], my numberOfConstraints, sizeof (integer), constraintCompare);
+	/*
+	 * Insertion sort, starting from the previous order.
+	 * During learning, the new disharmonies are drawn around rankings that hardly change from datum to datum,
+	 * so once the rankings lie further apart than the evaluation noise,
+	 * most constraints are already in place and only a few of them move by a position or two.
+	 * This also makes sorting thread-safe (no static grammar for a qsort comparison function).
+	 */
+	for (integer icons = 2; icons <= my numberOfConstraints; icons ++) {
+		integer constraintIndex = my index [icons], jcons = icons;
+		while (jcons > 1 && constraintCompare (me, my index [jcons - 1], constraintIndex) > 0) {
+			my index [jcons] = my index [jcons - 1];
+			jcons --;
+		}
+		my index [jcons] = constraintIndex;
+	}
 	for (integer icons = 1; icons <= my numberOfConstraints; icons ++) {
 		OTGrammarConstraint constraint = & my constraints [my index [icons]];
 		constraint -> tiedToTheLeft = icons > 1 &&
@@ -327,11 +337,23 @@ void OTGrammar_sort (OTGrammar me) {
 	}
 }
 
+/*
+ * The random numbers drawn during evaluation and learning come from the grammar's own stream,
+ * so that replicate learners can run in parallel (stream 0 is that of NUMrandomUniform and NUMrandomGauss).
+ */
+static double OTGrammar_randomUniform (OTGrammar me, double lowest, double highest) {
+	return lowest + (highest - lowest) * NUMrandomFraction_mt (my randomStream);
+}
+
+static integer OTGrammar_randomInteger (OTGrammar me, integer lowest, integer highest) {
+	return lowest + (integer) ((highest - lowest + 1) * NUMrandomFraction_mt (my randomStream));
+}
+
 void OTGrammar_newDisharmonies (OTGrammar me, double spreading) {
 	for (integer icons = 1; icons <= my numberOfConstraints; icons ++) {
 		OTGrammarConstraint constraint = & my constraints [icons];
-		constraint -> disharmony = constraint -> ranking + NUMrandomGauss (0, spreading)
-			/*NUMrandomUniform (-spreading, spreading)*/;
+		constraint -> disharmony = constraint -> ranking + NUMrandomGauss_mt (my randomStream, 0, spreading)
+			/*OTGrammar_randomUniform (me, -spreading, spreading)*/;
 	}
 	OTGrammar_sort (me);
 }
@@ -344,41 +366,47 @@ integer OTGrammar_getTableau (OTGrammar me, const char32 *input) {
 	Melder_throw (U"Input \"", input, U"\" not in list of tableaus.");
 }
 
+/*
+ * The factor by which the violations of a constraint add to the disharmony of a candidate
+ * under the non-OT decision strategies.
+ */
+static inline double OTGrammar_constraintWeight (OTGrammar me, integer icons) noexcept {
+	double disharmony = my constraints [icons]. disharmony;
+	switch (my decisionStrategy) {
+		case kOTGrammar_decisionStrategy::HARMONIC_GRAMMAR:
+		case kOTGrammar_decisionStrategy::MAXIMUM_ENTROPY:
+			return disharmony;
+		case kOTGrammar_decisionStrategy::EXPONENTIAL_HG:
+		case kOTGrammar_decisionStrategy::EXPONENTIAL_MAXIMUM_ENTROPY:
+			return exp (disharmony);
+		case kOTGrammar_decisionStrategy::LINEAR_OT:
+			return disharmony > 0.0 ? disharmony : 0.0;
+		case kOTGrammar_decisionStrategy::POSITIVE_HG:
+			return disharmony > 1.0 ? disharmony : 1.0;
+		default:
+			Melder_fatal (U"Unimplemented decision strategy.");
+	}
+	return 0.0;
+}
+
 static void _OTGrammar_fillInHarmonies (OTGrammar me, integer itab) noexcept {
 	if (my decisionStrategy == kOTGrammar_decisionStrategy::OPTIMALITY_THEORY) return;
 	OTGrammarTableau tableau = & my tableaus [itab];
-	for (integer icand = 1; icand <= tableau -> numberOfCandidates; icand ++) {
-		OTGrammarCandidate candidate = & tableau -> candidates [icand];
-		int *marks = candidate -> marks;
-		double disharmony = 0.0;
-		if (my decisionStrategy == kOTGrammar_decisionStrategy::HARMONIC_GRAMMAR ||
-			my decisionStrategy == kOTGrammar_decisionStrategy::MAXIMUM_ENTROPY)
-		{
-			for (integer icons = 1; icons <= my numberOfConstraints; icons ++) {
-				disharmony += my constraints [icons]. disharmony * marks [icons];
-			}
-		} else if (my decisionStrategy == kOTGrammar_decisionStrategy::EXPONENTIAL_HG ||
-			my decisionStrategy == kOTGrammar_decisionStrategy::EXPONENTIAL_MAXIMUM_ENTROPY)
-		{
-			for (integer icons = 1; icons <= my numberOfConstraints; icons ++) {
-				disharmony += exp (my constraints [icons]. disharmony) * marks [icons];
-			}
-		} else if (my decisionStrategy == kOTGrammar_decisionStrategy::LINEAR_OT) {
-			for (integer icons = 1; icons <= my numberOfConstraints; icons ++) {
-				if (my constraints [icons]. disharmony > 0.0) {
-					disharmony += my constraints [icons]. disharmony * marks [icons];
-				}
-			}
-		} else if (my decisionStrategy == kOTGrammar_decisionStrategy::POSITIVE_HG) {
-			for (integer icons = 1; icons <= my numberOfConstraints; icons ++) {
-				double constraintDisharmony = my constraints [icons]. disharmony > 1.0 ? my constraints [icons]. disharmony : 1.0;
-				disharmony += constraintDisharmony * marks [icons];
-			}
-		} else {
-			Melder_fatal (U"_OTGrammar_fillInHarmonies: unimplemented decision strategy.");
+	/*
+	 * Go through the violation matrix constraint by constraint, so that each weight is computed only once;
+	 * each candidate still sums its violations in constraint order.
+	 */
+	for (integer icand = 1; icand <= tableau -> numberOfCandidates; icand ++)
+		tableau -> candidates [icand]. harmony = 0.0;
+	for (integer icons = 1; icons <= my numberOfConstraints; icons ++) {
+		double weight = OTGrammar_constraintWeight (me, icons);
+		for (integer icand = 1; icand <= tableau -> numberOfCandidates; icand ++) {
+			OTGrammarCandidate candidate = & tableau -> candidates [icand];
+			candidate -> harmony += weight * candidate -> marks [icons];   // disharmony, for the time being
 		}
-		candidate -> harmony = - disharmony;
 	}
+	for (integer icand = 1; icand <= tableau -> numberOfCandidates; icand ++)
+		tableau -> candidates [icand]. harmony = - tableau -> candidates [icand]. harmony;
 }
 
 int OTGrammar_compareCandidates (OTGrammar me, integer itab1, integer icand1, integer itab2, integer icand2) noexcept {
@@ -401,46 +429,15 @@ int OTGrammar_compareCandidates (OTGrammar me, integer itab1, integer icand1, in
 		}
 		/* If we arrive here, None of the comparisons found a difference between the two candidates. Hence, they are equally good. */
 		return 0;
-	} else if (my decisionStrategy == kOTGrammar_decisionStrategy::HARMONIC_GRAMMAR ||
-		my decisionStrategy == kOTGrammar_decisionStrategy::MAXIMUM_ENTROPY)
-	{
-		double disharmony1 = 0.0, disharmony2 = 0.0;
-		for (integer icons = 1; icons <= my numberOfConstraints; icons ++) {
-			disharmony1 += my constraints [icons]. disharmony * marks1 [icons];
-			disharmony2 += my constraints [icons]. disharmony * marks2 [icons];
-		}
-		if (disharmony1 < disharmony2) return -1;   // candidate 1 is better than candidate 2
-		if (disharmony1 > disharmony2) return +1;   // candidate 2 is better than candidate 1
-	} else if (my decisionStrategy == kOTGrammar_decisionStrategy::LINEAR_OT) {
-		double disharmony1 = 0.0, disharmony2 = 0.0;
-		for (integer icons = 1; icons <= my numberOfConstraints; icons ++) {
-			if (my constraints [icons]. disharmony > 0.0) {
-				disharmony1 += my constraints [icons]. disharmony * marks1 [icons];
-				disharmony2 += my constraints [icons]. disharmony * marks2 [icons];
-			}
-		}
-		if (disharmony1 < disharmony2) return -1;   // candidate 1 is better than candidate 2
-		if (disharmony1 > disharmony2) return +1;   // candidate 2 is better than candidate 1
-	} else if (my decisionStrategy == kOTGrammar_decisionStrategy::EXPONENTIAL_HG ||
-		my decisionStrategy == kOTGrammar_decisionStrategy::EXPONENTIAL_MAXIMUM_ENTROPY)
-	{
-		double disharmony1 = 0.0, disharmony2 = 0.0;
-		for (integer icons = 1; icons <= my numberOfConstraints; icons ++) {
-			disharmony1 += exp (my constraints [icons]. disharmony) * marks1 [icons];
-			disharmony2 += exp (my constraints [icons]. disharmony) * marks2 [icons];
-		}
-		if (disharmony1 < disharmony2) return -1;   // candidate 1 is better than candidate 2
-		if (disharmony1 > disharmony2) return +1;   // candidate 2 is better than candidate 1
-	} else if (my decisionStrategy == kOTGrammar_decisionStrategy::POSITIVE_HG) {
-		double disharmony1 = 0.0, disharmony2 = 0.0;
-		for (integer icons = 1; icons <= my numberOfConstraints; icons ++) {
-			double constraintDisharmony = my constraints [icons]. disharmony > 1.0 ? my constraints [icons]. disharmony : 1.0;
-			disharmony1 += constraintDisharmony * marks1 [icons];
-			disharmony2 += constraintDisharmony * marks2 [icons];
-		}
-		if (disharmony1 < disharmony2) return -1;   // candidate 1 is better than candidate 2
-		if (disharmony1 > disharmony2) return +1;   // candidate 2 is better than candidate 1
-	} else Melder_fatal (U"Unimplemented decision strategy.");
+	}
+	double disharmony1 = 0.0, disharmony2 = 0.0;
+	for (integer icons = 1; icons <= my numberOfConstraints; icons ++) {
+		double weight = OTGrammar_constraintWeight (me, icons);
+		disharmony1 += weight * marks1 [icons];
+		disharmony2 += weight * marks2 [icons];
+	}
+	if (disharmony1 < disharmony2) return -1;   // candidate 1 is better than candidate 2
+	if (disharmony1 > disharmony2) return +1;   // candidate 2 is better than candidate 1
 	return 0;   // the two total disharmonies are equal
 }
 
@@ -477,7 +474,7 @@ integer OTGrammar_getWinner (OTGrammar me, integer itab) noexcept {
 	{
 		_OTGrammar_fillInHarmonies (me, itab);
 		_OTGrammar_fillInProbabilities (me, itab);
-		double cutOff = NUMrandomUniform (0.0, 1.0);
+		double cutOff = OTGrammar_randomUniform (me, 0.0, 1.0);
 		double sumOfProbabilities = 0.0;
 		for (integer icand = 1; icand <= my tableaus [itab]. numberOfCandidates; icand ++) {
 			sumOfProbabilities += my tableaus [itab]. candidates [icand]. probability;
@@ -487,9 +484,19 @@ integer OTGrammar_getWinner (OTGrammar me, integer itab) noexcept {
 			}
 		}
 	} else {
+		/*
+		 * Under the harmonic strategies, every candidate's disharmony is computed once,
+		 * instead of once for every comparison it takes part in.
+		 */
+		bool harmonic = ( my decisionStrategy != kOTGrammar_decisionStrategy::OPTIMALITY_THEORY );
+		if (harmonic)
+			_OTGrammar_fillInHarmonies (me, itab);
+		OTGrammarCandidate candidates = my tableaus [itab]. candidates;
 		integer numberOfBestCandidates = 1;
 		for (integer icand = 2; icand <= my tableaus [itab]. numberOfCandidates; icand ++) {
-			int comparison = OTGrammar_compareCandidates (me, itab, icand, itab, icand_best);
+			int comparison = ! harmonic ? OTGrammar_compareCandidates (me, itab, icand, itab, icand_best) :
+				candidates [icand]. harmony > candidates [icand_best]. harmony ? -1 :
+				candidates [icand]. harmony < candidates [icand_best]. harmony ? +1 : 0;
 			if (comparison == -1) {
 				icand_best = icand;   // the current candidate is the unique best candidate found so far
 				numberOfBestCandidates = 1;
@@ -502,7 +509,7 @@ integer OTGrammar_getWinner (OTGrammar me, integer itab) noexcept {
 					icand_best = icand_best;   // keep first
 				} else if (Melder_debug == 42) {
 					icand_best = icand;   // take last
-				} else if (NUMrandomUniform (0.0, numberOfBestCandidates) < 1.0) {   // default: take random
+				} else if (OTGrammar_randomUniform (me, 0.0, numberOfBestCandidates) < 1.0) {   // default: take random
 					icand_best = icand;
 				}
 			}
@@ -572,7 +579,7 @@ void OTGrammar_getInterpretiveParse (OTGrammar me, const char32 *partialOutput,
 							} else if (Melder_debug == 42) {
 								itab_best = itab;
 								icand_best = icand;   // take last
-							} else if (NUMrandomUniform (0.0, numberOfBestCandidates) < 1.0) {   // default: take random
+							} else if (OTGrammar_randomUniform (me, 0.0, numberOfBestCandidates) < 1.0) {   // default: take random
 								itab_best = itab;
 								icand_best = icand;
 							}
@@ -619,7 +626,7 @@ static void OTGrammar_getInterpretiveParse_opt (OTGrammar me, integer ipartialOu
 							} else if (Melder_debug == 42) {
 								itab_best = itab;
 								icand_best = icand;   // take last
-							} else if (NUMrandomUniform (0.0, numberOfBestCandidates) < 1.0) {   // default: take random
+							} else if (OTGrammar_randomUniform (me, 0.0, numberOfBestCandidates) < 1.0) {   // default: take random
 								itab_best = itab;
 								icand_best = icand;
 							}
@@ -1216,8 +1223,8 @@ autoDistributions OTGrammar_measureTypology_WEAK (OTGrammar me) {
 	}
 }
 
-static double learningStep (double mean, double relativeSpreading) {
-	return relativeSpreading == 0.0 ? mean : NUMrandomGauss (mean, relativeSpreading * mean);
+static double learningStep (OTGrammar me, double mean, double relativeSpreading) {
+	return relativeSpreading == 0.0 ? mean : NUMrandomGauss_mt (my randomStream, mean, relativeSpreading * mean);
 }
 
 static void OTGrammar_honourLocalRankings (OTGrammar me, double plasticity, double relativePlasticityNoise, bool *grammarHasChanged) {
@@ -1228,7 +1235,7 @@ static void OTGrammar_honourLocalRankings (OTGrammar me, double plasticity, doub
 			OTGrammarFixedRanking fixedRanking = & my fixedRankings [irank];
 			OTGrammarConstraint higher = & my constraints [fixedRanking -> higher], lower = & my constraints [fixedRanking -> lower];
 			while (higher -> ranking <= lower -> ranking) {
-				lower -> ranking -= learningStep (plasticity, relativePlasticityNoise);
+				lower -> ranking -= learningStep (me, plasticity, relativePlasticityNoise);
 				if (grammarHasChanged) *grammarHasChanged = true;
 				improved = true;
 			}
@@ -1243,7 +1250,7 @@ static void OTGrammar_modifyRankings (OTGrammar me, integer itab, integer iwinne
 	try {
 		OTGrammarTableau tableau = & my tableaus [itab];
 		OTGrammarCandidate winner = & tableau -> candidates [iwinner], adult = & tableau -> candidates [iadult];
-		double step = learningStep (plasticity, relativePlasticityNoise);
+		double step = learningStep (me, plasticity, relativePlasticityNoise);
 		bool multiplyStepByNumberOfViolations =
 			my decisionStrategy == kOTGrammar_decisionStrategy::HARMONIC_GRAMMAR ||
 			my decisionStrategy == kOTGrammar_decisionStrategy::LINEAR_OT ||
@@ -1259,7 +1266,7 @@ static void OTGrammar_modifyRankings (OTGrammar me, integer itab, integer iwinne
 			else if (Melder_debug == 27) multiplyStepByNumberOfViolations = true;   // HG-GLA
 		}
 		if (updateRule == kOTGrammar_rerankingStrategy::SYMMETRIC_ONE) {
-			integer icons = NUMrandomInteger (1, my numberOfConstraints);
+			integer icons = OTGrammar_randomInteger (me, 1, my numberOfConstraints);
 			OTGrammarConstraint constraint = & my constraints [icons];
 			double constraintStep = step * constraint -> plasticity;
 			int winnerMarks = winner -> marks [icons];
@@ -1737,6 +1744,8 @@ void OTGrammar_PairDistribution_learn (OTGrammar me, PairDistribution thee,
 	integer idatum = 0, numberOfData = numberOfPlasticities * replicationsPerPlasticity;
 	try {
 		double plasticity = initialPlasticity;
+		autoNUMvector <double> cumulativeWeights (1, thy pairs.size);
+		PairDistribution_getCumulativeWeights (thee, cumulativeWeights.peek());
 		autoMelderMonitor monitor (U"Learning with full knowledge...");
 		if (monitor.graphics()) {
 			Graphics_clearWs (monitor.graphics());
@@ -1744,7 +1753,7 @@ void OTGrammar_PairDistribution_learn (OTGrammar me, PairDistribution thee,
 		for (integer iplasticity = 1; iplasticity <= numberOfPlasticities; iplasticity ++) {
 			for (integer ireplication = 1; ireplication <= replicationsPerPlasticity; ireplication ++) {
 				char32 *input, *output;
-				PairDistribution_peekPair (thee, & input, & output);
+				PairDistribution_peekPair_mt (thee, cumulativeWeights.peek(), 0, & input, & output);
 				++ idatum;
 				if (monitor.graphics() && idatum % (numberOfData / 400 + 1) == 0) {
 					Graphics_beginMovieFrame (monitor.graphics(), nullptr);
@@ -1774,6 +1783,135 @@ void OTGrammar_PairDistribution_learn (OTGrammar me, PairDistribution thee,
 	}
 }
 
+Thing_define (OTGrammar_Batch_Args, Thing) { public:
+	OrderedOf<structOTGrammar> *grammars;
+	PairDistribution pairs;
+	const double *cumulativeWeights;
+	double evaluationNoise;
+	enum kOTGrammar_rerankingStrategy updateRule;
+	bool honourLocalRankings;
+	double initialPlasticity;
+	integer replicationsPerPlasticity;
+	double plasticityDecrement;
+	integer numberOfPlasticities;
+	double relativePlasticityNoise;
+	integer numberOfChews;
+	const uint64 *seeds;
+	integer firstGrammar, grammarStep;
+	int threadNumber;
+	bool isMainThread;
+	volatile int *cancelled;
+};
+
+Thing_implement (OTGrammar_Batch_Args, Thing, 0);
+
+static MelderThread_RETURN_TYPE OTGrammar_Batch_learn (OTGrammar_Batch_Args me) {
+	try {
+		integer numberOfData = my numberOfPlasticities * my replicationsPerPlasticity;
+		integer numberOfOwnGrammars = (my grammars -> size - my firstGrammar) / my grammarStep + 1;
+		for (integer igram = my firstGrammar; igram <= my grammars -> size; igram += my grammarStep) {
+			OTGrammar grammar = my grammars -> at [igram];
+			grammar -> randomStream = my threadNumber;
+			NUMrandom_setSeed_mt (my threadNumber, my seeds [igram]);
+			integer idatum = 0;
+			double plasticity = my initialPlasticity;
+			for (integer iplasticity = 1; iplasticity <= my numberOfPlasticities; iplasticity ++) {
+				for (integer ireplication = 1; ireplication <= my replicationsPerPlasticity; ireplication ++) {
+					if (*my cancelled) MelderThread_RETURN;
+					char32 *input, *output;
+					PairDistribution_peekPair_mt (my pairs, my cumulativeWeights, my threadNumber, & input, & output);
+					++ idatum;
+					if (my isMainThread && idatum % (numberOfData / 100 + 1) == 0)
+						Melder_progress (((igram - my firstGrammar) / my grammarStep + (double) idatum / numberOfData) / numberOfOwnGrammars,
+							U"Grammar ", igram, U": processing input-output pair ", idatum, U" out of ", numberOfData, U".");
+					for (integer ichew = 1; ichew <= my numberOfChews; ichew ++) {
+						OTGrammar_learnOne (grammar, input, output,
+							my evaluationNoise, my updateRule, my honourLocalRankings,
+							plasticity, my relativePlasticityNoise, true, false, nullptr);
+					}
+				}
+				plasticity *= my plasticityDecrement;
+			}
+			grammar -> randomStream = 0;
+		}
+	} catch (MelderError) {
+		*my cancelled = 1;
+		if (my isMainThread) throw;
+	}
+	MelderThread_RETURN;
+}
+
+void OTGrammars_PairDistribution_learn (OrderedOf<structOTGrammar> *grammars, PairDistribution thee,
+	double evaluationNoise, enum kOTGrammar_rerankingStrategy updateRule, bool honourLocalRankings,
+	double initialPlasticity, integer replicationsPerPlasticity, double plasticityDecrement,
+	integer numberOfPlasticities, double relativePlasticityNoise, integer numberOfChews)
+{
+	try {
+		integer numberOfGrammars = grammars -> size;
+		if (numberOfGrammars == 0)
+			Melder_throw (U"No grammars to learn.");
+		for (integer igram = 1; igram <= numberOfGrammars; igram ++)
+			for (integer jgram = 1; jgram < igram; jgram ++)
+				if (grammars -> at [jgram] == grammars -> at [igram])
+					Melder_throw (U"The grammars should be distinct objects.");
+
+		/*
+			The learners are independent, so they are divided over the threads.
+			Each thread draws evaluation noise, tie breaks and data from its own random-number stream,
+			which is reseeded for every grammar from a seed drawn here beforehand,
+			so that the outcome for each grammar does not depend on the number of threads.
+			The warnings about stalled learning cannot be issued from other threads, so the workers do not ask for them.
+		*/
+		int numberOfThreads = MelderThread_getNumberOfProcessors ();
+		if (numberOfThreads > numberOfGrammars) numberOfThreads = numberOfGrammars;
+		if (numberOfThreads > 16) numberOfThreads = 16;
+		if (numberOfThreads < 1) numberOfThreads = 1;
+		autoNUMvector <double> cumulativeWeights (1, thy pairs.size);
+		PairDistribution_getCumulativeWeights (thee, cumulativeWeights.peek());
+		autoNUMvector <uint64> seeds (1, numberOfGrammars);
+		for (integer igram = 1; igram <= numberOfGrammars; igram ++)
+			seeds [igram] = (uint64) (NUMrandomFraction () * 9007199254740992.0);   // 53 random bits
+		autoOTGrammar_Batch_Args args [16];
+		volatile int cancelled = 0;
+		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			autoOTGrammar_Batch_Args arg = Thing_new (OTGrammar_Batch_Args);
+			arg -> grammars = grammars;
+			arg -> pairs = thee;
+			arg -> cumulativeWeights = cumulativeWeights.peek();
+			arg -> evaluationNoise = evaluationNoise;
+			arg -> updateRule = updateRule;
+			arg -> honourLocalRankings = honourLocalRankings;
+			arg -> initialPlasticity = initialPlasticity;
+			arg -> replicationsPerPlasticity = replicationsPerPlasticity;
+			arg -> plasticityDecrement = plasticityDecrement;
+			arg -> numberOfPlasticities = numberOfPlasticities;
+			arg -> relativePlasticityNoise = relativePlasticityNoise;
+			arg -> numberOfChews = numberOfChews;
+			arg -> seeds = seeds.peek();
+			arg -> firstGrammar = ithread;
+			arg -> grammarStep = numberOfThreads;
+			arg -> threadNumber = ithread;
+			arg -> isMainThread = ( ithread == numberOfThreads );
+			arg -> cancelled = & cancelled;
+			args [ithread - 1] = arg.move();
+		}
+		autoMelderProgress progress (U"Learning with full knowledge...");
+		try {
+			MelderThread_run (OTGrammar_Batch_learn, args, numberOfThreads);
+		} catch (MelderError) {
+			for (integer igram = 1; igram <= numberOfGrammars; igram ++)
+				grammars -> at [igram] -> randomStream = 0;
+			throw;
+		}
+		for (integer igram = 1; igram <= numberOfGrammars; igram ++)
+			grammars -> at [igram] -> randomStream = 0;
+		if (cancelled)
+			Melder_throw (U"Learning interrupted.");
+	} catch (MelderError) {
+		Melder_throw (U"Grammars did not complete learning from ", thee, U".");
+	}
+}
+
 static integer PairDistribution_getNumberOfAttestedOutputs (PairDistribution me, const char32 *input, char32 **attestedOutput) {
 	integer result = 0;
 	for (integer ipair = 1; ipair <= my pairs.size; ipair ++) {
@@ -2287,9 +2425,11 @@ double OTGrammar_PairDistribution_getFractionCorrect (OTGrammar me, PairDistribu
 {
 	try {
 		integer numberOfCorrect = 0;
+		autoNUMvector <double> cumulativeWeights (1, thy pairs.size);
+		PairDistribution_getCumulativeWeights (thee, cumulativeWeights.peek());
 		for (integer ireplication = 1; ireplication <= numberOfInputs; ireplication ++) {
 			char32 *input, *adultOutput;
-			PairDistribution_peekPair (thee, & input, & adultOutput);
+			PairDistribution_peekPair_mt (thee, cumulativeWeights.peek(), 0, & input, & adultOutput);
 			OTGrammar_newDisharmonies (me, evaluationNoise);
 			integer inputTableau = OTGrammar_getTableau (me, input);
 			OTGrammarCandidate learnerCandidate = & my tableaus [inputTableau]. candidates [OTGrammar_getWinner (me, inputTableau)];
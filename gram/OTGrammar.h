@@ -36,6 +36,7 @@ void OTGrammar_sort (OTGrammar me);
  *      my constraints [my index [i]]. disharmony >= my constraints [my index [i+1]]. disharmony
  * Therefore, call after every direct assignment to the 'disharmony' attribute.
  * Tied constraints are sorted alphabetically.
+ * The sort starts from the current order, so it is cheap if few constraints have changed places.
  */
 
 void OTGrammar_newDisharmonies (OTGrammar me, double spreading);
@@ -100,6 +101,11 @@ void OTGrammar_PairDistribution_learn (OTGrammar me, PairDistribution thee,
 	double evaluationNoise, enum kOTGrammar_rerankingStrategy updateRule, bool honourLocalRankings,
 	double initialPlasticity, integer replicationsPerPlasticity, double plasticityDecrement,
 	integer numberOfPlasticities, double relativePlasticityNoise, integer numberOfChews);
+void OTGrammars_PairDistribution_learn (OrderedOf<structOTGrammar> *grammars, PairDistribution thee,
+	double evaluationNoise, enum kOTGrammar_rerankingStrategy updateRule, bool honourLocalRankings,
+	double initialPlasticity, integer replicationsPerPlasticity, double plasticityDecrement,
+	integer numberOfPlasticities, double relativePlasticityNoise, integer numberOfChews);
+	/* As OTGrammar_PairDistribution_learn for each of the (independent) grammars, in parallel and without a monitor. */
 bool OTGrammar_PairDistribution_findPositiveWeights_e (OTGrammar me, PairDistribution thee, double weightFloor, double marginOfSeparation);
 void OTGrammar_learnOneFromPartialOutput (OTGrammar me, const char32 *partialAdultOutput,
 	double rankingSpreading, enum kOTGrammar_rerankingStrategy updateRule, bool honourLocalRankings,
@@ -103,6 +103,8 @@ oo_DEFINE_CLASS (OTGrammar, Daata)
 	#endif
 
 	#if oo_DECLARING
+		int randomStream;   // not read or written; 0 except during OTGrammars_PairDistribution_learn ()
+
 		void v_info ()
 			override;
 	#endif
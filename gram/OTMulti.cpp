@@ -898,10 +898,12 @@ void OTMulti_PairDistribution_learn (OTMulti me, PairDistribution thee, double e
 		if (storeHistoryEvery) {
 			history = OTMulti_createHistory (me, storeHistoryEvery, numberOfData);
 		}
+		autoNUMvector <double> cumulativeWeights (1, thy pairs.size);
+		PairDistribution_getCumulativeWeights (thee, cumulativeWeights.peek());
 		for (integer iplasticity = 1; iplasticity <= numberOfPlasticities; iplasticity ++) {
 			for (integer ireplication = 1; ireplication <= replicationsPerPlasticity; ireplication ++) {
 				char32 *form1, *form2;
-				PairDistribution_peekPair (thee, & form1, & form2);
+				PairDistribution_peekPair_mt (thee, cumulativeWeights.peek(), 0, & form1, & form2);
 				++ idatum;
 				if (monitor.graphics() && idatum % (numberOfData / 400 + 1) == 0) {
 					integer numberOfDrawnConstraints = my numberOfConstraints < 14 ? my numberOfConstraints : 14;
@@ -927,6 +927,10 @@ DEFINITION (U"if this is on, the fixed rankings that you supplied in the grammar
 TAG (U"%%Number of chews% (standard value: 1)")
 DEFINITION (U"the number of times that each input-output pair is fed to the grammar. Setting this number to 20 "
 	"will give a slightly different (perhaps more accurate) result than simply raising the plasticity by a factor of 20.")
+NORMAL (U"If you select more than one @OTGrammar together with the @PairDistribution, each grammar learns "
+	"independently from its own stream of input/output pairs, as if you had clicked ##Learn...# for each of them in turn; "
+	"this is a quick way to simulate a group of learners, because the grammars are divided over the processors of your computer. "
+	"No learning curve is drawn in that case, and warnings about stalled learning are not given.")
 MAN_END
 
 MAN_BEGIN (U"OT learning 7. Learning from overt forms", U"ppgb", 20031220)
@@ -1145,12 +1145,27 @@ FORM (MODIFY_OTGrammar_PairDistribution_learn, U"OTGrammar & PairDistribution: L
 	NATURAL (numberOfChews, U"Number of chews", U"1")
 	OK
 DO
-	MODIFY_FIRST_OF_TWO_WEAK (OTGrammar, PairDistribution)
-		OTGrammar_PairDistribution_learn (me, you,
-			evaluationNoise, (enum kOTGrammar_rerankingStrategy) updateRule, honourLocalRankings,
-			initialPlasticity, replicationsPerPlasticity,
-			plasticityDecrement, numberOfPlasticities, relativePlasticitySpreading, numberOfChews);
-	MODIFY_FIRST_OF_TWO_WEAK_END
+	FIND_ONE_AND_LIST (PairDistribution, OTGrammar)
+	try {
+		if (list.size == 1) {
+			OTGrammar_PairDistribution_learn (list.at [1], me,
+				evaluationNoise, (enum kOTGrammar_rerankingStrategy) updateRule, honourLocalRankings,
+				initialPlasticity, replicationsPerPlasticity,
+				plasticityDecrement, numberOfPlasticities, relativePlasticitySpreading, numberOfChews);
+		} else {
+			OTGrammars_PairDistribution_learn (& list, me,
+				evaluationNoise, (enum kOTGrammar_rerankingStrategy) updateRule, honourLocalRankings,
+				initialPlasticity, replicationsPerPlasticity,
+				plasticityDecrement, numberOfPlasticities, relativePlasticitySpreading, numberOfChews);
+		}
+		for (integer igram = 1; igram <= list.size; igram ++)
+			praat_dataChanged (list.at [igram]);
+	} catch (MelderError) {
+		for (integer igram = 1; igram <= list.size; igram ++)
+			praat_dataChanged (list.at [igram]);
+		throw;
+	}
+	END_NO_NEW_DATA
 }
 
 DIRECT (LIST_OTGrammar_PairDistribution_listObligatoryRankings) {
@@ -1817,7 +1832,7 @@ void praat_uvafon_gram_init () {
 	praat_addAction2 (classOTGrammar, 1, classDistributions, 1, U"Learn from partial outputs (wrip)...", nullptr, 0, MODIFY_OTGrammar_Distributions_learnFromPartialOutputs_wrip);
 	praat_addAction2 (classOTGrammar, 1, classDistributions, 1, U"Get fraction correct...", nullptr, 0, REAL_MODIFY_OTGrammar_Distributions_getFractionCorrect);
 	praat_addAction2 (classOTGrammar, 1, classDistributions, 1, U"List obligatory rankings...", nullptr, praat_HIDDEN, LIST_OTGrammar_Distributions_listObligatoryRankings);
-	praat_addAction2 (classOTGrammar, 1, classPairDistribution, 1, U"Learn...", nullptr, 0, MODIFY_OTGrammar_PairDistribution_learn);
+	praat_addAction2 (classOTGrammar, 0, classPairDistribution, 1, U"Learn...", nullptr, 0, MODIFY_OTGrammar_PairDistribution_learn);
 	praat_addAction2 (classOTGrammar, 1, classPairDistribution, 1, U"Find positive weights...", nullptr, 0, MODIFY_OTGrammar_PairDistribution_findPositiveWeights);
 	praat_addAction2 (classOTGrammar, 1, classPairDistribution, 1, U"Get fraction correct...", nullptr, 0, REAL_MODIFY_OTGrammar_PairDistribution_getFractionCorrect);
 	praat_addAction2 (classOTGrammar, 1, classPairDistribution, 1, U"Get minimum number correct...", nullptr, 0, INTEGER_MODIFY_OTGrammar_PairDistribution_getMinimumNumberCorrect);
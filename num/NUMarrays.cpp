@@ -17,8 +17,9 @@
  */
 
 #include "melder.h"
+#include <atomic>
 
-static integer theTotalNumberOfArrays;
+static std::atomic <integer> theTotalNumberOfArrays (0);   // atomic, because arrays can be created in several threads at a time
 
 integer NUM_getTotalNumberOfArrays () { return theTotalNumberOfArrays; }
 
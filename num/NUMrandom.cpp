@@ -182,6 +182,13 @@ void NUMrandom_init () {
 	theInited = true;
 }
 
+void NUMrandom_setSeed_mt (int threadNumber, uint64 seed) {
+	Melder_assert (threadNumber >= 0 && threadNumber <= 16);
+	NUMrandom_State *me = & states [threadNumber];
+	my init_genrand64 (seed);
+	my secondAvailable = false;
+}
+
 /* Throughout the years, several versions for "zero or magic" have been proposed. Choose the fastest. */
 
 #define ZERO_OR_MAGIC_VERSION  3
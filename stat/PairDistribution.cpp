@@ -203,6 +203,41 @@ void PairDistribution_peekPair (PairDistribution me, char32 **string1, char32 **
 	}
 }
 
+void PairDistribution_getCumulativeWeights (PairDistribution me, double cumulativeWeights []) {
+	double sum = 0.0;
+	for (integer ipair = 1; ipair <= my pairs.size; ipair ++) {
+		sum += my pairs.at [ipair] -> weight;
+		cumulativeWeights [ipair] = sum;
+	}
+}
+
+void PairDistribution_peekPair_mt (PairDistribution me, const double cumulativeWeights [], int threadNumber, char32 **string1, char32 **string2) {
+	try {
+		*string1 = *string2 = nullptr;
+		integer nin = my pairs.size, iin;
+		if (nin < 1) Melder_throw (U"No candidates.");
+		double total = cumulativeWeights [nin];
+		do {
+			double rand = total * NUMrandomFraction_mt (threadNumber);   // as NUMrandomUniform (0, total)
+			/*
+				Find the first pair whose cumulative weight is at least 'rand'.
+			*/
+			integer ilow = 1, ihigh = nin + 1;
+			while (ilow < ihigh) {
+				integer imid = (ilow + ihigh) / 2;
+				if (rand <= cumulativeWeights [imid]) ihigh = imid; else ilow = imid + 1;
+			}
+			iin = ilow;
+		} while (iin > nin);   // guard against rounding errors
+		PairProbability prob = my pairs.at [iin];
+		if (! prob -> string1 || ! prob -> string2) Melder_throw (U"No string in probability pair ", iin, U".");
+		*string1 = prob -> string1;
+		*string2 = prob -> string2;
+	} catch (MelderError) {
+		Melder_throw (me, U": pair not peeked.");
+	}
+}
+
 static double PairDistribution_getFractionCorrect (PairDistribution me, int which) {
 	try {
 		double correct = 0.0;
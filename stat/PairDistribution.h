@@ -38,6 +38,12 @@ void PairDistribution_add (PairDistribution me, const char32 *string1, const cha
 void PairDistribution_removeZeroWeights (PairDistribution me);
 void PairDistribution_to_Stringses (PairDistribution me, integer nout, autoStrings *strings1, autoStrings *strings2);
 void PairDistribution_peekPair (PairDistribution me, char32 **string1, char32 **string2);
+void PairDistribution_getCumulativeWeights (PairDistribution me, double cumulativeWeights [] /* [1..pairs.size] */);
+void PairDistribution_peekPair_mt (PairDistribution me, const double cumulativeWeights [], int threadNumber, char32 **string1, char32 **string2);
+	/*
+		As PairDistribution_peekPair, but by a binary search in the cumulative weights (which should not change in the meantime),
+		drawing from random stream 'threadNumber' (0 = that of PairDistribution_peekPair, which then yields the same pair).
+	*/
 
 void PairDistribution_swapInputsAndOutputs (PairDistribution me);
 
@@ -1937,14 +1937,13 @@ static void Formula_optimizeFlow ()
 }
 
 static int praat_findObjectById (integer id) {
-	int IOBJECT;
-	WHERE_DOWN (ID == id)
-		return IOBJECT;
-	Melder_throw (U"No object with number ", id, U".");
+	int IOBJECT = praat_objectPositionFromId (id);
+	if (IOBJECT == 0)
+		Melder_throw (U"No object with number ", id, U".");
+	return IOBJECT;
 }
 
 static int praat_findObjectFromString (const char32 *name) {
-	int IOBJECT;
 	if (*name >= U'A' && *name <= U'Z') {
 		/*
 		 * Find the object by its name.
@@ -1956,17 +1955,13 @@ static int praat_findObjectFromString (const char32 *name) {
 			Melder_throw (U"Missing space in object name \"", name, U"\".");
 		*space = U'\0';
 		char32 *className = & buffer.string [0], *givenName = space + 1;
-		WHERE_DOWN (1) {
-			Daata object = OBJECT;
-			if (str32equ (className, Thing_className (OBJECT)) && str32equ (givenName, object -> name))
-				return IOBJECT;
-		}
+		int IOBJECT = praat_objectPositionFromName (className, givenName);
+		if (IOBJECT != 0)
+			return IOBJECT;
 		ClassInfo klas = Thing_classFromClassName (className, nullptr);
-		WHERE_DOWN (1) {
-			Daata object = OBJECT;
-			if (str32equ (klas -> className, Thing_className (OBJECT)) && str32equ (givenName, object -> name))
-				return IOBJECT;
-		}
+		IOBJECT = praat_objectPositionFromName (klas -> className, givenName);
+		if (IOBJECT != 0)
+			return IOBJECT;
 	}
 	Melder_throw (U"No object with name \"", name, U"\".");
 }
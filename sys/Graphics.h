@@ -363,6 +363,8 @@ void *Graphics_x_getGC (Graphics me);
 bool Graphics_startRecording (Graphics me);
 bool Graphics_stopRecording (Graphics me);
 void Graphics_clearRecording (Graphics me);
+autoGraphics Graphics_copyRecording (Graphics me);
+	/* A Graphics without output device, holding a copy of my recording; it can be played in another thread. */
 void Graphics_play (Graphics from, Graphics to);
 void Graphics_writeRecordings (Graphics me, FILE *f);
 void Graphics_readRecordings (Graphics me, FILE *f);
@@ -178,7 +178,7 @@ autoGraphics Graphics_create_postscriptjob (MelderFile file, int resolution, kGr
 
 #if defined (macintosh)
 static int Eps_postScript_printf (void *stream, const char *format, ... ) {
-	static char theLine [3002];
+	char theLine [3002];   // not static: background savers print to their own files at the same time
 	char *p;
 	va_list args;
 	va_start (args, format);
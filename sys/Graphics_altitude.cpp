@@ -31,12 +31,12 @@ static int empty (double **data, int **right, int **below, integer row1, integer
 #define MAXALTSIDE  50
 #define MAXALTPATH  (2 * MAXALTSIDE * (MAXALTSIDE - 1) + 2)
 
-static integer numberOfPoints;
-static integer row1, row2, col1, col2;
-static int **right, **below;
-static double *x, *y;
-static int closed;
-static double dx, dy, xoff, yoff;
+static thread_local integer numberOfPoints;
+static thread_local integer row1, row2, col1, col2;
+static thread_local autoNUMmatrix <int> right, below;
+static thread_local autoNUMvector <double> x, y;
+static thread_local int closed;
+static thread_local double dx, dy, xoff, yoff;
 
 static int note (double **z, double height, int row, int col, int ori, int pleaseForget) {
 	++ numberOfPoints;
@@ -65,7 +65,7 @@ static void makeContour (Graphics graphics, double **z, double height, int row0,
 		clockwise = ! (ori & 1);
 		do {   /* Preference for contours perpendicular to x == y. */
 			ori = (clockwise ? ori : ori + 2) % 4 + 1;
-		} while (! empty (z, right, below, row1, col1, height, row, col, ori));
+		} while (! empty (z, right.peek(), below.peek(), row1, col1, height, row, col, ori));
 		if (! closed) switch (ori) {
 			case 1: edge = row == row1; break;
 			case 2: edge = col == col2 - 1; break;
@@ -97,16 +97,16 @@ static void smallAlt (Graphics graphics, double **z, double height) {
 
 	closed = 0;
 	for (col = col1; col < col2; col ++)
-		if (empty (z, right, below, row1, col1, height, row1, col, 1))
+		if (empty (z, right.peek(), below.peek(), row1, col1, height, row1, col, 1))
 			makeContour (graphics, z, height, row1, col, 1);
 	for (row = row1; row < row2; row ++)
-		if (empty (z, right, below, row1, col1, height, row, col2 - 1, 2))
+		if (empty (z, right.peek(), below.peek(), row1, col1, height, row, col2 - 1, 2))
 			makeContour (graphics, z, height, row, col2 - 1, 2);
 	for (col = col2 - 1; col >= col1; col --)
-		if (empty (z, right, below, row1, col1, height, row2 - 1, col, 3))
+		if (empty (z, right.peek(), below.peek(), row1, col1, height, row2 - 1, col, 3))
 			makeContour (graphics, z, height, row2 - 1, col, 3);
 	for (row = row2 - 1; row >= row1; row --)
-		if (empty (z, right, below, row1, col1, height, row, col1, 4))
+		if (empty (z, right.peek(), below.peek(), row1, col1, height, row, col1, 4))
 			makeContour (graphics, z, height, row, col1, 4);
 
 	/* Find all the closed contours of this border value. */
@@ -114,11 +114,11 @@ static void smallAlt (Graphics graphics, double **z, double height) {
 	closed = 1;
 	for (row = row1 + 1; row < row2; row ++)
 		for (col = col1; col < col2; col ++)
-			if (empty (z, right, below, row1, col1, height, row, col, 1))
+			if (empty (z, right.peek(), below.peek(), row1, col1, height, row, col, 1))
 				makeContour (graphics, z, height, row, col, 1);
 	for (col = col1 + 1; col < col2; col ++)
 		for (row = row1; row < row2; row ++)
-			if (empty (z, right, below, row1, col1, height, row, col, 4))
+			if (empty (z, right.peek(), below.peek(), row1, col1, height, row, col, 4))
 				makeContour (graphics, z, height, row, col, 4);
 }
 
@@ -132,11 +132,11 @@ void Graphics_contour (Graphics me, double **z,
 	dy = (y2WC - y1WC) / (iy2 - iy1);
 	xoff = x1WC - ix1 * dx;
 	yoff = y1WC - iy1 * dy;
-	if (! right) {   // static!
-		right = NUMmatrix <int> (0, MAXALTSIDE - 1, 0, MAXALTSIDE - 1);
-		below = NUMmatrix <int> (0, MAXALTSIDE - 1, 0, MAXALTSIDE - 1);
-		x = NUMvector <double> (1, MAXALTPATH);
-		y = NUMvector <double> (1, MAXALTPATH);
+	if (! right.peek()) {   // static!
+		right. reset (0, MAXALTSIDE - 1, 0, MAXALTSIDE - 1);
+		below. reset (0, MAXALTSIDE - 1, 0, MAXALTSIDE - 1);
+		x. reset (1, MAXALTPATH);
+		y. reset (1, MAXALTPATH);
 	}
 	for (row1 = iy1; row1 < iy2; row1 += MAXALTSIDE - 1) {
 		for (col1 = ix1; col1 < ix2; col1 += MAXALTSIDE - 1) {
@@ -158,11 +158,11 @@ void Graphics_altitude (Graphics me, double **z,
 	dy = (y2WC - y1WC) / (iy2 - iy1);
 	xoff = x1WC - ix1 * dx;
 	yoff = y1WC - iy1 * dy;
-	if (! right) {   // static!
-		right = NUMmatrix <int> (0, MAXALTSIDE - 1, 0, MAXALTSIDE - 1);
-		below = NUMmatrix <int> (0, MAXALTSIDE - 1, 0, MAXALTSIDE - 1);
-		x = NUMvector <double> (1, MAXALTPATH);
-		y = NUMvector <double> (1, MAXALTPATH);
+	if (! right.peek()) {   // static!
+		right. reset (0, MAXALTSIDE - 1, 0, MAXALTSIDE - 1);
+		below. reset (0, MAXALTSIDE - 1, 0, MAXALTSIDE - 1);
+		x. reset (1, MAXALTPATH);
+		y. reset (1, MAXALTPATH);
 	}
 	for (row1 = iy1; row1 < iy2; row1 += MAXALTSIDE - 1) {
 		for (col1 = ix1; col1 < ix2; col1 += MAXALTSIDE - 1) {
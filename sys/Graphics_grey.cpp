@@ -70,20 +70,21 @@ typedef struct {
 	double val;
 } structEdgePoint, *EdgePoint;
 
-static Graphics theGraphics;
-static int numberOfEdgeContours;
-static EdgeContour *edgeContours;
-static int numberOfEdgePoints;
-static structEdgePoint *edgePoints;
-static int numberOfClosedContours;
-static ClosedContour *closedContours;
-
-static int numberOfPoints;
-static integer row1, row2, col1, col2;
-static int iBorder, numberOfBorders;
-static int **right, **below;
-static double **data, *border, *x, *y;
-static double dx, dy, xoff, yoff;
+static thread_local Graphics theGraphics;
+static thread_local int numberOfEdgeContours;
+static thread_local autoNUMvector <EdgeContour> edgeContours;
+static thread_local int numberOfEdgePoints;
+static thread_local autoNUMvector <structEdgePoint> edgePoints;
+static thread_local int numberOfClosedContours;
+static thread_local autoNUMvector <ClosedContour> closedContours;
+
+static thread_local int numberOfPoints;
+static thread_local integer row1, row2, col1, col2;
+static thread_local int iBorder, numberOfBorders;
+static thread_local autoNUMmatrix <int> right, below;
+static thread_local double **data, *border;
+static thread_local autoNUMvector <double> x, y;
+static thread_local double dx, dy, xoff, yoff;
 
 static int empty (int row, int col, int ori)
 {
@@ -232,7 +233,7 @@ static void makeClosedContour (int row0, int col0, int ori0) {
 
 	/* Find out whether the point is inside or outside the contour. */
 
-	if (! NUMrotationsPointInPolygon (x1, y1, numberOfPoints, x, y)) up = ! up;
+	if (! NUMrotationsPointInPolygon (x1, y1, numberOfPoints, x.peek(), y.peek())) up = ! up;
 
 	double xmin = 1e308, xmax = -1e308, ymin = 1e308, ymax = -1e308;
 	c -> grey = up ? iBorder + 1 : iBorder;
@@ -397,7 +398,7 @@ static void smallGrey () {
 				}
 			}
 			while (edge1 != edge0);
-			fillGrey (iPoint, x, y, darkness);
+			fillGrey (iPoint, x.peek(), y.peek(), darkness);
 		}
 	}
 	if (numberOfEdgeContours == 0) {
@@ -407,7 +408,7 @@ static void smallGrey () {
 		x [2] = x [3] = xoff + col2 * dx;
 		y [1] = y [2] = yoff + row1 * dy;
 		y [3] = y [4] = yoff + row2 * dy;
-		fillGrey (4, x, y, i);
+		fillGrey (4, x.peek(), y.peek(), i);
 	}
 
 	/* Iterate over all the closed contours.
@@ -463,14 +464,14 @@ void Graphics_grey (Graphics me, double **z,
 	dy = (y2WC - y1WC) / (iy2 - iy1);
 	xoff = x1WC - ix1 * dx;
 	yoff = y1WC - iy1 * dy;
-	if (! right) {
-		right = NUMmatrix <int> (0, MAXGREYSIDE - 1, 0, MAXGREYSIDE - 1);   // BUG memory
-		below = NUMmatrix <int> (0, MAXGREYSIDE - 1, 0, MAXGREYSIDE - 1);
-		x = NUMvector <double> (1, MAXGREYPATH);
-		y = NUMvector <double> (1, MAXGREYPATH);
-		edgeContours = Melder_calloc (EdgeContour, MAXGREYEDGECONTOURS * numberOfBorders) - 1;
-		closedContours = Melder_calloc (ClosedContour, MAXGREYCLOSEDCONTOURS * numberOfBorders) - 1;
-		edgePoints = Melder_calloc (structEdgePoint, MAXGREYEDGEPOINTS * numberOfBorders);
+	if (! right.peek()) {
+		right. reset (0, MAXGREYSIDE - 1, 0, MAXGREYSIDE - 1);   // BUG memory
+		below. reset (0, MAXGREYSIDE - 1, 0, MAXGREYSIDE - 1);
+		x. reset (1, MAXGREYPATH);
+		y. reset (1, MAXGREYPATH);
+		edgeContours. reset (1, MAXGREYEDGECONTOURS * numberOfBorders);
+		closedContours. reset (1, MAXGREYCLOSEDCONTOURS * numberOfBorders);
+		edgePoints. reset (0, MAXGREYEDGEPOINTS * numberOfBorders - 1);
 	}
 
 	/* The matrix is subdivided into matrices with side MAXGREYSIDE, so that:
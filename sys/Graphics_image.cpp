@@ -619,12 +619,28 @@ static void _GraphicsPostscript_cellArrayOrImage (GraphicsPostscript me, double
 			"} for\n"
 			"/irow irow 1 add def scanline } image\n");
 	}
+	/*
+		The hexadecimal image data can easily be a megabyte, so we send it line by line, not byte by byte.
+	*/
+	static const char hexDigits [] = "0123456789abcdef";
+	char line [2 * 39 + 2];
 	for (integer iy = iy1; iy <= iy2; iy ++) for (integer ix = ix1; ix <= ix2; ix ++) {
 		int value = (int) (offset - scale * ( z_float ? z_float [iy] [ix] : z_byte [iy] [ix] ));
-		my d_printf (my d_file, "%.2x", value <= minimalGrey ? minimalGrey : value >= 255 ? 255 : value);
-		if (++ filling == 39) { my d_printf (my d_file, "\n"); filling = 0; }
+		if (value < minimalGrey) value = minimalGrey; else if (value > 255) value = 255;
+		line [2 * filling] = hexDigits [value >> 4];
+		line [2 * filling + 1] = hexDigits [value & 15];
+		if (++ filling == 39) {
+			line [2 * filling] = '\n';
+			line [2 * filling + 1] = '\0';
+			my d_printf (my d_file, "%s", line);
+			filling = 0;
+		}
+	}
+	if (filling) {
+		line [2 * filling] = '\n';
+		line [2 * filling + 1] = '\0';
+		my d_printf (my d_file, "%s", line);
 	}
-	if (filling) my d_printf (my d_file, "\n");
 	my d_printf (my d_file, "grestore\n");
 }
 
@@ -662,19 +678,17 @@ static void cellArrayOrImage (Graphics me, double **z_float, double_rgbt **z_rgb
 		put (minimum); put (maximum);
 		put (nrow); put (ncol);
 		for (integer iy = iy1; iy <= iy2; iy ++) {
+			/*
+				The recording stores packed rows of doubles (or of four doubles per colour cell),
+				so the rows can be copied as a whole.
+			*/
 			if (z_float) {
-				double *row = z_float [iy];
-				for (integer ix = ix1; ix <= ix2; ix ++) {
-					put (row [ix]);
-				}
+				memcpy (p + 1, & z_float [iy] [ix1], (size_t) ncol * sizeof (double));
+				p += ncol;
 			} else if (z_rgbt) {
-				double_rgbt *row = z_rgbt [iy];
-				for (integer ix = ix1; ix <= ix2; ix ++) {
-					put (row [ix]. red);
-					put (row [ix]. green);
-					put (row [ix]. blue);
-					put (row [ix]. transparency);
-				}
+				static_assert (sizeof (double_rgbt) == 4 * sizeof (double), "double_rgbt should be packed");
+				memcpy (p + 1, & z_rgbt [iy] [ix1], (size_t) ncol * sizeof (double_rgbt));
+				p += 4 * ncol;
 			} else {
 				unsigned char *row = z_byte [iy];
 				for (integer ix = ix1; ix <= ix2; ix ++) {
@@ -76,14 +76,33 @@ bool Graphics_stopRecording (Graphics me) {
 	return wasRecording;
 }
 
+/*
+	Erasing the picture and drawing it again is what batch scripts and movies do hundreds of times,
+	so we keep the recording buffer for the next drawing instead of growing it again from scratch,
+	unless it has become so large that we would rather give the memory back.
+*/
+#define MAXIMUM_RECORDING_KEPT_AFTER_CLEARING  10000000
+
 void Graphics_clearRecording (Graphics me) {
 	if (my record) {
-		Melder_free (my record);
+		if (my nrecord > MAXIMUM_RECORDING_KEPT_AFTER_CLEARING) {
+			Melder_free (my record);
+			my nrecord = 0;
+		}
 		my irecord = 0;
-		my nrecord = 0;
 	}
 }
 
+autoGraphics Graphics_copyRecording (Graphics me) {
+	autoGraphics thee = Graphics_create (my resolution);
+	if (my record && my irecord > 0) {
+		thy record = Melder_malloc (double, 1 + my irecord);
+		memcpy (thy record, my record, (size_t) (1 + my irecord) * sizeof (double));
+		thy irecord = thy nrecord = my irecord;
+	}
+	return thee;
+}
+
 void Graphics_play (Graphics me, Graphics thee) {
 	double *p = my record, *endp = p + my irecord;
 	bool wasRecording = my recording;
@@ -256,12 +275,11 @@ void Graphics_play (Graphics me, Graphics thee) {
 				double x1 = get, x2 = get, y1 = get, y2 = get;
 				uint8 minimum = (uint8) iget, maximum = (uint8) iget;
 				integer nrow = iget, ncol = iget;
-				uint8 **z = NUMmatrix <uint8> (1, nrow, 1, ncol);   // BUG memory
+				autoNUMmatrix <uint8> z (1, nrow, 1, ncol);
 				for (integer irow = 1; irow <= nrow; irow ++)
 					for (integer icol = 1; icol <= ncol; icol ++)
 						z [irow] [icol] = (uint8) iget;
-				Graphics_image8 (thee, z, 1, ncol, x1, x2, 1, nrow, y1, y2, minimum, maximum);
-				NUMmatrix_free (z, 1, 1);
+				Graphics_image8 (thee, z.peek(), 1, ncol, x1, x2, 1, nrow, y1, y2, minimum, maximum);
 			} break;
 			case UNHIGHLIGHT: {
 				double x1 = get, x2 = get, y1 = get, y2 = get;
@@ -336,12 +354,11 @@ void Graphics_play (Graphics me, Graphics thee) {
 				double x1 = get, x2 = get, y1 = get, y2 = get;
 				uint8 minimum = (uint8) iget, maximum = (uint8) iget;
 				integer nrow = iget, ncol = iget;
-				uint8 **z = NUMmatrix <uint8> (1, nrow, 1, ncol);   // BUG memory
+				autoNUMmatrix <uint8> z (1, nrow, 1, ncol);
 				for (integer irow = 1; irow <= nrow; irow ++)
 					for (integer icol = 1; icol <= ncol; icol ++)
 						z [irow] [icol] = (uint8) iget;
-				Graphics_cellArray8 (thee, z, 1, ncol, x1, x2, 1, nrow, y1, y2, minimum, maximum);
-				NUMmatrix_free (z, 1, 1);
+				Graphics_cellArray8 (thee, z.peek(), 1, ncol, x1, x2, 1, nrow, y1, y2, minimum, maximum);
 			}  break;
 			case IMAGE: {
 				double x1 = get, x2 = get, y1 = get, y2 = get, minimum = get, maximum = get;
@@ -823,18 +823,22 @@ static void exitText (void *void_me) {
 
 #define MAX_LINK_LENGTH  300
 
-static integer bufferSize;
-static _Graphics_widechar *theWidechar;
-static char32 *charCodes;
+/*
+	The text buffers are per thread, so that several Graphics can draw text at the same time,
+	each in its own thread; a thread frees its buffers when it ends.
+*/
+static thread_local integer bufferSize;
+static thread_local _autostring <_Graphics_widechar> theWidechar;
+static thread_local autostring32 charCodes;
 static int initBuffer (const char32 *txt) {
 	try {
 		integer sizeNeeded = str32len (txt) + 1;
 		if (sizeNeeded > bufferSize) {
 			sizeNeeded += sizeNeeded / 2 + 100;
-			Melder_free (theWidechar);
-			Melder_free (charCodes);
-			theWidechar = Melder_calloc (_Graphics_widechar, sizeNeeded);
-			charCodes = Melder_calloc (char32, sizeNeeded);
+			theWidechar. reset (nullptr);
+			charCodes. reset (nullptr);
+			theWidechar. reset (Melder_calloc (_Graphics_widechar, sizeNeeded));
+			charCodes. reset (Melder_calloc (char32, sizeNeeded));
 			bufferSize = sizeNeeded;
 		}
 		return 1;
@@ -845,8 +849,8 @@ static int initBuffer (const char32 *txt) {
 	}
 }
 
-static int numberOfLinks = 0;
-static Graphics_Link links [100];    // a maximum of 100 links per string
+static thread_local int numberOfLinks = 0;
+static thread_local Graphics_Link links [100];    // a maximum of 100 links per string
 
 static void charSizes (Graphics me, _Graphics_widechar string [], bool measureEachCharacterSeparately) {
 	if (my postScript || (cairo && my duringXor)) {
@@ -936,7 +940,7 @@ static void charSizes (Graphics me, _Graphics_widechar string [], bool measureEa
 			{
 				charCodes [nchars] = U'\0';
 				#if cairo
-					const char *codes8 = Melder_peek32to8 (charCodes);
+					const char *codes8 = Melder_peek32to8 (charCodes.peek());
 					int length = strlen (codes8);
 					PangoFontDescription *fontDescription = PangoFontDescription_create (lc -> font.integer_, lc);
 
@@ -961,7 +965,7 @@ static void charSizes (Graphics me, _Graphics_widechar string [], bool measureEa
 					Melder_assert (logicalRect.x == 0);
 					g_object_unref (layout);
 				#elif quartz
-					const char16 *codes16 = Melder_peek32to16 (charCodes);
+					const char16 *codes16 = Melder_peek32to16 (charCodes.peek());
 					int64 length = str16len (codes16);
 
 					NSString *s = [[NSString alloc]
@@ -1104,7 +1108,7 @@ static void drawOneCell (Graphics me, int xDC, int yDC, _Graphics_widechar lc []
 				double yr = sina * xbegin + cosa * dy2;
 				charCodes [nchars] = U'\0';   // ...and flush
 				charDraw (me, xDC + xr, my yIsZeroAtTheTop ? yDC - yr : yDC + yr,
-					plc, charCodes, nchars, x - xbegin);
+					plc, charCodes.peek(), nchars, x - xbegin);
 				nchars = 0;
 				xbegin = x;
 			}
@@ -1179,7 +1183,7 @@ static void drawOneCell (Graphics me, int xDC, int yDC, _Graphics_widechar lc []
 				{
 					charCodes [nchars] = U'\0';   // ...and flush
 					charDraw (me, xbegin, my yIsZeroAtTheTop ? y - plc -> baseline : y + plc -> baseline,
-						plc, charCodes, nchars, x - xbegin);
+						plc, charCodes.peek(), nchars, x - xbegin);
 					nchars = 0;
 					xbegin = x;
 				}
@@ -1437,9 +1441,9 @@ static void parseTextIntoCellsLinesRuns (Graphics me, const char32 *txt /* catta
 double Graphics_textWidth (Graphics me, const char32 *txt) {
 	if (! initBuffer (txt)) return 0.0;
 	initText (me);
-	parseTextIntoCellsLinesRuns (me, txt, theWidechar);
-	charSizes (me, theWidechar, false);
-	double width = textWidth (theWidechar);
+	parseTextIntoCellsLinesRuns (me, txt, theWidechar.peek());
+	charSizes (me, theWidechar.peek(), false);
+	double width = textWidth (theWidechar.peek());
 	exitText (me);
 	return width / my scaleX;
 }
@@ -1455,9 +1459,9 @@ void Graphics_textRect (Graphics me, double x1, double x2, double y1, double y2,
 	if (availableWidth <= 0) return;
 	if (! initBuffer (txt)) return;
 	initText (me);
-	parseTextIntoCellsLinesRuns (me, txt, theWidechar);
-	charSizes (me, theWidechar, true);
-	for (plc = theWidechar; plc -> kar > U'\t'; plc ++) {
+	parseTextIntoCellsLinesRuns (me, txt, theWidechar.peek());
+	charSizes (me, theWidechar.peek(), true);
+	for (plc = theWidechar.peek(); plc -> kar > U'\t'; plc ++) {
 		width += plc -> width;
 		if (width > availableWidth) {
 			if (++ linesNeeded > linesAvailable) break;
@@ -1465,7 +1469,7 @@ void Graphics_textRect (Graphics me, double x1, double x2, double y1, double y2,
 		}	
 	}
 	lines = linesNeeded > linesAvailable ? linesAvailable : linesNeeded;
-	startOfLine = theWidechar;
+	startOfLine = theWidechar.peek();
 	for (iline = 1; iline <= lines; iline ++) {
 		width = 0.0;
 		for (plc = startOfLine; plc -> kar > U'\t'; plc ++) {
@@ -1532,8 +1536,8 @@ static void _Graphics_text (Graphics me, double xWC, double yWC, const char32 *t
 	}
 	if (! initBuffer (txt)) return;
 	initText (me);
-	parseTextIntoCellsLinesRuns (me, txt, theWidechar);
-	drawCells (me, xWC, yWC, theWidechar);
+	parseTextIntoCellsLinesRuns (me, txt, theWidechar.peek());
+	drawCells (me, xWC, yWC, theWidechar.peek());
 	exitText (me);
 	if (my recording) {
 		char *txt_utf8 = Melder_peek32to8 (txt);
@@ -1542,7 +1546,7 @@ static void _Graphics_text (Graphics me, double xWC, double yWC, const char32 *t
 	}
 }
 
-static MelderString theGraphicsTextBuffer { };
+static thread_local autoMelderString theGraphicsTextBuffer;
 void Graphics_text (Graphics me, double x, double y, Melder_1_ARG) {
 	MelderString_copy (& theGraphicsTextBuffer, Melder_1_ARG_CALL);   // even in the one-argument case, make a copy because s1 may be a temporary string (Melder_integer or so)
 	_Graphics_text (me, x, y, theGraphicsTextBuffer.string);
@@ -1673,8 +1677,8 @@ static double psTextWidth (_Graphics_widechar string [], bool useSilipaPS) {
 
 double Graphics_textWidth_ps_mm (Graphics me, const char32 *txt, bool useSilipaPS) {
 	if (! initBuffer (txt)) return 0.0;
-	parseTextIntoCellsLinesRuns (me, txt, theWidechar);
-	return psTextWidth (theWidechar, useSilipaPS) * (double) my fontSize * (25.4 / 72.0);
+	parseTextIntoCellsLinesRuns (me, txt, theWidechar.peek());
+	return psTextWidth (theWidechar.peek(), useSilipaPS) * (double) my fontSize * (25.4 / 72.0);
 }
 
 double Graphics_textWidth_ps (Graphics me, const char32 *txt, bool useSilipaPS) {
@@ -400,7 +400,7 @@ if (! my printing) {
 		Graphics_inqWsWindow (my graphics.get(), & x1NDCold, & x2NDCold, & y1NDCold, & y2NDCold);
 		{
 			if (! my praatApplication) my praatApplication = Melder_calloc_f (structPraatApplication, 1);
-			if (! my praatObjects) my praatObjects = Melder_calloc_f (structPraatObjects, 1);
+			if (! my praatObjects) my praatObjects = new structPraatObjects ();
 			if (! my praatPicture) my praatPicture = Melder_calloc_f (structPraatPicture, 1);
 			theCurrentPraatApplication = (PraatApplication) my praatApplication;
 			theCurrentPraatApplication -> batch = true;   // prevent creation of editor windows
@@ -497,7 +497,7 @@ if (! my printing) {
 	Graphics_inqWsWindow (my ps, & x1NDCold, & x2NDCold, & y1NDCold, & y2NDCold);
 	{
 		if (! my praatApplication) my praatApplication = Melder_calloc_f (structPraatApplication, 1);
-		if (! my praatObjects) my praatObjects = Melder_calloc_f (structPraatObjects, 1);
+		if (! my praatObjects) my praatObjects = new structPraatObjects ();
 		if (! my praatPicture) my praatPicture = Melder_calloc_f (structPraatPicture, 1);
 		theCurrentPraatApplication = (PraatApplication) my praatApplication;
 		theCurrentPraatApplication -> batch = true;
@@ -586,10 +586,11 @@ void structHyperPage :: v_destroy () noexcept {
 	if (our praatApplication) {
 		for (int iobject = ((PraatObjects) our praatObjects) -> n; iobject >= 1; iobject --) {
 			Melder_free (((PraatObjects) our praatObjects) -> list [iobject]. name);
+			Melder_free (((PraatObjects) our praatObjects) -> list [iobject]. file);
 			forget (((PraatObjects) our praatObjects) -> list [iobject]. object);
 		}
 		Melder_free (our praatApplication);
-		Melder_free (our praatObjects);
+		delete (PraatObjects) our praatObjects;
 		Melder_free (our praatPicture);
 	}
 	our HyperPage_Parent :: v_destroy ();
@@ -1516,6 +1516,7 @@ void Interpreter_run (Interpreter me, char32 *text) {
 				MelderString_copy (& command2, lines [lineNumber]);
 				c0 = command2. string [0];
 				if (c0 == U'\0') continue;
+				autoMelderProfileScope profile (U"script line", lines [lineNumber], lineNumber);
 				/*
 				 * Substitute variables.
 				 */
@@ -79,7 +79,13 @@
 	#define MelderThread_UNLOCK(_mutex)  _mutex = 0
 #endif
 
+extern int MelderThread_forcedNumberOfProcessors;   // 0 = no override; benchmarks set it, to see how analyses scale
+
 inline static int MelderThread_getNumberOfProcessors () {
+	if (MelderThread_forcedNumberOfProcessors > 0)
+		return MelderThread_forcedNumberOfProcessors;
+	if (Melder_debug == 52)
+		return 1;
 	#if USE_WINTHREADS
 		return 8;
 	#elif USE_PTHREADS
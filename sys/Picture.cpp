@@ -16,10 +16,17 @@
  * along with this work. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
 #include "melder.h"
 #include "Gui.h"
 #include "Printer.h"
 #include "Picture.h"
+#include "longchar.h"
 #include "site.h"
 #ifdef _WIN32
 	#include "GraphicsP.h"
@@ -407,11 +414,114 @@ void Picture_writeToWindowsMetafile (Picture me, MelderFile file) {
 }
 #endif
 
+/*
+	Saving in the background.
+
+	A script that saves thousands of pictures need not wait for every file to be written.
+	When saving in the background, "Save as EPS file..." only opens the file and copies the recording;
+	one of a pool of threads then plays the copy into the file, while the script goes on drawing the next picture.
+	The queue is kept short, so that a fast script does not pile up recordings in memory.
+	A saver cannot report an error itself, because error messages are shown in the calling thread;
+	it collects the message instead, and the next "Save as EPS file..." or "Finish saving in background" reports it.
+*/
+struct BackgroundSavingJob {
+	autoGraphics recording, output;
+	structMelderFile file;
+};
+static std::mutex theBackgroundSavingMutex;
+static std::condition_variable theBackgroundSavingJobAvailable, theBackgroundSavingSpaceAvailable;
+static std::deque <BackgroundSavingJob> theBackgroundSavingJobs;
+static std::vector <std::thread> theBackgroundSavers;
+static bool theBackgroundSavingIsFinishing;
+static autoMelderString theBackgroundSavingErrors;   // guarded by theBackgroundSavingMutex
+
+static void saveInBackground () {
+	for (;;) {
+		BackgroundSavingJob job;
+		{
+			std::unique_lock <std::mutex> lock (theBackgroundSavingMutex);
+			theBackgroundSavingJobAvailable. wait (lock,
+				[] { return ! theBackgroundSavingJobs. empty () || theBackgroundSavingIsFinishing; });
+			if (theBackgroundSavingJobs. empty ())
+				return;   // finishing, and nothing left to save
+			job = std::move (theBackgroundSavingJobs. front ());
+			theBackgroundSavingJobs. pop_front ();
+		}
+		theBackgroundSavingSpaceAvailable. notify_one ();
+		try {
+			Graphics_play (job. recording.get(), job. output.get());
+		} catch (MelderError) {
+			std::lock_guard <std::mutex> lock (theBackgroundSavingMutex);
+			try {
+				MelderString_append (& theBackgroundSavingErrors, Melder_getError (),
+					U"Picture not written to EPS file ", job. file. path, U".\n");
+			} catch (MelderError) {
+				// out of memory: the message is lost, but the other pictures can still be saved
+			}
+			Melder_clearError ();
+		}
+		job. output.reset();   // this writes the trailer and closes the file
+	}
+}
+
+static void reportBackgroundSavingErrors () {
+	autostring32 errors;
+	{
+		std::lock_guard <std::mutex> lock (theBackgroundSavingMutex);
+		if (theBackgroundSavingErrors. length == 0)
+			return;
+		errors. reset (Melder_dup (theBackgroundSavingErrors. string));
+		MelderString_empty (& theBackgroundSavingErrors);
+	}
+	Melder_throw (errors.peek(), U"Not all pictures were saved in the background.");
+}
+
+void Picture_startSavingInBackground (integer numberOfThreads) {
+	Picture_finishSavingInBackground ();
+	(void) Longchar_getInfo (U' ', U' ');   // initialize the character tables before any saver needs them
+	theBackgroundSavingIsFinishing = false;
+	try {
+		for (integer ithread = 1; ithread <= numberOfThreads; ithread ++)
+			theBackgroundSavers. emplace_back (saveInBackground);
+	} catch (const std::system_error&) {
+		Picture_finishSavingInBackground ();
+		Melder_throw (U"Cannot start ", numberOfThreads, U" threads for saving in the background.");
+	}
+}
+
+void Picture_finishSavingInBackground () {
+	{
+		std::lock_guard <std::mutex> lock (theBackgroundSavingMutex);
+		theBackgroundSavingIsFinishing = true;
+	}
+	theBackgroundSavingJobAvailable. notify_all ();
+	for (std::thread& saver : theBackgroundSavers)
+		saver. join ();
+	theBackgroundSavers. clear ();
+	reportBackgroundSavingErrors ();
+}
+
 void Picture_writeToEpsFile (Picture me, MelderFile file, bool includeFonts, bool useSilipaPS) {
+	reportBackgroundSavingErrors ();   // from earlier pictures
 	try {
 		MelderFile_delete (file);   // to kill resources as well (fopen only kills data fork)
 		/* BUG: no message if file cannot be deleted (e.g. because still open by Microsoft Word 2001 after reading). */
 
+		if (theBackgroundSavers. size () > 0) {
+			BackgroundSavingJob job;
+			MelderFile_copy (file, & job. file);
+			job. output = Graphics_create_epsfile (file, 600, thePrinter. spots,
+				my selx1, my selx2, my sely1, my sely2, includeFonts, useSilipaPS);   // report a bad file name right away
+			job. recording = Graphics_copyRecording (my graphics.get());
+			{
+				std::unique_lock <std::mutex> lock (theBackgroundSavingMutex);
+				theBackgroundSavingSpaceAvailable. wait (lock,
+					[] { return theBackgroundSavingJobs. size () < 2 * theBackgroundSavers. size (); });
+				theBackgroundSavingJobs. push_back (std::move (job));
+			}
+			theBackgroundSavingJobAvailable. notify_one ();
+			return;
+		}
 		{// scope
 			autoGraphics ps = Graphics_create_epsfile (file, 600, thePrinter. spots,
 				my selx1, my selx2, my sely1, my sely2, includeFonts, useSilipaPS);
@@ -110,6 +110,17 @@ void Picture_writeToPraatPictureFile (Picture me, MelderFile file);
 void Picture_readFromPraatPictureFile (Picture me, MelderFile file);
 
 void Picture_writeToEpsFile (Picture me, MelderFile file, bool includeFonts, bool useSilipaPS);
+
+void Picture_startSavingInBackground (integer numberOfThreads);
+/*
+	From now on, Picture_writeToEpsFile returns as soon as the file has been opened;
+	the file is written by one of numberOfThreads threads, while the caller goes on drawing.
+*/
+void Picture_finishSavingInBackground ();
+/*
+	Waits until all the files are written, and returns to saving in the foreground.
+	Throws if any of the files could not be written.
+*/
 void Picture_writeToPdfFile (Picture me, MelderFile file);
 void Picture_writeToPngFile_300 (Picture me, MelderFile file);
 void Picture_writeToPngFile_600 (Picture me, MelderFile file);
@@ -20,7 +20,7 @@
 #include <time.h>
 #include "Thing.h"
 
-integer theTotalNumberOfThings;
+std::atomic <integer> theTotalNumberOfThings (0);
 
 void structThing :: v_info ()
 {
@@ -27,6 +27,8 @@
 		#include "oo.h"
 	/* The input/output mechanism: */
 		#include "abcio.h"
+	/* For the object counter: */
+		#include <atomic>
 
 #define _Thing_auto_DEBUG  0
 
@@ -222,8 +224,9 @@ void * _Thing_check (Thing me, ClassInfo table, const char *fileName, int line);
 
 /* For debugging. */
 
-extern integer theTotalNumberOfThings;
-/* This number is 0 initially, increments at every successful `new', and decrements at every `forget'. */
+extern std::atomic <integer> theTotalNumberOfThings;
+/* This number is 0 initially, increments at every successful `new', and decrements at every `forget'.
+	It is atomic, because Things can be created in several threads at a time. */
 
 template <class T>
 class _Thing_auto {
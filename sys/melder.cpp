@@ -41,6 +41,7 @@ bool Melder_batch;   // don't we have a GUI?- Set once at application start-up
 bool Melder_backgrounding;   // are we running a script?- Set and unset dynamically
 bool Melder_asynchronous;
 int32 Melder_systemVersion;
+int MelderThread_forcedNumberOfProcessors = 0;   // see MelderThread_getNumberOfProcessors ()
 
 static void defaultHelp (const char32 *query) {
 	Melder_flushError (U"Don't know how to find help on \"", query, U"\".");
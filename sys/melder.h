@@ -1202,6 +1202,7 @@ int NUMrotationsPointInPolygon
 /********** Random numbers (NUMrandom.cpp) **********/
 
 void NUMrandom_init ();   // automatically called by NUMinit ();
+void NUMrandom_setSeed_mt (int threadNumber, uint64 seed);   // for reproducible sequences in thread-dependent streams
 
 double NUMrandomFraction ();
 double NUMrandomFraction_mt (int threadNumber);
@@ -2682,6 +2683,48 @@ const char32 * MelderQuantity_getWithUnitText (int quantity);   // e.g. "Time (s
 const char32 * MelderQuantity_getLongUnitText (int quantity);   // e.g. "seconds"
 const char32 * MelderQuantity_getShortUnitText (int quantity);   // e.g. "s"
 
+/********** PROFILING (melder_profile.cpp) **********/
+
+/*
+	While profiling is on, every autoMelderProfileScope records its wall time
+	and the number and size of the allocations made (in all threads) while it existed.
+	Praat opens such scopes around script lines, commands and some analyses.
+*/
+extern bool Melder_profiling;   // read by every scope, so keep it cheap
+void MelderProfile_start ();   // discards the results of earlier profiling
+void MelderProfile_stop ();
+void MelderProfile_writeReport (MelderString *buffer);   // per category and name, sorted by decreasing time
+void MelderProfile_saveAsChromeTrace (MelderFile file);   // for chrome://tracing or Perfetto
+
+void _MelderProfile_open (double *out_startTime, int64 *out_startCount, int64 *out_startSize);
+void _MelderProfile_close (const char32 *category, const char32 *name, integer number,
+	double startTime, int64 startCount, int64 startSize);
+
+class autoMelderProfileScope {
+	const char32 *_category, *_name;
+	integer _number;
+	bool _active;
+	double _startTime;
+	int64 _startCount, _startSize;
+public:
+	/*
+		The name has to stay valid until the scope closes; if number is not 0, it is shown before the name
+		(e.g. a line number).
+	*/
+	autoMelderProfileScope (const char32 *category, const char32 *name, integer number = 0)
+		: _category (category), _name (name), _number (number), _active (Melder_profiling)
+	{
+		if (_active)
+			_MelderProfile_open (& _startTime, & _startCount, & _startSize);
+	}
+	~autoMelderProfileScope () {
+		if (_active)
+			_MelderProfile_close (_category, _name, _number, _startTime, _startCount, _startSize);
+	}
+	autoMelderProfileScope (const autoMelderProfileScope&) = delete;
+	autoMelderProfileScope& operator= (const autoMelderProfileScope&) = delete;
+};
+
 /********** MISCELLANEOUS **********/
 
 char32 * Melder_getenv (const char32 *variableName);
@@ -2699,6 +2742,11 @@ struct autoMelderString : MelderString {
 	~autoMelderString () { MelderString_free (this); }
 };
 
+struct autoMelderString16 : MelderString16 {
+	autoMelderString16 () { length = 0; bufferSize = 0; string = nullptr; }
+	~autoMelderString16 () { MelderString16_free (this); }
+};
+
 struct autoMelderReadText {
 	MelderReadText text;
 	autoMelderReadText (MelderReadText a_text) : text (a_text) {
@@ -19,9 +19,80 @@
 #include "melder.h"
 #include <wctype.h>
 #include <assert.h>
+#include <atomic>
+#include <mutex>
 
-static int64 totalNumberOfAllocations = 0, totalNumberOfDeallocations = 0, totalAllocationSize = 0,
-	totalNumberOfMovingReallocs = 0, totalNumberOfReallocsInSitu = 0;
+/*
+	The statistics are kept per thread, because analyses may allocate from several threads at a time,
+	and incrementing shared atomic counters would cost more than the allocations themselves.
+	Each thread is the only writer of its own counters, so an increment is a relaxed load and store
+	(i.e. an ordinary addition); the atomicity only protects the readers, who add up all threads.
+*/
+struct AllocationStatistics {
+	std::atomic <int64> numberOfAllocations { 0 }, numberOfDeallocations { 0 }, allocationSize { 0 },
+		numberOfMovingReallocs { 0 }, numberOfReallocsInSitu { 0 };
+};
+
+static std::mutex theStatisticsMutex;
+static AllocationStatistics theStatisticsOfFinishedThreads;
+static struct ThreadAllocationStatistics *theFirstThreadStatistics;   // constant-initialized, so usable during static initialization
+
+struct ThreadAllocationStatistics : AllocationStatistics {
+	ThreadAllocationStatistics *previous = nullptr, *next = nullptr;
+	ThreadAllocationStatistics () {
+		std::lock_guard <std::mutex> lock (theStatisticsMutex);
+		next = theFirstThreadStatistics;
+		if (next)
+			next -> previous = this;
+		theFirstThreadStatistics = this;
+	}
+	~ThreadAllocationStatistics () {
+		std::lock_guard <std::mutex> lock (theStatisticsMutex);
+		theStatisticsOfFinishedThreads. numberOfAllocations += numberOfAllocations;
+		theStatisticsOfFinishedThreads. numberOfDeallocations += numberOfDeallocations;
+		theStatisticsOfFinishedThreads. allocationSize += allocationSize;
+		theStatisticsOfFinishedThreads. numberOfMovingReallocs += numberOfMovingReallocs;
+		theStatisticsOfFinishedThreads. numberOfReallocsInSitu += numberOfReallocsInSitu;
+		( previous ? previous -> next : theFirstThreadStatistics ) = next;
+		if (next)
+			next -> previous = previous;
+	}
+};
+
+static thread_local ThreadAllocationStatistics theStatisticsOfThisThread;
+
+static inline void increase (std::atomic <int64>& counter, int64 amount) {
+	counter. store (counter. load (std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+static void countAllocation (int64 size) {
+	increase (theStatisticsOfThisThread. numberOfAllocations, 1);
+	increase (theStatisticsOfThisThread. allocationSize, size);
+}
+
+static void countDeallocation () {
+	increase (theStatisticsOfThisThread. numberOfDeallocations, 1);
+}
+
+static void countReallocation (void *oldPointer, void *newPointer, int64 size) {
+	if (! oldPointer) {   // was it like malloc?
+		countAllocation (size);
+	} else if (newPointer != oldPointer) {   // did realloc do a malloc-and-free?
+		countAllocation (size);
+		countDeallocation ();
+		increase (theStatisticsOfThisThread. numberOfMovingReallocs, 1);
+	} else {
+		increase (theStatisticsOfThisThread. numberOfReallocsInSitu, 1);
+	}
+}
+
+static int64 totalOf (std::atomic <int64> AllocationStatistics::*counter) {
+	std::lock_guard <std::mutex> lock (theStatisticsMutex);
+	int64 total = (theStatisticsOfFinishedThreads .* counter). load ();
+	for (ThreadAllocationStatistics *thread = theFirstThreadStatistics; thread; thread = thread -> next)
+		total += (thread ->* counter). load (std::memory_order_relaxed);
+	return total;
+}
 
 /*
  * The rainy-day fund.
@@ -64,8 +135,7 @@ void * _Melder_malloc (int64 size) {
 		Melder_throw (U"Out of memory: there is not enough room for another ", Melder_bigInteger (size), U" bytes.");
 	if (Melder_debug == 34)
 		Melder_casual (U"Melder_malloc\t", Melder_pointer (result), U"\t", Melder_bigInteger (size), U"\t1");
-	totalNumberOfAllocations += 1;
-	totalAllocationSize += size;
+	countAllocation (size);
 	return result;
 }
 
@@ -84,8 +154,7 @@ void * _Melder_malloc_f (int64 size) {
 			Melder_fatal (U"Out of memory: there is not enough room for another ", Melder_bigInteger (size), U" bytes.");
 		}
 	}
-	totalNumberOfAllocations += 1;
-	totalAllocationSize += size;
+	countAllocation (size);
 	return result;
 }
 
@@ -95,7 +164,7 @@ void _Melder_free (void **ptr) noexcept {
 		Melder_casual (U"Melder_free\t", Melder_pointer (*ptr), U"\t?\t?");
 	free (*ptr);
 	*ptr = nullptr;
-	totalNumberOfDeallocations += 1;
+	countDeallocation ();
 }
 
 void * Melder_realloc (void *ptr, int64 size) {
@@ -106,19 +175,9 @@ void * Melder_realloc (void *ptr, int64 size) {
 	void *result = realloc (ptr, (size_t) size);   // will not show in the statistics...
 	if (result == nullptr)
 		Melder_throw (U"Out of memory. Could not extend room to ", Melder_bigInteger (size), U" bytes.");
-	if (! ptr) {   // is it like malloc?
-		if (Melder_debug == 34)
-			Melder_casual (U"Melder_realloc\t", Melder_pointer (result), U"\t", Melder_bigInteger (size), U"\t1");
-		totalNumberOfAllocations += 1;
-		totalAllocationSize += size;
-	} else if (result != ptr) {   // did realloc do a malloc-and-free?
-		totalNumberOfAllocations += 1;
-		totalAllocationSize += size;
-		totalNumberOfDeallocations += 1;
-		totalNumberOfMovingReallocs += 1;
-	} else {
-		totalNumberOfReallocsInSitu += 1;
-	}
+	if (! ptr && Melder_debug == 34)
+		Melder_casual (U"Melder_realloc\t", Melder_pointer (result), U"\t", Melder_bigInteger (size), U"\t1");
+	countReallocation (ptr, result, size);
 	return result;
 }
 
@@ -137,17 +196,7 @@ void * Melder_realloc_f (void *ptr, int64 size) {
 			Melder_fatal (U"Out of memory. Could not extend room to ", Melder_bigInteger (size), U" bytes.");
 		}
 	}
-	if (! ptr) {   // is it like malloc?
-		totalNumberOfAllocations += 1;
-		totalAllocationSize += size;
-	} else if (result != ptr) {   // did realloc do a malloc-and-free?
-		totalNumberOfAllocations += 1;
-		totalAllocationSize += size;
-		totalNumberOfDeallocations += 1;
-		totalNumberOfMovingReallocs += 1;
-	} else {
-		totalNumberOfReallocsInSitu += 1;
-	}
+	countReallocation (ptr, result, size);
 	return result;
 }
 
@@ -164,8 +213,7 @@ void * _Melder_calloc (int64 nelem, int64 elsize) {
 		Melder_throw (U"Out of memory: there is not enough room for ", Melder_bigInteger (nelem), U" more elements whose sizes are ", elsize, U" bytes each.");
 	if (Melder_debug == 34)
 		Melder_casual (U"Melder_calloc\t", Melder_pointer (result), U"\t", Melder_bigInteger (nelem), U"\t", Melder_bigInteger (elsize));
-	totalNumberOfAllocations += 1;
-	totalAllocationSize += nelem * elsize;
+	countAllocation (nelem * elsize);
 	return result;
 }
 
@@ -187,8 +235,7 @@ void * _Melder_calloc_f (int64 nelem, int64 elsize) {
 				U" more elements whose sizes are ", Melder_bigInteger (elsize), U" bytes each.");
 		}
 	}
-	totalNumberOfAllocations += 1;
-	totalAllocationSize += nelem * elsize;
+	countAllocation (nelem * elsize);
 	return result;
 }
 
@@ -203,8 +250,7 @@ char * Melder_strdup (const char *string) {
 	strcpy (result, string);
 	if (Melder_debug == 34)
 		Melder_casual (U"Melder_strdup\t", Melder_pointer (result), U"\t", Melder_bigInteger (size), U"\t", sizeof (char));
-	totalNumberOfAllocations += 1;
-	totalAllocationSize += size;
+	countAllocation (size);
 	return result;
 }
 
@@ -224,8 +270,7 @@ char * Melder_strdup_f (const char *string) {
 		}
 	}
 	strcpy (result, string);
-	totalNumberOfAllocations += 1;
-	totalAllocationSize += size;
+	countAllocation (size);
 	return result;
 }
 
@@ -240,8 +285,7 @@ char32 * Melder_dup (const char32 *string /* cattable */) {
 	str32cpy (result, string);
 	if (Melder_debug == 34)
 		Melder_casual (U"Melder_dup\t", Melder_pointer (result), U"\t", Melder_bigInteger (size), U"\t", sizeof (char32));
-	totalNumberOfAllocations += 1;
-	totalAllocationSize += size * (int64) sizeof (char32);
+	countAllocation (size * (int64) sizeof (char32));
 	return result;
 }
 
@@ -261,29 +305,28 @@ char32 * Melder_dup_f (const char32 *string /* cattable */) {
 		}
 	}
 	str32cpy (result, string);
-	totalNumberOfAllocations += 1;
-	totalAllocationSize += size * (int64) sizeof (char32);
+	countAllocation (size * (int64) sizeof (char32));
 	return result;
 }
 
 int64 Melder_allocationCount () {
-	return totalNumberOfAllocations;
+	return totalOf (& AllocationStatistics::numberOfAllocations);
 }
 
 int64 Melder_deallocationCount () {
-	return totalNumberOfDeallocations;
+	return totalOf (& AllocationStatistics::numberOfDeallocations);
 }
 
 int64 Melder_allocationSize () {
-	return totalAllocationSize;
+	return totalOf (& AllocationStatistics::allocationSize);
 }
 
 int64 Melder_reallocationsInSituCount () {
-	return totalNumberOfReallocsInSitu;
+	return totalOf (& AllocationStatistics::numberOfReallocsInSitu);
 }
 
 int64 Melder_movingReallocationsCount () {
-	return totalNumberOfMovingReallocs;
+	return totalOf (& AllocationStatistics::numberOfMovingReallocs);
 }
 
 int Melder_cmp (const char32 *string1, const char32 *string2) {
@@ -30,7 +30,13 @@ void Melder_setErrorProc (void (*error) (const char32 *)) {
 	theError = error ? error : defaultError;
 }
 
-static char32 errors [2000+1];   // safe in low-memory situations
+/*
+	Every thread builds its own error message,
+	so that a thread that saves pictures in the background cannot garble or wipe
+	a message that the calling thread is building, and vice versa.
+	A message that a thread has not passed on to the calling thread dies with it.
+*/
+static thread_local char32 errors [2000+1];   // safe in low-memory situations
 
 static void appendError (const char32 *message) {
 	if (! message) return;
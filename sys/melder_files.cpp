@@ -699,6 +699,10 @@ bool MelderFile_exists (MelderFile file) {
 }
 
 bool MelderFile_readable (MelderFile file) {
+	#if defined (UNIX)
+		if (! MelderFile_exists (file))
+			return false;   // the usual case for optional files such as start-up files; cheaper than catching an exception
+	#endif
 	try {
 		autofile f = Melder_fopen (file, "rb");
 		f.close (file);
@@ -25,9 +25,13 @@
 #define MAXIMUM_NUMERIC_STRING_LENGTH  800
 	/* = sign + 324 + point + 60 + e + sign + 3 + null byte + ("·10^^" - "e"), times 2, + i, + 7 extra */
 
-static char   buffers8  [NUMBER_OF_BUFFERS] [MAXIMUM_NUMERIC_STRING_LENGTH + 1];
-static char32 buffers32 [NUMBER_OF_BUFFERS] [MAXIMUM_NUMERIC_STRING_LENGTH + 1];
-static int ibuffer = 0;
+/*
+	The buffers are per thread, so that numbers can be written in several threads at a time
+	(e.g. by the PostScript output of pictures that are saved in the background).
+*/
+static thread_local char   buffers8  [NUMBER_OF_BUFFERS] [MAXIMUM_NUMERIC_STRING_LENGTH + 1];
+static thread_local char32 buffers32 [NUMBER_OF_BUFFERS] [MAXIMUM_NUMERIC_STRING_LENGTH + 1];
+static thread_local int ibuffer = 0;
 
 #define CONVERT_BUFFER_TO_CHAR32 \
 	char32 *q = buffers32 [ibuffer]; \
@@ -48,7 +52,7 @@ const char * Melder8_integer (int64 value) noexcept {
 		 * There are also buggy platforms (namely 32-bit gcc on Linux) that support long long and %I64d but that convert
 		 * the argument to a 32-bit long.
 		 */
-		static const char *formatString = nullptr;
+		static thread_local const char *formatString = nullptr;
 		if (! formatString) {
 			char tryBuffer [MAXIMUM_NUMERIC_STRING_LENGTH + 1];
 			formatString = "%lld";
@@ -369,8 +373,8 @@ const char32 * Melder_character (char32 kar) noexcept {
 /********** TENSOR TO STRING CONVERSION **********/
 
 #define NUMBER_OF_TENSOR_BUFFERS  3
-static MelderString theTensorBuffers [NUMBER_OF_TENSOR_BUFFERS] { };
-static int iTensorBuffer { 0 };
+static thread_local autoMelderString theTensorBuffers [NUMBER_OF_TENSOR_BUFFERS];
+static thread_local int iTensorBuffer { 0 };
 
 const char32 * Melder_numvec (numvec value) {
 	if (++ iTensorBuffer == NUMBER_OF_TENSOR_BUFFERS) iTensorBuffer = 0;
@@ -401,8 +405,8 @@ const char32 * Melder_nummat (nummat value) {
 
 /********** STRING TO STRING CONVERSION **********/
 
-static MelderString thePadBuffers [NUMBER_OF_BUFFERS];
-static int iPadBuffer { 0 };
+static thread_local autoMelderString thePadBuffers [NUMBER_OF_BUFFERS];
+static thread_local int iPadBuffer { 0 };
 
 const char32 * Melder_pad (int64 width, const char32 *string) {
 	if (++ iPadBuffer == NUMBER_OF_BUFFERS) iPadBuffer = 0;
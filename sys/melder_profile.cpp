@@ -0,0 +1,183 @@
+/* melder_profile.cpp
+ *
+ * Copyright (C) 2018 Paul Boersma
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "melder.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+bool Melder_profiling = false;
+
+struct MelderProfileEvent {
+	const char32 *category;   // a string literal
+	std::u32string name;
+	double startTime, duration;   // in seconds since the start of profiling
+	int64 numberOfAllocations, allocationSize;
+	int thread;
+};
+
+struct MelderProfileTotal {
+	const char32 *category;
+	std::u32string name;
+	integer numberOfCalls;
+	double time;
+	int64 numberOfAllocations, allocationSize;
+};
+
+/*
+	Scopes may close in several threads at a time, so the results are guarded.
+	The events are kept for the Chrome trace; a profile of a long session is summarized in the totals,
+	but its events are kept only up to a limit.
+*/
+static std::mutex theProfileMutex;
+static std::chrono::steady_clock::time_point theStartOfProfiling;
+static double theDurationOfProfiling;
+static std::vector <MelderProfileEvent> theProfileEvents;
+static std::unordered_map <std::u32string, MelderProfileTotal> theProfileTotals;
+static integer theNumberOfDiscardedEvents;
+#define MelderProfile_MAXIMUM_NUMBER_OF_EVENTS  1000000
+#define MelderProfile_MAXIMUM_NAME_LENGTH  200
+
+static double secondsSinceStartOfProfiling () {
+	return std::chrono::duration <double> (std::chrono::steady_clock::now () - theStartOfProfiling). count ();
+}
+
+static int threadNumber () {
+	static std::atomic <int> numberOfThreads (0);
+	static thread_local int number = numberOfThreads ++;
+	return number;
+}
+
+void MelderProfile_start () {
+	std::lock_guard <std::mutex> lock (theProfileMutex);
+	theProfileEvents. clear ();
+	theProfileTotals. clear ();
+	theNumberOfDiscardedEvents = 0;
+	theDurationOfProfiling = 0.0;
+	theStartOfProfiling = std::chrono::steady_clock::now ();
+	Melder_profiling = true;
+}
+
+void MelderProfile_stop () {
+	std::lock_guard <std::mutex> lock (theProfileMutex);
+	if (! Melder_profiling) return;
+	theDurationOfProfiling = secondsSinceStartOfProfiling ();
+	Melder_profiling = false;
+}
+
+void _MelderProfile_open (double *out_startTime, int64 *out_startCount, int64 *out_startSize) {
+	*out_startCount = Melder_allocationCount ();
+	*out_startSize = Melder_allocationSize ();
+	*out_startTime = secondsSinceStartOfProfiling ();
+}
+
+void _MelderProfile_close (const char32 *category, const char32 *name, integer number,
+	double startTime, int64 startCount, int64 startSize)
+{
+	const double endTime = secondsSinceStartOfProfiling ();
+	const int64 numberOfAllocations = Melder_allocationCount () - startCount;
+	const int64 allocationSize = Melder_allocationSize () - startSize;
+	std::u32string fullName;
+	if (number != 0) {
+		fullName += Melder_integer (number);
+		fullName += U": ";
+	}
+	fullName. append (name ? name : U"", 0, MelderProfile_MAXIMUM_NAME_LENGTH);
+	std::lock_guard <std::mutex> lock (theProfileMutex);
+	if (! Melder_profiling) return;   // stopped while this scope was open
+	MelderProfileTotal& total = theProfileTotals [std::u32string (category) + U'\t' + fullName];
+	if (total. numberOfCalls == 0) {
+		total. category = category;
+		total. name = fullName;
+	}
+	total. numberOfCalls += 1;
+	total. time += endTime - startTime;
+	total. numberOfAllocations += numberOfAllocations;
+	total. allocationSize += allocationSize;
+	if (theProfileEvents. size () < MelderProfile_MAXIMUM_NUMBER_OF_EVENTS)
+		theProfileEvents. push_back ({ category, fullName, startTime, endTime - startTime,
+			numberOfAllocations, allocationSize, threadNumber () });
+	else
+		theNumberOfDiscardedEvents += 1;
+}
+
+void MelderProfile_writeReport (MelderString *buffer) {
+	std::lock_guard <std::mutex> lock (theProfileMutex);
+	std::vector <const MelderProfileTotal *> totals;
+	totals. reserve (theProfileTotals. size ());
+	for (const auto& entry : theProfileTotals)
+		totals. push_back (& entry. second);
+	std::sort (totals. begin (), totals. end (),
+		[] (const MelderProfileTotal *a, const MelderProfileTotal *b) { return a -> time > b -> time; });
+	const double duration = ( Melder_profiling ? secondsSinceStartOfProfiling () : theDurationOfProfiling );
+	MelderString_append (buffer, U"Profile of ", Melder_fixed (duration, 6), U" seconds",
+		Melder_profiling ? U" (still running)" : U"", U".\n");
+	MelderString_append (buffer, U"Times include the times of nested scopes; allocations are counted in all threads.\n\n");
+	MelderString_append (buffer, U"time (s)\tcalls\tallocations\tbytes\tcategory\tname\n");
+	for (const MelderProfileTotal *total : totals)
+		MelderString_append (buffer, Melder_fixed (total -> time, 6), U"\t", total -> numberOfCalls, U"\t",
+			total -> numberOfAllocations, U"\t", total -> allocationSize, U"\t",
+			total -> category, U"\t", total -> name. c_str (), U"\n");
+	if (theNumberOfDiscardedEvents > 0)
+		MelderString_append (buffer, U"\n(the Chrome trace lacks the last ", theNumberOfDiscardedEvents, U" events)\n");
+}
+
+static void appendJsonString (MelderString *buffer, const char32 *string) {
+	MelderString_appendCharacter (buffer, U'\"');
+	for (const char32 *p = string; *p != U'\0'; p ++) {
+		if (*p == U'\"' || *p == U'\\') {
+			MelderString_appendCharacter (buffer, U'\\');
+			MelderString_appendCharacter (buffer, *p);
+		} else if (*p < 32) {
+			static const char32 hexDigits [] = U"0123456789abcdef";
+			MelderString_append (buffer, U"\\u00");
+			MelderString_appendCharacter (buffer, hexDigits [*p >> 4]);
+			MelderString_appendCharacter (buffer, hexDigits [*p & 15]);
+		} else {
+			MelderString_appendCharacter (buffer, *p);
+		}
+	}
+	MelderString_appendCharacter (buffer, U'\"');
+}
+
+void MelderProfile_saveAsChromeTrace (MelderFile file) {
+	autoMelderString trace;
+	{
+		std::lock_guard <std::mutex> lock (theProfileMutex);
+		MelderString_append (& trace, U"{\"traceEvents\":[");
+		bool first = true;
+		for (const MelderProfileEvent& event : theProfileEvents) {
+			MelderString_append (& trace, first ? U"\n" : U",\n", U"{\"name\":");
+			appendJsonString (& trace, event. name. c_str ());
+			MelderString_append (& trace, U",\"cat\":");
+			appendJsonString (& trace, event. category);
+			MelderString_append (& trace, U",\"ph\":\"X\",\"ts\":", Melder_fixed (1e6 * event. startTime, 3),
+				U",\"dur\":", Melder_fixed (1e6 * event. duration, 3), U",\"pid\":1,\"tid\":", event. thread,
+				U",\"args\":{\"allocations\":", event. numberOfAllocations, U",\"bytes\":", event. allocationSize, U"}}");
+			first = false;
+		}
+		MelderString_append (& trace, U"\n],\"displayTimeUnit\":\"ms\"}\n");
+	}
+	MelderFile_writeText (file, trace.string, kMelder_textOutputEncoding::UTF8);
+}
+
+/* End of file melder_profile.cpp */
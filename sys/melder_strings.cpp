@@ -18,9 +18,16 @@
 
 #include "melder.h"
 #include "UnicodeData.h"
+#include <atomic>
 #define FREE_THRESHOLD_BYTES 10000LL
 
-static int64 totalNumberOfAllocations = 0, totalNumberOfDeallocations = 0, totalAllocationSize = 0, totalDeallocationSize = 0;
+/*
+	The per-thread string buffers of Melder_cat and the like grow and shrink in whatever thread uses them,
+	so the statistics are atomic. Growing a buffer is rare compared to using it,
+	and the counters must stay usable while thread-local buffers are destroyed at thread exit,
+	so they are not kept per thread the way the Melder_malloc statistics are.
+*/
+static std::atomic <int64> totalNumberOfAllocations { 0 }, totalNumberOfDeallocations { 0 }, totalAllocationSize { 0 }, totalDeallocationSize { 0 };
 
 void MelderString16_free (MelderString16 *me) {
 	if (! my string) return;
@@ -772,8 +779,8 @@ int64 MelderString_deallocationSize () {
 }
 
 #define NUMBER_OF_CAT_BUFFERS  33
-static MelderString theCatBuffers [NUMBER_OF_CAT_BUFFERS] { };
-static int iCatBuffer = 0;
+static thread_local autoMelderString theCatBuffers [NUMBER_OF_CAT_BUFFERS];
+static thread_local int iCatBuffer = 0;
 
 const char32 * Melder_cat (Melder_2_ARGS) {
 	if (++ iCatBuffer == NUMBER_OF_CAT_BUFFERS) iCatBuffer = 0;
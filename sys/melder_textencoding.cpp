@@ -189,8 +189,8 @@ size_t str32len_utf16 (const char32 *string, bool nativizeNewlines) {
 
 char32 * Melder_peek8to32 (const char *textA) {
 	if (! textA) return nullptr;
-	static MelderString buffers [19] { };
-	static int ibuffer = 0;
+	static thread_local autoMelderString buffers [19];
+	static thread_local int ibuffer = 0;
 	if (++ ibuffer == 11) ibuffer = 0;
 	MelderString_empty (& buffers [ibuffer]);
 	uinteger n = strlen (textA), i, j;
@@ -416,8 +416,8 @@ char32 * Melder_8to32 (const char *string) {
 
 char32 * Melder_peek16to32 (const char16 *text) {
 	if (! text) return nullptr;
-	static MelderString buffers [19] { };
-	static int ibuffer = 0;
+	static thread_local autoMelderString buffers [19];
+	static thread_local int ibuffer = 0;
 	if (++ ibuffer == 19) ibuffer = 0;
 	MelderString_empty (& buffers [ibuffer]);
 	for (;;) {
@@ -482,28 +482,28 @@ char * Melder_32to8 (const char32 *string) {
 
 char * Melder_peek32to8 (const char32 *text) {
 	if (! text) return nullptr;
-	static char *buffer [19] { nullptr };
-	static int64 bufferSize [19] { 0 };
-	static int ibuffer = 0;
+	static thread_local autostring8 buffer [19];
+	static thread_local int64 bufferSize [19] { 0 };
+	static thread_local int ibuffer = 0;
 	if (++ ibuffer == 19) ibuffer = 0;
 	int64 sizeNeeded = str32len (text) * 4 + 1;
 	if ((bufferSize [ibuffer] - sizeNeeded) * (int64) sizeof (char) >= 10000) {
-		Melder_free (buffer [ibuffer]);
+		buffer [ibuffer]. reset (nullptr);
 		bufferSize [ibuffer] = 0;
 	}
 	if (sizeNeeded > bufferSize [ibuffer]) {
 		sizeNeeded = (int64) floor (sizeNeeded * 1.61803) + 100;
-		buffer [ibuffer] = (char *) Melder_realloc_f (buffer [ibuffer], (int64) sizeNeeded * (int64) sizeof (char));
+		buffer [ibuffer]. reset ((char *) Melder_realloc_f (buffer [ibuffer]. transfer (), (int64) sizeNeeded * (int64) sizeof (char)));
 		bufferSize [ibuffer] = sizeNeeded;
 	}
-	Melder_32to8_inplace (text, buffer [ibuffer]);
-	return buffer [ibuffer];
+	Melder_32to8_inplace (text, buffer [ibuffer]. peek());
+	return buffer [ibuffer]. peek();
 }
 
 char16 * Melder_peek32to16 (const char32 *text, bool nativizeNewlines) {
 	if (! text) return nullptr;
-	static MelderString16 buffers [19] { };
-	static int ibuffer = 0;
+	static thread_local autoMelderString16 buffers [19];
+	static thread_local int ibuffer = 0;
 	if (++ ibuffer == 19) ibuffer = 0;
 	MelderString16_empty (& buffers [ibuffer]);
 	int64 n = str32len (text);
@@ -26,6 +26,7 @@
 	#include <signal.h>
 #endif
 #include <locale.h>
+#include <algorithm>
 #if defined (UNIX)
 	#include <unistd.h>
 #endif
@@ -183,7 +184,13 @@ void praat_deselect (int IOBJECT) {
 	}
 }
 
-void praat_deselectAll () { int IOBJECT; WHERE (1) praat_deselect (IOBJECT); }
+void praat_deselectAll () {
+	int IOBJECT;
+	WHERE_DOWN (SELECTED) {   // the selected objects tend to be the most recent ones
+		praat_deselect (IOBJECT);
+		if (theCurrentPraatObjects -> totalSelection == 0) break;
+	}
+}
 
 void praat_select (int IOBJECT) {
 	if (SELECTED) return;
@@ -267,6 +274,79 @@ static void removeAllReferencesToMoribundEditor (Editor editor) {
 		praatP. editor = nullptr;
 }
 
+/*
+	The full names of the objects are indexed,
+	so that scripts can find objects by name without scanning the whole list.
+*/
+static void indexFullName (int iobject) {
+	std::vector <integer>& ids = theCurrentPraatObjects -> idsByFullName [theCurrentPraatObjects -> list [iobject]. name];
+	integer id = theCurrentPraatObjects -> list [iobject]. id;
+	ids. insert (std::lower_bound (ids. begin (), ids. end (), id), id);   // normally at the end
+}
+
+static void unindexFullName (int iobject) {
+	auto found = theCurrentPraatObjects -> idsByFullName. find (theCurrentPraatObjects -> list [iobject]. name);
+	Melder_assert (found != theCurrentPraatObjects -> idsByFullName. end ());
+	std::vector <integer>& ids = found -> second;
+	auto id = std::lower_bound (ids. begin (), ids. end (), theCurrentPraatObjects -> list [iobject]. id);
+	Melder_assert (id != ids. end () && *id == theCurrentPraatObjects -> list [iobject]. id);
+	ids. erase (id);
+	if (ids. empty ())
+		theCurrentPraatObjects -> idsByFullName. erase (found);
+}
+
+void praat_setFullName (int iobject, const char32 *fullName) {
+	unindexFullName (iobject);
+	Melder_free (theCurrentPraatObjects -> list [iobject]. name);
+	theCurrentPraatObjects -> list [iobject]. name = Melder_dup_f (fullName);
+	indexFullName (iobject);
+}
+
+int praat_objectPositionFromId (integer id) {
+	/*
+		The objects are in the list in the order of their creation, so that their IDs increase.
+	*/
+	int low = 1, high = theCurrentPraatObjects -> n;
+	while (low <= high) {
+		int mid = (low + high) / 2;
+		integer midId = theCurrentPraatObjects -> list [mid]. id;
+		if (midId == id)
+			return mid;
+		if (midId < id)
+			low = mid + 1;
+		else
+			high = mid - 1;
+	}
+	return 0;
+}
+
+int praat_objectPositionFromName (const char32 *className, const char32 *givenName) {
+	int IOBJECT;
+	static MelderString fullName { };
+	MelderString_copy (& fullName, className, U" ", givenName);
+	auto found = theCurrentPraatObjects -> idsByFullName. find (fullName.string);
+	if (found != theCurrentPraatObjects -> idsByFullName. end ()) {
+		const std::vector <integer>& ids = found -> second;
+		for (auto id = ids. rbegin (); id != ids. rend (); ++ id) {
+			IOBJECT = praat_objectPositionFromId (*id);
+			Melder_assert (IOBJECT != 0);
+			Daata object = OBJECT;
+			if (str32equ (className, Thing_className (OBJECT)) && str32equ (givenName, object -> name))
+				return IOBJECT;
+		}
+	}
+	/*
+		The name of an object normally equals its name in the list,
+		but a command may have renamed the object itself.
+	*/
+	WHERE_DOWN (1) {
+		Daata object = OBJECT;
+		if (str32equ (className, Thing_className (OBJECT)) && str32equ (givenName, object -> name))
+			return IOBJECT;
+	}
+	return 0;
+}
+
 /**
 	Remove the "object" from the list,
 	killing everything that has to do with the selection.
@@ -297,8 +377,9 @@ static void praat_remove (int iobject, bool removeVisibly) {
 			trace (U"forgeotten editor ", ieditor);
 		}
 	}
-	MelderFile_setToNull (& theCurrentPraatObjects -> list [iobject]. file);
+	Melder_free (theCurrentPraatObjects -> list [iobject]. file);
 	trace (U"free name");
+	unindexFullName (iobject);
 	Melder_free (theCurrentPraatObjects -> list [iobject]. name);
 	trace (U"forget object");
 	forget (theCurrentPraatObjects -> list [iobject]. object);   // note: this might save a file-based object to file
@@ -349,12 +430,9 @@ void praat_newWithFile (autoDaata me, MelderFile file, const char32 *myName) {
 	praat_cleanUpName (givenName.string);
 	MelderString_append (& name, Thing_className (me.get()), U" ", givenName.string);
 
-	if (theCurrentPraatObjects -> n == praat_MAXNUM_OBJECTS) {
-		//forget (me);
-		Melder_throw (U"The Object Window cannot contain more than ", praat_MAXNUM_OBJECTS, U" objects. You could remove some objects.");
-	}
-		
 	int IOBJECT = ++ theCurrentPraatObjects -> n;
+	if (theCurrentPraatObjects -> list. size () <= (size_t) IOBJECT)
+		theCurrentPraatObjects -> list. resize (IOBJECT + 1);   // the new elements are zeroed; element 0 is not used
 	Melder_assert (FULL_NAME == nullptr);
 	FULL_NAME = Melder_dup_f (name.string);   // all right to crash if out of memory
 	++ theCurrentPraatObjects -> uniqueId;
@@ -369,13 +447,14 @@ void praat_newWithFile (autoDaata me, MelderFile file, const char32 *myName) {
 	SELECTED = false;
 	for (int ieditor = 0; ieditor < praat_MAXNUM_EDITORS; ieditor ++)
 		EDITOR [ieditor] = nullptr;
+	Melder_assert (! theCurrentPraatObjects -> list [IOBJECT]. file);
 	if (file) {
-		MelderFile_copy (file, & theCurrentPraatObjects -> list [IOBJECT]. file);
-	} else {
-		MelderFile_setToNull (& theCurrentPraatObjects -> list [IOBJECT]. file);
+		theCurrentPraatObjects -> list [IOBJECT]. file = Melder_calloc_f (structMelderFile, 1);   // all right to crash if out of memory
+		MelderFile_copy (file, theCurrentPraatObjects -> list [IOBJECT]. file);
 	}
 	ID = theCurrentPraatObjects -> uniqueId;
 	theCurrentPraatObjects -> list [IOBJECT]. isBeingCreated = true;
+	indexFullName (IOBJECT);
 	Thing_setName (OBJECT, givenName.string);
 	theCurrentPraatObjects -> totalBeingCreated ++;
 }
@@ -424,11 +503,12 @@ void praat_updateSelection () {
 	if (theCurrentPraatObjects -> totalBeingCreated) {
 		int IOBJECT;
 		praat_deselectAll ();
-		WHERE (theCurrentPraatObjects -> list [IOBJECT]. isBeingCreated) {
+		WHERE_DOWN (theCurrentPraatObjects -> list [IOBJECT]. isBeingCreated) {   // the new objects are at the end
 			praat_select (IOBJECT);
 			theCurrentPraatObjects -> list [IOBJECT]. isBeingCreated = false;
+			if (-- theCurrentPraatObjects -> totalBeingCreated == 0) break;
 		}
-		theCurrentPraatObjects -> totalBeingCreated = 0;
+		Melder_assert (theCurrentPraatObjects -> totalBeingCreated == 0);
 		praat_show ();
 	}
 }
@@ -496,16 +576,35 @@ void praat_removeObject (int i) {
 	theCurrentPraatObjects -> list [theCurrentPraatObjects -> n]. isSelected = 0;
 	for (int ieditor = 0; ieditor < praat_MAXNUM_EDITORS; ieditor ++)
 		theCurrentPraatObjects -> list [theCurrentPraatObjects -> n]. editors [ieditor] = nullptr;   // undangle or remove second reference
-	MelderFile_setToNull (& theCurrentPraatObjects -> list [theCurrentPraatObjects -> n]. file);   // undangle or remove second reference
+	theCurrentPraatObjects -> list [theCurrentPraatObjects -> n]. file = nullptr;   // undangle or remove second reference
 	-- theCurrentPraatObjects -> n;
 	if (! theCurrentPraatApplication -> batch) {
 		GuiList_deleteItem (praatList_objects, i);
 	}
 }
 
+static void saveTheProfile () {
+	MelderProfile_stop ();
+	try {
+		if (Melder_stringMatchesCriterion (praatP.profileFile. path, kMelder_string::ENDS_WITH, U".json", false)) {
+			MelderProfile_saveAsChromeTrace (& praatP.profileFile);
+		} else {
+			autoMelderString report;
+			MelderProfile_writeReport (& report);
+			MelderFile_writeText (& praatP.profileFile, report.string, kMelder_textOutputEncoding::UTF8);
+		}
+	} catch (MelderError) {
+		Melder_flushError ();
+	}
+}
+
 static void praat_exit (int exit_code) {
 //Melder_setTracing (true);
 	int IOBJECT;
+	if (praatP.profileFile. path [0]) {
+		trace (U"save the profile");
+		saveTheProfile ();
+	}
 	#ifdef _WIN32
 		if (! theCurrentPraatApplication -> batch) {
 			Melder_assert (theCurrentPraatApplication);
@@ -524,8 +623,9 @@ static void praat_exit (int exit_code) {
 		#if defined (UNIX)
 			/*
 			 * We are going to delete the process id ("pid") file, if it's ours.
+			 * In batch, we did not write it (so the check is skipped, which saves the cost of a first exception).
 			 */
-			if (pidFile. path [0]) {
+			if (pidFile. path [0] && ! Melder_batch) {
 				try {
 					/*
 					 * To see whether we own the pid file,
@@ -571,8 +671,8 @@ static void praat_exit (int exit_code) {
 	}
 
 	trace (U"flush the file-based objects");
-	WHERE_DOWN (! MelderFile_isNull (& theCurrentPraatObjects -> list [IOBJECT]. file)) {
-		trace (U"removing object based on file ", & theCurrentPraatObjects -> list [IOBJECT]. file);
+	WHERE_DOWN (! MelderFile_isNull (theCurrentPraatObjects -> list [IOBJECT]. file)) {
+		trace (U"removing object based on file ", theCurrentPraatObjects -> list [IOBJECT]. file);
 		praat_remove (IOBJECT, false);
 	}
 	Melder_files_cleanUp ();   // in case a URL is open
@@ -1102,6 +1202,13 @@ void praat_init (const char32 *title, int argc, char **argv)
 		} else if (strnequ (argv [praatP.argumentNumber], "--pref-dir=", 11)) {
 			Melder_pathToDir (Melder_peek8to32 (argv [praatP.argumentNumber] + 11), & praatDir);
 			praatP.argumentNumber += 1;
+		} else if (strnequ (argv [praatP.argumentNumber], "--profile=", 10)) {
+			Melder_relativePathToFile (Melder_peek8to32 (argv [praatP.argumentNumber] + 10), & praatP.profileFile);
+			MelderProfile_start ();
+			praatP.argumentNumber += 1;
+		} else if (strnequ (argv [praatP.argumentNumber], "--server=", 9)) {
+			praatP.serverSocketPath = Melder_8to32 (argv [praatP.argumentNumber] + 9);
+			praatP.argumentNumber += 1;
 		} else if (strequ (argv [praatP.argumentNumber], "--version")) {
 			#define xstr(s) str(s)
 			#define str(s) #s
@@ -1117,6 +1224,11 @@ void praat_init (const char32 *title, int argc, char **argv)
 			MelderInfo_writeLine (U"  --no-pref-files  don't read or write the preferences file and the buttons file");
 			MelderInfo_writeLine (U"  --no-plugins     don't activate the plugins");
 			MelderInfo_writeLine (U"  --pref-dir=DIR   set the preferences directory to DIR");
+			MelderInfo_writeLine (U"  --profile=FILE   write time and allocations per script line, command and analysis to FILE");
+			MelderInfo_writeLine (U"                   when Praat quits (as a Chrome trace if FILE ends in .json)");
+			MelderInfo_writeLine (U"  --server=SOCKET  run the scripts that come in on the Unix-domain socket SOCKET");
+			MelderInfo_writeLine (U"                   (each connection sends a script file name and its arguments,");
+			MelderInfo_writeLine (U"                   and gets back OK or ERROR, followed by the Info or the error message)");
 			MelderInfo_writeLine (U"  --version        print the Praat version");
 			MelderInfo_writeLine (U"  --help           print this list of command line options");
 			MelderInfo_writeLine (U"  -a, --ansi       Windows only: use ISO Latin-1 encoding instead of UTF-16LE");
@@ -1143,6 +1255,8 @@ void praat_init (const char32 *title, int argc, char **argv)
 	weWereStartedFromTheCommandLine |= foundTheRunOption;   // some external system()-like commands don't make isatty return true, so we have to help
 
 	const bool thereIsAFileNameInTheArgumentList = ( praatP.argumentNumber < argc );
+	if (praatP.serverSocketPath && thereIsAFileNameInTheArgumentList)
+		Melder_throw (U"Cannot have both a script server and a script file.");
 	Melder_batch = weWereStartedFromTheCommandLine && thereIsAFileNameInTheArgumentList && ! foundTheOpenOption;
 	const bool fileNamesCameInByDropping = ( thereIsAFileNameInTheArgumentList && ! weWereStartedFromTheCommandLine );   // doesn't happen on the Mac
 	praatP.userWantsToOpen = foundTheOpenOption || fileNamesCameInByDropping;
@@ -1169,6 +1283,12 @@ void praat_init (const char32 *title, int argc, char **argv)
 	 */
 	Melder_batch |= praatP.hasCommandLineInput;
 
+	/*
+	 * Running Praat as a script server:
+	 *    praat --server=/tmp/praat.socket
+	 */
+	Melder_batch |= !! praatP.serverSocketPath;
+
 	praatP.title = Melder_dup (title && title [0] ? title : U"Praat");
 
 	theCurrentPraatApplication -> batch = Melder_batch;
@@ -1709,6 +1829,14 @@ void praat_run () {
 				Melder_flushError (praatP.title, U": stand-alone script session interrupted.");
 				praat_exit (-1);
 			}
+		} else if (praatP.serverSocketPath) {
+			try {
+				praat_serveScriptsFromSocket (praatP.serverSocketPath);
+				praat_exit (0);
+			} catch (MelderError) {
+				Melder_flushError (praatP.title, U": script server stopped.");
+				praat_exit (-1);
+			}
 		} else if (praatP.hasCommandLineInput) {
 			try {
 				praat_executeCommandFromStandardInput (praatP.title);
@@ -22,6 +22,10 @@
 #include "Manual.h"
 #include "Preferences.h"
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 /* The explanations in this header file assume
 	that you put your extra commands in praat_Sybil.cpp
 	and the main() function in main_Sybil.cpp,
@@ -154,14 +158,13 @@ typedef struct {
 	ClassInfo klas;   // the class
 	Daata object;   // the instance
 	char32 *name;   // the name of the object as it appears in the List
-	structMelderFile file;   // is this Object associated with a file?
+	MelderFile file;   // is this Object associated with a file? If so, owned; kept out of line, so that the list stays compact
 	integer id;   // the unique number of the object
 	bool isSelected;   // is the name of the object inverted in the list?
 	Editor editors [praat_MAXNUM_EDITORS];   // are there editors open with this Object in it?
 	bool isBeingCreated;
 } structPraat_Object, *praat_Object;
 
-#define praat_MAXNUM_OBJECTS 10000   /* Maximum number of objects in the list. */
 typedef struct {   /* Readonly */
 	MelderString batchName;   /* The name of the command file when called from batch. */
 	int batch;   /* Was the program called from the command line? */
@@ -170,11 +173,12 @@ typedef struct {   /* Readonly */
 } structPraatApplication, *PraatApplication;
 typedef struct {   /* Readonly */
 	int n;	 /* The current number of objects in the list. */
-	structPraat_Object list [1 + praat_MAXNUM_OBJECTS];   /* The list of objects: list [1..n]. */
+	std::vector <structPraat_Object> list;   /* The list of objects: list [1..n], in the order of creation, so with increasing IDs; grows as needed. */
 	int totalSelection;   /* The total number of selected objects, <= n. */
 	int numberOfSelected [1 + 1000];   /* For each (readable) class. */
 	int totalBeingCreated;
 	integer uniqueId;
+	std::unordered_map <std::u32string, std::vector <integer>> idsByFullName;   /* For each full name, the IDs of the objects that have it, in increasing order. */
 } structPraatObjects, *PraatObjects;
 typedef struct {   // readonly
 	Graphics graphics;   /* The Graphics associated with the Picture window or HyperPage window or Demo window. */
@@ -126,6 +126,9 @@ void praat_background ();
 void praat_foreground ();
 Editor praat_findEditorFromString (const char32 *string);
 Editor praat_findEditorById (integer id);
+int praat_objectPositionFromId (integer id);   // 0 if there is no object with this ID
+int praat_objectPositionFromName (const char32 *className, const char32 *givenName);   // the last one with this name; 0 if there is none
+void praat_setFullName (int iobject, const char32 *fullName);   // such as "Sound hallo"
 
 void praat_showLogo (bool autoPopDown);
 
@@ -188,6 +191,8 @@ extern struct PraatP {
 	bool dontUsePictureWindow;   // see praat_dontUsePictureWindow ()
 	bool ignorePreferenceFiles, ignorePlugins;
 	bool hasCommandLineInput;
+	char32 *serverSocketPath;   // non-null if scripts are to be received on a Unix-domain socket (see praat_serveScriptsFromSocket)
+	structMelderFile profileFile;   // non-empty if profiling was switched on from the command line
 	char32 *title;
 	GuiWindow menuBar;
 	int phase;
@@ -23,10 +23,30 @@
 #include "machine.h"
 #include "GuiP.h"
 
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #define BUTTON_LEFT  -240
 #define BUTTON_RIGHT -5
 
 static OrderedOf <structPraat_Command> theActions;
+
+/*
+ * For looking up script commands: from each title to the actions with that title, in the order of theActions.
+ * Rebuilt on first use after any action has been added, removed or moved.
+ */
+static std::unordered_map <std::u32string, std::vector <Praat_Command>> theActionsByTitle;
+static bool theActionsByTitleAreUpToDate = false;
+
+/*
+ * For placing new actions after existing ones at start-up: from each first class to the actions with that first class.
+ * Among the actions with the same selection specification, the order is that of theActions
+ * (this survives praat_sortActions (), which keeps that order).
+ * Kept up to date with every addition and removal.
+ */
+static std::unordered_map <ClassInfo, std::vector <Praat_Command>> theActionsByFirstClass;
 static GuiMenu praat_writeMenu;
 static GuiMenuItem praat_writeMenuSeparator;
 static GuiForm praat_form;
@@ -67,17 +87,44 @@ static void fixSelectionSpecification (ClassInfo *class1, integer *n1, ClassInfo
 	}
 }
 
+static integer positionOfAction (Praat_Command action) {
+	for (integer i = theActions.size; i > 0; i --)   // at start-up, the action was often added recently
+		if (theActions.at [i] == action) return i;
+	Melder_fatal (U"Action \"", action -> title, U"\" not in list.");
+	return 0;
+}
+
+static void insertAction (autoPraat_Command action, integer position) {
+	std::vector <Praat_Command>& actionsWithThisFirstClass = theActionsByFirstClass [action -> class1];
+	Praat_Command previous = ( position > 1 ? theActions.at [position - 1] : nullptr );
+	auto place = actionsWithThisFirstClass. end ();
+	if (position <= theActions.size && previous && previous -> class1 == action -> class1)   // inserting after an action with the same first class?
+		place = std::find (actionsWithThisFirstClass. begin (), actionsWithThisFirstClass. end (), previous) + 1;
+	actionsWithThisFirstClass. insert (place, action.get());
+	theActions. addItemAtPosition_move (action.move(), position);
+	theActionsByTitleAreUpToDate = false;
+}
+
+static void removeAction (integer position) {
+	Praat_Command action = theActions.at [position];
+	std::vector <Praat_Command>& actionsWithThisFirstClass = theActionsByFirstClass [action -> class1];
+	actionsWithThisFirstClass. erase (std::find (actionsWithThisFirstClass. begin (), actionsWithThisFirstClass. end (), action));
+	theActions. removeItem (position);
+	theActionsByTitleAreUpToDate = false;
+}
+
 static integer lookUpMatchingAction (ClassInfo class1, ClassInfo class2, ClassInfo class3, ClassInfo class4, const char32 *title) {
 /*
  * An action command is fully specified by its environment (the selected classes) and its title.
  * Precondition:
  *	class1, class2, and class3 must be in sorted order.
  */
-	for (integer i = 1; i <= theActions.size; i ++) {
-		Praat_Command action = theActions.at [i];
-		if (class1 == action -> class1 && class2 == action -> class2 &&
-		    class3 == action -> class3 && class4 == action -> class4 &&
-		    title && action -> title && str32equ (action -> title, title)) return i;
+	if (! title) return 0;
+	auto found = theActionsByFirstClass. find (class1);
+	if (found == theActionsByFirstClass. end ()) return 0;
+	for (Praat_Command action : found -> second) {
+		if (class2 == action -> class2 && class3 == action -> class3 && class4 == action -> class4 &&
+		    action -> title && str32equ (action -> title, title)) return positionOfAction (action);
 	}
 	return 0;   // not found
 }
@@ -160,7 +207,7 @@ void praat_addAction4_ (ClassInfo class1, integer n1, ClassInfo class2, integer
 		/*
 		 * Insert new command.
 		 */
-		theActions. addItemAtPosition_move (action.move(), position);
+		insertAction (action.move(), position);
 	} catch (MelderError) {
 		Melder_flushError ();
 	}
@@ -247,9 +294,8 @@ void praat_addActionScript (const char32 *className1, integer n1, const char32 *
 		 */
 		{// scope
 			integer found = lookUpMatchingAction (class1, class2, class3, nullptr, title);
-			if (found) {
-				theActions. removeItem (found);
-			}
+			if (found)
+				removeAction (found);
 		}
 
 		/*
@@ -298,7 +344,7 @@ void praat_addActionScript (const char32 *className1, integer n1, const char32 *
 		/*
 		 * Insert new command.
 		 */
-		theActions. addItemAtPosition_move (action.move(), position);
+		insertAction (action.move(), position);
 		updateDynamicMenu ();
 	} catch (MelderError) {
 		Melder_throw (U"Praat: script action not added.");
@@ -316,7 +362,7 @@ void praat_removeAction (ClassInfo class1, ClassInfo class2, ClassInfo class3, c
 				class3 ? U" & ": U"", class3 -> className,
 				U": ", title, U"\" not found.");
 		}
-		theActions. removeItem (found);
+		removeAction (found);
 	} catch (MelderError) {
 		Melder_throw (U"Praat: action not removed.");
 	}
@@ -455,6 +501,7 @@ void praat_sortActions () {
 		action -> sortingTail = i;
 	}
 	qsort (& theActions.at [1], theActions.size, sizeof (Praat_Command), compareActions);
+	theActionsByTitleAreUpToDate = false;
 }
 
 static const char32 *numberString (int number) {
@@ -517,6 +564,7 @@ static void do_menu (Praat_Command me, bool modified) {
 		}
 		Ui_setAllowExecutionHook (allowExecutionHook, (void *) my callback);   // BUG: one shouldn't assign a function pointer to a void pointer
 		try {
+			autoMelderProfileScope profile (U"command", my title);
 			my callback (nullptr, 0, nullptr, nullptr, nullptr, my title, modified, nullptr);
 		} catch (MelderError) {
 			Melder_flushError (U"Command \"", my title, U"\" not executed.");
@@ -535,6 +583,33 @@ static void gui_button_cb_menu (Praat_Command me, GuiButtonEvent event) {
 	do_menu (me, event -> shiftKeyPressed | event -> commandKeyPressed | event -> optionKeyPressed | event -> extraControlKeyPressed);
 }
 
+static void getVisibilityAndExecutability (Praat_Command action, bool *out_visible, bool *out_executable) {
+/*
+ * For the current selection.
+ */
+	integer sel1 = 0, sel2 = 0, sel3 = 0, sel4 = 0;
+	integer n1 = action -> n1, n2 = action -> n2, n3 = action -> n3, n4 = action -> n4;
+	*out_visible = false;
+	*out_executable = false;
+
+	/* Match the actually selected classes with the selection required for this visibility. */
+
+	if (! action -> class1) return;   // at least one class selected
+	sel1 = action -> class1 == classDaata ? theCurrentPraatObjects -> totalSelection : praat_numberOfSelected (action -> class1);
+	if (sel1 == 0) return;
+	if (action -> class2 && (sel2 = praat_numberOfSelected (action -> class2)) == 0) return;
+	if (action -> class3 && (sel3 = praat_numberOfSelected (action -> class3)) == 0) return;
+	if (action -> class4 && (sel4 = praat_numberOfSelected (action -> class4)) == 0) return;
+	if (sel1 + sel2 + sel3 + sel4 != theCurrentPraatObjects -> totalSelection) return;   // other classes selected? Do not show
+	*out_visible = ! action -> hidden;
+
+	/* Match the actually selected objects with the selection required for this action. */
+
+	if (! action -> callback) return;   // separators are not executable
+	if ((n1 && sel1 != n1) || (n2 && sel2 != n2) || (n3 && sel3 != n3) || (n4 && sel4 != n4)) return;
+	*out_executable = true;
+}
+
 void praat_actions_show () {
 	#if defined (macintosh)
 		const int BUTTON_VSPACING = 8;
@@ -557,32 +632,17 @@ void praat_actions_show () {
 		if (theCurrentPraatObjects -> totalSelection != 0 && ! Melder_backgrounding)
 			GuiThing_setSensitive (praat_writeMenu, true);
 	}
+	/*
+	 * In batch, nobody sees the buttons, so the visibility and sensitivity of all the actions are not needed;
+	 * a script command finds out whether its action is executable in lookUpExecutableAction ().
+	 */
+	if (theCurrentPraatApplication -> batch) return;
 	for (integer i = 1; i <= theActions.size; i ++) {
 		Praat_Command action = theActions.at [i];
-		integer sel1 = 0, sel2 = 0, sel3 = 0, sel4 = 0;
-		integer n1 = action -> n1, n2 = action -> n2, n3 = action -> n3, n4 = action -> n4;
-
-		/* Clean up from previous selection. */
-
-		action -> visible = false;
-		action -> executable = false;
-
-		/* Match the actually selected classes with the selection required for this visibility. */
-
-		if (! action -> class1) continue;   // at least one class selected
-		sel1 = action -> class1 == classDaata ? theCurrentPraatObjects -> totalSelection : praat_numberOfSelected (action -> class1);
-		if (sel1 == 0) continue;
-		if (action -> class2 && (sel2 = praat_numberOfSelected (action -> class2)) == 0) continue;
-		if (action -> class3 && (sel3 = praat_numberOfSelected (action -> class3)) == 0) continue;
-		if (action -> class4 && (sel4 = praat_numberOfSelected (action -> class4)) == 0) continue;
-		if (sel1 + sel2 + sel3 + sel4 != theCurrentPraatObjects -> totalSelection) continue;   // other classes selected? Do not show
-		action -> visible = ! action -> hidden;
-
-		/* Match the actually selected objects with the selection required for this action. */
-
-		if (! action -> callback) continue;   // separators are not executable
-		if ((n1 && sel1 != n1) || (n2 && sel2 != n2) || (n3 && sel3 != n3) || (n4 && sel4 != n4)) continue;
-		action -> executable = true;
+		bool visible, executable;
+		getVisibilityAndExecutability (action, & visible, & executable);
+		action -> visible = visible;
+		action -> executable = executable;
 	}
 
 	/* Create a new column of buttons in the dynamic menu. */
@@ -713,19 +773,45 @@ void praat_saveToggledActions (MelderString *buffer) {
 	}
 }
 
+static Praat_Command lookUpExecutableAction (const char32 *title) {
+/*
+ * The first action in the list that has this title and is executable with the current selection.
+ */
+	if (! theActionsByTitleAreUpToDate) {
+		theActionsByTitle. clear ();
+		for (integer i = 1; i <= theActions.size; i ++) {
+			Praat_Command action = theActions.at [i];
+			if (action -> title)
+				theActionsByTitle [action -> title]. push_back (action);
+		}
+		theActionsByTitleAreUpToDate = true;
+	}
+	auto found = theActionsByTitle. find (title);
+	if (found == theActionsByTitle. end ()) return nullptr;
+	for (Praat_Command action : found -> second) {
+		bool executable = action -> executable;
+		if (theCurrentPraatApplication -> batch) {   // not kept up to date by praat_actions_show ()
+			bool visible;
+			getVisibilityAndExecutability (action, & visible, & executable);
+		}
+		if (executable) return action;
+	}
+	return nullptr;
+}
+
 int praat_doAction (const char32 *command, const char32 *arguments, Interpreter interpreter) {
-	integer i = 1;
-	while (i <= theActions.size && (! theActions.at [i] -> executable || str32cmp (theActions.at [i] -> title, command))) i ++;
-	if (i > theActions.size) return 0;   // not found
-	theActions.at [i] -> callback (nullptr, 0, nullptr, arguments, interpreter, command, false, nullptr);
+	Praat_Command action = lookUpExecutableAction (command);
+	if (! action) return 0;   // not found
+	autoMelderProfileScope profile (U"command", command);
+	action -> callback (nullptr, 0, nullptr, arguments, interpreter, command, false, nullptr);
 	return 1;
 }
 
 int praat_doAction (const char32 *command, integer narg, Stackel args, Interpreter interpreter) {
-	integer i = 1;
-	while (i <= theActions.size && (! theActions.at [i] -> executable || str32cmp (theActions.at [i] -> title, command))) i ++;
-	if (i > theActions.size) return 0;   // not found
-	theActions.at [i] -> callback (nullptr, narg, args, nullptr, interpreter, command, false, nullptr);
+	Praat_Command action = lookUpExecutableAction (command);
+	if (! action) return 0;   // not found
+	autoMelderProfileScope profile (U"command", command);
+	action -> callback (nullptr, narg, args, nullptr, interpreter, command, false, nullptr);
 	return 1;
 }
 
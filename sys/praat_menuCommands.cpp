@@ -21,8 +21,20 @@
 #include "praat_version.h"
 #include "GuiP.h"
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 static OrderedOf <structPraat_Command> theCommands;
 
+/*
+ * For looking up script commands: from each title to the commands in the Objects and Picture windows
+ * that have that title, in the order of theCommands.
+ * Rebuilt on first use after any command has been added or moved.
+ */
+static std::unordered_map <std::u32string, std::vector <Praat_Command>> theCommandsByTitle;
+static bool theCommandsByTitleAreUpToDate = false;
+
 void praat_menuCommands_init () {
 }
 
@@ -48,6 +60,7 @@ void praat_sortMenuCommands () {
 		command -> sortingTail = i;
 	}
 	qsort (& theCommands.at [1], theCommands.size, sizeof (Praat_Command), compareMenuCommands);
+	theCommandsByTitleAreUpToDate = false;
 }
 
 static integer lookUpMatchingMenuCommand (const char32 *window, const char32 *menu, const char32 *title) {
@@ -81,6 +94,7 @@ static void do_menu (Praat_Command me, uint32 modified) {
 			UiHistory_write (my title);
 		}
 		try {
+			autoMelderProfileScope profile (U"command", my title);
 			my callback (nullptr, 0, nullptr, nullptr, nullptr, my title, modified, nullptr);
 		} catch (MelderError) {
 			Melder_flushError (U"Command \"", my title, U"\" not executed.");
@@ -225,6 +239,7 @@ GuiMenuItem praat_addMenuCommand_ (const char32 *window, const char32 *menu, con
 	}
 	Thing_cast (GuiMenuItem, button_as_GuiMenuItem, command -> button);
 	theCommands. addItemAtPosition_move (command.move(), position);
+	theCommandsByTitleAreUpToDate = false;
 	return button_as_GuiMenuItem;
 }
 
@@ -316,6 +331,7 @@ void praat_addMenuCommandScript (const char32 *window, const char32 *menu, const
 			}
 		}
 		theCommands. addItemAtPosition_move (command.move(), position);
+		theCommandsByTitleAreUpToDate = false;
 
 		if (praatP.phase >= praat_HANDLING_EVENTS) praat_sortMenuCommands ();
 	} catch (MelderError) {
@@ -399,6 +415,7 @@ void praat_addFixedButtonCommand_ (GuiForm parent, const char32 *title, UiCallba
 	}
 	my executable = false;
 	theCommands. addItemAtPosition_move (me.move(), 0);
+	theCommandsByTitleAreUpToDate = false;
 }
 
 void praat_sensitivizeFixedButtonCommand (const char32 *title, int sensitive) {
@@ -416,34 +433,39 @@ void praat_sensitivizeFixedButtonCommand (const char32 *title, int sensitive) {
 		GuiThing_setSensitive (commandFound -> button, sensitive);
 }
 
-int praat_doMenuCommand (const char32 *title, const char32 *arguments, Interpreter interpreter) {
-	Praat_Command commandFound = nullptr;
-	for (integer i = 1; i <= theCommands.size; i ++) {
-		Praat_Command command = theCommands.at [i];
-		if (command -> executable && str32equ (command -> title, title) &&
-			(str32equ (command -> window, U"Objects") || str32equ (command -> window, U"Picture")))
-		{
-			commandFound = command;
-			break;
+static Praat_Command lookUpExecutableMenuCommand (const char32 *title) {
+/*
+ * The first command in the Objects or Picture window that has this title and is executable.
+ */
+	if (! theCommandsByTitleAreUpToDate) {
+		theCommandsByTitle. clear ();
+		for (integer i = 1; i <= theCommands.size; i ++) {
+			Praat_Command command = theCommands.at [i];
+			if (command -> title && command -> window &&
+				(str32equ (command -> window, U"Objects") || str32equ (command -> window, U"Picture")))
+				theCommandsByTitle [command -> title]. push_back (command);
 		}
+		theCommandsByTitleAreUpToDate = true;
 	}
+	auto found = theCommandsByTitle. find (title);
+	if (found == theCommandsByTitle. end ()) return nullptr;
+	for (Praat_Command command : found -> second)
+		if (command -> executable) return command;
+	return nullptr;
+}
+
+int praat_doMenuCommand (const char32 *title, const char32 *arguments, Interpreter interpreter) {
+	Praat_Command commandFound = lookUpExecutableMenuCommand (title);
 	if (! commandFound) return 0;
+	autoMelderProfileScope profile (U"command", title);
 	commandFound -> callback (nullptr, 0, nullptr, arguments, interpreter, title, false, nullptr);
 	return 1;
 }
 
 int praat_doMenuCommand (const char32 *title, integer narg, Stackel args, Interpreter interpreter) {
-	Praat_Command commandFound = nullptr;
-	for (integer i = 1; i <= theCommands.size; i ++) {
-		Praat_Command command = theCommands.at [i];
-		if (command -> executable && str32equ (command -> title, title) &&
-			(str32equ (command -> window, U"Objects") || str32equ (command -> window, U"Picture")))
-		{
-			commandFound = command;
-			break;
-		}
-	}
+	Praat_Command commandFound = lookUpExecutableMenuCommand (title);
 	if (! commandFound) return 0;
+	autoMelderProfileScope profile (U"command", title);
 	commandFound -> callback (nullptr, narg, args, nullptr, interpreter, title, false, nullptr);
 	return 1;
 }
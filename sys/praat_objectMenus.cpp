@@ -55,7 +55,7 @@ DO
 	static MelderString fullName { };
 	MelderString_copy (& fullName, Thing_className (OBJECT), U" ", string.string);
 	if (! str32equ (fullName.string, FULL_NAME)) {
-		Melder_free (FULL_NAME), FULL_NAME = Melder_dup_f (fullName.string);
+		praat_setFullName (IOBJECT, fullName.string);
 		autoMelderString listName;
 		MelderString_append (& listName, ID, U". ", fullName.string);
 		praat_list_renameAndSelect (IOBJECT, listName.string);
@@ -84,7 +84,7 @@ DIRECT (INFO_Info) {
 		Melder_throw (U"Selection changed!\nNo object selected. Cannot query.");
 	if (theCurrentPraatObjects -> totalSelection > 1)
 		Melder_throw (U"Selection changed!\nCannot query more than one object at a time.");
-	WHERE (SELECTED) Thing_infoWithIdAndFile (OBJECT, ID, & theCurrentPraatObjects -> list [IOBJECT]. file);
+	WHERE (SELECTED) Thing_infoWithIdAndFile (OBJECT, ID, theCurrentPraatObjects -> list [IOBJECT]. file);
 END }
 
 DIRECT (WINDOW_Inspect) {
@@ -403,6 +403,26 @@ DIRECT (INFO_reportMemoryUse) {
 	praat_reportMemoryUse ();
 END }
 
+DIRECT (PRAAT_startProfiling) {
+	MelderProfile_start ();
+END }
+
+DIRECT (PRAAT_stopProfiling) {
+	MelderProfile_stop ();
+END }
+
+DIRECT (INFO_reportProfile) {
+	autoMelderString report;
+	MelderProfile_writeReport (& report);
+	MelderInfo_open ();
+	MelderInfo_write (report.string);
+	MelderInfo_close ();
+END }
+
+FORM_SAVE (SAVE_saveProfileAsChromeTrace, U"Save profile as Chrome trace file", nullptr, U"profile.json") {
+	MelderProfile_saveAsChromeTrace (file);
+END }
+
 DIRECT (INFO_reportTextProperties) {
 	praat_reportTextProperties ();
 END }
@@ -690,6 +710,11 @@ void praat_addMenus (GuiWindow window) {
 	praat_addMenuCommand (U"Objects", U"Technical", U"Report text properties", nullptr, 0, INFO_reportTextProperties);
 	praat_addMenuCommand (U"Objects", U"Technical", U"Report system properties", nullptr, 0, INFO_reportSystemProperties);
 	praat_addMenuCommand (U"Objects", U"Technical", U"Report graphical properties", nullptr, 0, INFO_reportGraphicalProperties);
+	praat_addMenuCommand (U"Objects", U"Technical", U"-- profiling --", nullptr, 0, nullptr);
+	praat_addMenuCommand (U"Objects", U"Technical", U"Start profiling", nullptr, 0, PRAAT_startProfiling);
+	praat_addMenuCommand (U"Objects", U"Technical", U"Stop profiling", nullptr, 0, PRAAT_stopProfiling);
+	praat_addMenuCommand (U"Objects", U"Technical", U"Report profile", nullptr, 0, INFO_reportProfile);
+	praat_addMenuCommand (U"Objects", U"Technical", U"Save profile as Chrome trace file...", nullptr, 0, SAVE_saveProfileAsChromeTrace);
 	praat_addMenuCommand (U"Objects", U"Technical", U"Debug...", nullptr, 0, PRAAT_debug);
 	praat_addMenuCommand (U"Objects", U"Technical", U"-- api --", nullptr, 0, nullptr);
 	praat_addMenuCommand (U"Objects", U"Technical", U"List readable types of objects", nullptr, 0, INFO_listReadableTypesOfObjects);
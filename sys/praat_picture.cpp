@@ -443,6 +443,17 @@ FORM_SAVE (GRAPHICS_Picture_writeToFontlessEpsFile_silipa, U"Save as fontless EP
 	Picture_writeToEpsFile (praat_picture.get(), file, false, true);
 END }
 
+FORM (GRAPHICS_Picture_startSavingInBackground, U"Start saving in background", U"Start saving in background...") {
+	NATURAL (numberOfThreads, U"Number of threads", U"4")
+	OK
+DO
+	Picture_startSavingInBackground (numberOfThreads);
+END }
+
+DIRECT (GRAPHICS_Picture_finishSavingInBackground) {
+	Picture_finishSavingInBackground ();
+END }
+
 FORM_SAVE (GRAPHICS_Picture_writeToPdfFile, U"Save as PDF file", nullptr, U"praat.pdf") {
 	if (theCurrentPraatPicture == & theForegroundPraatPicture) {
 		Picture_writeToPdfFile (praat_picture.get(), file);
@@ -1530,6 +1541,11 @@ GuiMenu praat_picture_resolveMenu (const char32 *menu) {
 }
 
 void praat_picture_exit () {
+	try {
+		Picture_finishSavingInBackground ();
+	} catch (MelderError) {
+		Melder_flushError ();
+	}
 	praat_picture.reset();
 }
 
@@ -1670,6 +1686,8 @@ void praat_picture_init () {
 		praat_addMenuCommand (U"Picture", U"File",   U"Write to fontless EPS file (XIPA)...", U"*Save as fontless EPS file (XIPA)...", praat_DEPTH_1 | praat_DEPRECATED_2011, GRAPHICS_Picture_writeToFontlessEpsFile_xipa);
 		praat_addMenuCommand (U"Picture", U"File", U"Save as fontless EPS file (SILIPA)...", nullptr, 1, GRAPHICS_Picture_writeToFontlessEpsFile_silipa);
 		praat_addMenuCommand (U"Picture", U"File",   U"Write to fontless EPS file (SILIPA)...", U"*Save as fontless EPS file (SILIPA)...", praat_DEPTH_1 | praat_DEPRECATED_2011, GRAPHICS_Picture_writeToFontlessEpsFile_silipa);
+		praat_addMenuCommand (U"Picture", U"File", U"Start saving in background...", nullptr, 1, GRAPHICS_Picture_startSavingInBackground);
+		praat_addMenuCommand (U"Picture", U"File", U"Finish saving in background", nullptr, 1, GRAPHICS_Picture_finishSavingInBackground);
 	#ifdef _WIN32
 		praat_addMenuCommand (U"Picture", U"File", U"Save as Windows metafile...", nullptr, 0, GRAPHICS_Picture_writeToWindowsMetafile);
 		praat_addMenuCommand (U"Picture", U"File",   U"Write to Windows metafile...", U"*Save as Windows metafile...", praat_DEPRECATED_2011, GRAPHICS_Picture_writeToWindowsMetafile);
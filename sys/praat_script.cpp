@@ -17,16 +17,25 @@
  */
 
 #include <ctype.h>
+#if defined (UNIX)
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <sys/wait.h>
+	#include <unistd.h>
+#endif
 #include "praatP.h"
 #include "praat_script.h"
 #include "sendpraat.h"
 #include "sendsocket.h"
 #include "UiPause.h"
+#include "MelderThread.h"
 #include "DemoEditor.h"
+#include "Picture.h"
 
 static int praat_findObjectFromString (Interpreter interpreter, const char32 *string) {
 	try {
-		int IOBJECT;
 		while (*string == U' ') string ++;
 		if (*string >= U'A' && *string <= U'Z') {
 			/*
@@ -39,20 +48,16 @@ static int praat_findObjectFromString (Interpreter interpreter, const char32 *st
 				Melder_throw (U"Missing space in name.");
 			*space = U'\0';
 			char32 *className = & buffer.string [0], *givenName = space + 1;
-			WHERE_DOWN (1) {
-				Daata object = (Daata) OBJECT;
-				if (str32equ (className, Thing_className (OBJECT)) && str32equ (givenName, object -> name))
-					return IOBJECT;
-			}
+			int IOBJECT = praat_objectPositionFromName (className, givenName);
+			if (IOBJECT != 0)
+				return IOBJECT;
 			/*
 			 * No object with that name. Perhaps the class name was wrong?
 			 */
 			ClassInfo klas = Thing_classFromClassName (className, NULL);
-			WHERE_DOWN (1) {
-				Daata object = (Daata) OBJECT;
-				if (str32equ (klas -> className, Thing_className (OBJECT)) && str32equ (givenName, object -> name))
-					return IOBJECT;
-			}
+			IOBJECT = praat_objectPositionFromName (klas -> className, givenName);
+			if (IOBJECT != 0)
+				return IOBJECT;
 			Melder_throw (U"No object with that name.");
 		} else {
 			/*
@@ -61,7 +66,8 @@ static int praat_findObjectFromString (Interpreter interpreter, const char32 *st
 			double value;
 			Interpreter_numericExpression (interpreter, string, & value);
 			integer id = (integer) value;
-			WHERE (ID == id)
+			int IOBJECT = praat_objectPositionFromId (id);
+			if (IOBJECT != 0)
 				return IOBJECT;
 			Melder_throw (U"No object with number ", id, U".");
 		}
@@ -99,13 +105,11 @@ Editor praat_findEditorFromString (const char32 *string) {
 }
 
 Editor praat_findEditorById (integer id) {
-	int IOBJECT;
-	WHERE (1) {
-		if (ID == id) {
-			for (int ieditor = 0; ieditor < praat_MAXNUM_EDITORS; ieditor ++) {
-				Editor editor = theCurrentPraatObjects -> list [IOBJECT]. editors [ieditor];
-				if (editor) return editor;
-			}
+	int IOBJECT = praat_objectPositionFromId (id);
+	if (IOBJECT != 0) {
+		for (int ieditor = 0; ieditor < praat_MAXNUM_EDITORS; ieditor ++) {
+			Editor editor = theCurrentPraatObjects -> list [IOBJECT]. editors [ieditor];
+			if (editor) return editor;
 		}
 	}
 	Melder_throw (U"Editor ", id, U" does not exist.");
@@ -539,6 +543,134 @@ void praat_executeCommandFromStandardInput (const char32 *programName) {
 	}
 }
 
+#if defined (UNIX)
+static void writeAllToSocket (int socketDescriptor, const char *bytes) {
+	size_t numberOfBytesToWrite = strlen (bytes);
+	while (numberOfBytesToWrite > 0) {
+		ssize_t numberOfBytesWritten = write (socketDescriptor, bytes, numberOfBytesToWrite);
+		if (numberOfBytesWritten < 0) {
+			if (errno == EINTR) continue;
+			return;   // the client has gone; nobody to report to
+		}
+		bytes += numberOfBytesWritten;
+		numberOfBytesToWrite -= (size_t) numberOfBytesWritten;
+	}
+}
+
+static void serveOneScript (int connection) {
+	/*
+		We are in a child process that was forked from the server,
+		so the script starts from the server's warm state (commands registered, no objects, empty Info window),
+		and whatever the script does to the objects, the Info window or the default directory
+		is gone when the child exits.
+	*/
+	std::string request8;
+	for (;;) {
+		char buffer [4096];
+		ssize_t numberOfBytesRead = read (connection, buffer, sizeof buffer);
+		if (numberOfBytesRead < 0 && errno == EINTR) continue;
+		if (numberOfBytesRead <= 0) break;
+		const char *newline = (const char *) memchr (buffer, '\n', (size_t) numberOfBytesRead);
+		request8. append (buffer, newline ? (size_t) (newline - buffer) : (size_t) numberOfBytesRead);
+		if (newline) break;
+	}
+	if (! request8. empty () && request8. back () == '\r')
+		request8. pop_back ();
+	/*
+		In batch, the Info is also written to standard output, which is not the client's.
+	*/
+	int devNull = open ("/dev/null", O_WRONLY);
+	if (devNull >= 0) {
+		dup2 (devNull, STDOUT_FILENO);
+		close (devNull);
+	}
+	try {
+		/*
+			The request is a script file name followed by the script's arguments, as after "praat --run".
+		*/
+		autostring32 request = Melder_8to32 (request8. c_str ());
+		praat_executeScriptFromFileNameWithArguments (request.peek());
+		/*
+			The child exits as soon as it has replied, so pictures that the script
+			is still saving in the background have to be written (or have failed) before the reply.
+		*/
+		Picture_finishSavingInBackground ();
+		writeAllToSocket (connection, "OK\n");
+		writeAllToSocket (connection, Melder_peek32to8 (Melder_getInfo ()));
+	} catch (MelderError) {
+		try {
+			Picture_finishSavingInBackground ();
+		} catch (MelderError) {
+			// any saving errors have been appended to the script's error
+		}
+		writeAllToSocket (connection, "ERROR\n");
+		writeAllToSocket (connection, Melder_peek32to8 (Melder_getError ()));
+	}
+	close (connection);
+}
+#endif
+
+void praat_serveScriptsFromSocket (const char32 *socketPath) {
+	#if defined (UNIX)
+		const char *socketPath8 = Melder_peek32to8 (socketPath);
+		struct sockaddr_un address { };
+		address. sun_family = AF_UNIX;
+		if (strlen (socketPath8) >= sizeof address. sun_path)
+			Melder_throw (U"Socket path ", socketPath, U" is too long.");
+		strcpy (address. sun_path, socketPath8);
+		int listener = socket (AF_UNIX, SOCK_STREAM, 0);
+		if (listener < 0)
+			Melder_throw (U"Cannot create a socket.");
+		unlink (socketPath8);   // a left-over from an earlier server
+		if (bind (listener, (struct sockaddr *) & address, sizeof address) < 0 || listen (listener, SOMAXCONN) < 0) {
+			close (listener);
+			Melder_throw (U"Cannot listen on socket ", socketPath, U".");
+		}
+		/*
+			The first exception in a process is slow, because the unwinder has to find its tables.
+			Get that over with here, so that not every failing script pays for it again.
+		*/
+		try {
+			Melder_throw (U"Warming up.");
+		} catch (MelderError) {
+			Melder_clearError ();
+		}
+		/*
+			Each script runs in its own child process, so that scripts can run concurrently
+			and cannot see each other's objects. Beyond one script per processor,
+			a new connection waits until an earlier script has finished.
+		*/
+		const int maximumNumberOfRunningScripts = MelderThread_getNumberOfProcessors ();
+		int numberOfRunningScripts = 0;
+		for (;;) {
+			while (numberOfRunningScripts > 0 &&
+			       waitpid (-1, nullptr, numberOfRunningScripts < maximumNumberOfRunningScripts ? WNOHANG : 0) > 0)
+				numberOfRunningScripts --;
+			int connection = accept (listener, nullptr, nullptr);
+			if (connection < 0) {
+				if (errno == EINTR || errno == ECONNABORTED) continue;
+				close (listener);
+				Melder_throw (U"Cannot accept a connection on socket ", socketPath, U".");
+			}
+			pid_t processID = fork ();
+			if (processID == 0) {
+				close (listener);
+				serveOneScript (connection);
+				_exit (0);   // no preferences or other clean-up: those belong to the server
+			}
+			close (connection);   // the child has its own copy
+			if (processID < 0) {
+				Melder_casual (U"Could not fork for a script on socket ", socketPath, U".");
+				continue;
+			}
+			numberOfRunningScripts ++;
+		}
+	#else
+		(void) socketPath;
+		Melder_throw (U"Serving scripts from a socket is not available on this platform.");
+	#endif
+}
+
 void praat_executeScriptFromFile (MelderFile file, const char32 *arguments) {
 	try {
 		autostring32 text = MelderFile_readText (file);
@@ -22,6 +22,7 @@
 
 int praat_executeCommand (Interpreter me, char32 *command);
 void praat_executeCommandFromStandardInput (const char32 *programName);
+void praat_serveScriptsFromSocket (const char32 *socketPath);
 void praat_executeScriptFromFile (MelderFile file, const char32 *arguments);
 void praat_executeScriptFromFileName (const char32 *fileName, integer narg, Stackel args);
 void praat_executeScriptFromFileNameWithArguments (const char32 *nameAndArguments);
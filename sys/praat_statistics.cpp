@@ -151,7 +151,7 @@ void praat_reportMemoryUse () {
 	MelderInfo_writeLine (U"Currently in use:\n"
 		U"   Strings: ", MelderString_allocationCount () - MelderString_deallocationCount ());
 	MelderInfo_writeLine (U"   Arrays: ", NUM_getTotalNumberOfArrays ());
-	MelderInfo_writeLine (U"   Things: ", theTotalNumberOfThings,
+	MelderInfo_writeLine (U"   Things: ", theTotalNumberOfThings.load(),
 		U" (objects in list: ", theCurrentPraatObjects -> n, U")");
 	integer numberOfMotifWidgets =
 	#if motif
@@ -162,7 +162,7 @@ void praat_reportMemoryUse () {
 	#endif
 	MelderInfo_writeLine (U"   Other: ",
 		Melder_allocationCount () - Melder_deallocationCount ()
-		- theTotalNumberOfThings - NUM_getTotalNumberOfArrays ()
+		- theTotalNumberOfThings.load() - NUM_getTotalNumberOfArrays ()
 		- (MelderString_allocationCount () - MelderString_deallocationCount ())
 		- numberOfMotifWidgets);
 	MelderInfo_writeLine (